@@ -0,0 +1,386 @@
+// Copyright 2011-2024 David Robillard <d@drobilla.net>
+// SPDX-License-Identifier: ISC
+
+/*
+  Benchmarks for loading, searching, counting, writing, and freeing a model of
+  synthetic data.  Results are written to stdout as tab-separated values with
+  a header, one row per benchmark, so runs can be compared across releases.
+*/
+
+#include <serd/serd.h>
+#include <sord/sord.h>
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_ERROR(msg) fprintf(stderr, "bench_sord: " msg)
+#define BENCH_ERRORF(fmt, ...) fprintf(stderr, "bench_sord: " fmt, __VA_ARGS__)
+
+#define USTR(s) ((const uint8_t*)(s))
+
+#define MAX_QUERIES 1000U
+
+/// A growing buffer for a written document
+typedef struct {
+  char*  buf;      ///< Written text
+  size_t len;      ///< Length of written text
+  size_t capacity; ///< Size of allocated buffer
+} Document;
+
+typedef struct {
+  size_t   n_quads;      ///< Number of quads to generate
+  unsigned n_graphs;     ///< Number of named graphs, or zero for triples
+  unsigned n_predicates; ///< Number of distinct predicates
+  size_t   literal_len;  ///< Length of long literals
+  uint32_t seed;         ///< Random number generator seed
+  unsigned indices;      ///< Model indices
+} Options;
+
+static int
+print_usage(const char* name, bool error)
+{
+  FILE* const os = error ? stderr : stdout;
+  fprintf(os, "%s", error ? "\n" : "");
+  fprintf(os, "Usage: %s [OPTION]...\n", name);
+  fprintf(os, "Benchmark a model of synthetic data.\n\n");
+  fprintf(os, "  -a         Use every index\n");
+  fprintf(os, "  -g GRAPHS  Number of named graphs (default: 16)\n");
+  fprintf(os, "  -h         Display this help and exit\n");
+  fprintf(os, "  -l LENGTH  Length of long literals (default: 256)\n");
+  fprintf(os, "  -n QUADS   Number of quads (default: 100000)\n");
+  fprintf(os, "  -p PREDS   Number of predicates (default: 64)\n");
+  fprintf(os, "  -s SEED    Random number generator seed (default: 1)\n");
+  return error ? 1 : 0;
+}
+
+static uint32_t
+next_random(uint32_t* const state)
+{
+  // Xorshift, which is fast and deterministic across platforms
+  uint32_t x = *state;
+  x ^= x << 13U;
+  x ^= x >> 17U;
+  x ^= x << 5U;
+  return (*state = x);
+}
+
+static double
+bench_time(void)
+{
+  return (double)clock() / (double)CLOCKS_PER_SEC;
+}
+
+static void
+report(const char* const name,
+       const size_t      n_operations,
+       const size_t      n_results,
+       const double      start)
+{
+  const double seconds = bench_time() - start;
+  printf("%s\t%zu\t%zu\t%.6f\n", name, n_operations, n_results, seconds);
+}
+
+static SordNode*
+numbered_uri(SordWorld* const world, const char* const kind, const size_t num)
+{
+  char str[64];
+  snprintf(str, sizeof(str), "http://example.org/%s%zu", kind, num);
+  return sord_new_uri(world, USTR(str));
+}
+
+static SordNode*
+long_literal(SordWorld* const world,
+             char* const      buf,
+             const size_t     len,
+             const uint32_t   num)
+{
+  size_t i = (size_t)snprintf(buf, len + 16U, "%u ", (unsigned)num);
+  for (; i < len; ++i) {
+    buf[i] = (char)('a' + (i % 26U));
+  }
+
+  buf[i] = '\0';
+  return sord_new_literal(world, NULL, USTR(buf), "en");
+}
+
+/**
+   Generate quads with a skewed distribution of predicates.
+
+   There is a subject for about every eight quads, predicates follow a power
+   law so that a few are very common, a quarter of the objects are long
+   literals, and graphs are uniformly distributed.
+*/
+static SordQuad*
+generate(SordWorld* const world, const Options* const opts)
+{
+  SordQuad* const quads = (SordQuad*)calloc(opts->n_quads, sizeof(SordQuad));
+  char* const     buf   = (char*)calloc(1, opts->literal_len + 16U);
+  if (!quads || !buf) {
+    free(buf);
+    free(quads);
+    return NULL;
+  }
+
+  const size_t n_subjects = (opts->n_quads / 8U) + 1U;
+  uint32_t     state      = opts->seed ? opts->seed : 1U;
+  for (size_t i = 0U; i < opts->n_quads; ++i) {
+    const double   u = (double)(next_random(&state) % 65536U) / 65536.0;
+    const size_t   p = (size_t)(opts->n_predicates * u * u * u);
+    const size_t   s = next_random(&state) % n_subjects;
+    const uint32_t o = next_random(&state);
+    const uint32_t g = next_random(&state);
+
+    quads[i][0] = numbered_uri(world, "s", s);
+    quads[i][1] = numbered_uri(world, "p", p);
+    quads[i][2] = (o % 4U) ? numbered_uri(world, "o", o % opts->n_quads)
+                           : long_literal(world, buf, opts->literal_len, o);
+    quads[i][3] =
+      opts->n_graphs ? numbered_uri(world, "g", g % opts->n_graphs) : NULL;
+  }
+
+  free(buf);
+  return quads;
+}
+
+/// Write the name of a pattern, like "S?O?" for a bound subject and object
+static void
+pattern_name(char* const name, const unsigned sig)
+{
+  static const char letters[] = "SPOG";
+  for (unsigned i = 0U; i < 4U; ++i) {
+    name[i] = (sig & (8U >> i)) ? letters[i] : '?';
+  }
+
+  name[4] = '\0';
+}
+
+/// Set `pat` to the nodes of `quad` that are bound in a pattern signature
+static void
+bind_pattern(SordQuad                     pat,
+             const SordNode* const* const quad,
+             const unsigned               sig)
+{
+  for (unsigned i = 0U; i < 4U; ++i) {
+    pat[i] = (sig & (8U >> i)) ? quad[i] : NULL;
+  }
+}
+
+/// Time searching and counting with every combination of bound nodes
+static void
+bench_patterns(SordModel* const     model,
+               const SordQuad*      quads,
+               const Options* const opts)
+{
+  const size_t n_queries =
+    opts->n_quads < MAX_QUERIES ? opts->n_quads : MAX_QUERIES;
+
+  for (unsigned sig = 0U; sig < 16U; ++sig) {
+    if ((sig & 1U) && !opts->n_graphs) {
+      continue;
+    }
+
+    char pattern[5];
+    char name[16];
+    pattern_name(pattern, sig);
+
+    // Search for every match of each pattern
+    const size_t n    = sig ? n_queries : 1U;
+    size_t       hits = 0U;
+    double       t0   = bench_time();
+    for (size_t i = 0U; i < n; ++i) {
+      SordQuad pat;
+      bind_pattern(pat, quads[(i * opts->n_quads) / n], sig);
+
+      SordIter* const iter = sord_find(model, pat);
+      for (; !sord_iter_end(iter); sord_iter_next(iter)) {
+        ++hits;
+      }
+      sord_iter_free(iter);
+    }
+
+    snprintf(name, sizeof(name), "find_%s", pattern);
+    report(name, n, hits, t0);
+
+    // Count the matches of each pattern
+    hits = 0U;
+    t0   = bench_time();
+    for (size_t i = 0U; i < n; ++i) {
+      SordQuad pat;
+      bind_pattern(pat, quads[(i * opts->n_quads) / n], sig);
+      hits += (size_t)sord_count(model, pat[0], pat[1], pat[2], pat[3]);
+    }
+
+    snprintf(name, sizeof(name), "count_%s", pattern);
+    report(name, n, hits, t0);
+  }
+}
+
+/// Append to a document, growing it geometrically so copying isn't measured
+static size_t
+document_sink(const void* const buf, const size_t len, void* const stream)
+{
+  Document* const doc = (Document*)stream;
+  if (doc->len + len + 1U > doc->capacity) {
+    size_t capacity = doc->capacity ? doc->capacity : 4096U;
+    while (doc->len + len + 1U > capacity) {
+      capacity *= 2U;
+    }
+
+    char* const new_buf = (char*)realloc(doc->buf, capacity);
+    if (!new_buf) {
+      return 0U;
+    }
+
+    doc->buf      = new_buf;
+    doc->capacity = capacity;
+  }
+
+  memcpy(doc->buf + doc->len, buf, len);
+  doc->len += len;
+  doc->buf[doc->len] = '\0';
+  return len;
+}
+
+/// Time writing a model as N-Quads, and return the written document
+static char*
+bench_write(SordModel* const model)
+{
+  Document          doc    = {NULL, 0U, 0U};
+  SerdEnv* const    env    = serd_env_new(NULL);
+  SerdWriter* const writer = serd_writer_new(
+    SERD_NQUADS, SERD_STYLE_BULK, env, NULL, document_sink, &doc);
+
+  const double t0 = bench_time();
+  sord_write(model, writer, NULL);
+  serd_writer_finish(writer);
+  report("write", sord_num_quads(model), doc.len, t0);
+
+  serd_writer_free(writer);
+  serd_env_free(env);
+  return doc.buf;
+}
+
+/// Time reading a document into a new model
+static void
+bench_read(SordWorld* const     world,
+           const char* const    document,
+           const Options* const opts)
+{
+  SordModel* const  model  = sord_new(world, opts->indices, opts->n_graphs);
+  SerdEnv* const    env    = serd_env_new(NULL);
+  SerdReader* const reader = sord_new_reader(model, env, SERD_NQUADS, NULL);
+
+  const double t0 = bench_time();
+  serd_reader_read_string(reader, USTR(document));
+  report("read", opts->n_quads, sord_num_quads(model), t0);
+
+  serd_reader_free(reader);
+  serd_env_free(env);
+  sord_free(model);
+}
+
+static bool
+parse_size(const char* const str, size_t* const value)
+{
+  char* end = NULL;
+  *value    = (size_t)strtoul(str, &end, 10);
+  return end && end != str && !*end;
+}
+
+int
+main(int argc, char** argv)
+{
+  Options opts = {100000U, 16U, 64U, 256U, 1U, SORD_SPO | SORD_OPS};
+
+  int a = 1;
+  for (; a < argc && argv[a][0] == '-'; ++a) {
+    if (argv[a][1] == 'a') {
+      opts.indices = SORD_SPO | SORD_SOP | SORD_OPS | SORD_OSP | SORD_PSO |
+                     SORD_POS;
+      continue;
+    } else if (argv[a][1] == 'h') {
+      return print_usage(argv[0], false);
+    } else if (!strchr("glnps", argv[a][1]) || argv[a][2]) {
+      BENCH_ERRORF("invalid option -- '%s'\n", argv[a] + 1);
+      return print_usage(argv[0], true);
+    }
+
+    const char opt   = argv[a][1];
+    size_t     value = 0U;
+    if (++a == argc) {
+      BENCH_ERRORF("option requires an argument -- '%c'\n\n", opt);
+      return print_usage(argv[0], true);
+    } else if (!parse_size(argv[a], &value) || (opt == 'n' && !value) ||
+               (opt == 'p' && !value) || value > UINT32_MAX) {
+      BENCH_ERRORF("invalid argument for -%c `%s'\n", opt, argv[a]);
+      return print_usage(argv[0], true);
+    }
+
+    switch (opt) {
+    case 'g':
+      opts.n_graphs = (unsigned)value;
+      break;
+    case 'l':
+      opts.literal_len = value;
+      break;
+    case 'n':
+      opts.n_quads = value;
+      break;
+    case 'p':
+      opts.n_predicates = (unsigned)value;
+      break;
+    default:
+      opts.seed = (uint32_t)value;
+      break;
+    }
+  }
+
+  if (a < argc) {
+    BENCH_ERRORF("unexpected argument `%s'\n", argv[a]);
+    return print_usage(argv[0], true);
+  }
+
+  SordWorld* const world = sord_world_new();
+  SordQuad* const  quads = generate(world, &opts);
+  if (!quads) {
+    BENCH_ERROR("failed to allocate data\n");
+    sord_world_free(world);
+    return 1;
+  }
+
+  printf("benchmark\toperations\tresults\tseconds\n");
+
+  // Add every generated quad to a new model
+  SordModel* const model = sord_new(world, opts.indices, opts.n_graphs);
+  double           t0    = bench_time();
+  for (size_t i = 0U; i < opts.n_quads; ++i) {
+    sord_add(model, quads[i]);
+  }
+  report("add", opts.n_quads, sord_num_quads(model), t0);
+
+  // Search, count, write, and read it back
+  bench_patterns(model, (const SordQuad*)quads, &opts);
+  char* const document = bench_write(model);
+  if (document) {
+    bench_read(world, document, &opts);
+    free(document);
+  }
+
+  // Free the model, then the world with the generated nodes still in it
+  const size_t n_quads = sord_num_quads(model);
+  t0                   = bench_time();
+  sord_free(model);
+  report("free", n_quads, 0U, t0);
+  free(quads);
+
+  const size_t n_nodes = sord_num_nodes(world);
+  t0                   = bench_time();
+  sord_world_free(world);
+  report("world_free", n_nodes, 0U, t0);
+
+  return 0;
+}
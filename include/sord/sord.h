@@ -37,6 +37,14 @@ extern "C" {
 
    Sord stores RDF (subject object predicate context) quads, where the context
    may be omitted (to represent triples in the default graph).
+
+   Any number of threads may read a model at once, as long as nothing writes
+   to the model or its world at the same time.  Reading includes searching
+   and iterating with sord_begin(), sord_find(), sord_search(), sord_get(),
+   sord_ask(), sord_count(), sord_estimate_count(), and sord_contains(), as
+   well as copying and freeing nodes that are already in the model.  Creating
+   new nodes, and everything that modifies a model, is writing.  A snapshot made
+   with sord_snapshot() can be read while its original model is written to.
    @{
 */
 
@@ -69,6 +77,14 @@ typedef struct SordInserterImpl SordInserter;
 */
 typedef struct SordIterImpl SordIter;
 
+/**
+   Basic Graph Pattern Query.
+
+   A query is a set of quad patterns with shared variables, which is
+   evaluated to a table of solutions.
+*/
+typedef struct SordQueryImpl SordQuery;
+
 /**
    RDF Node.
    A Node is a component of a Quad.  Nodes may be URIs, blank nodes, or
@@ -112,9 +128,104 @@ typedef enum {
   SORD_OPS = 1U << 2U, /**< Object,    Predicate, Subject */
   SORD_OSP = 1U << 3U, /**< Object,    Subject,   Predicate */
   SORD_PSO = 1U << 4U, /**< Predicate, Subject,   Object */
-  SORD_POS = 1U << 5U  /**< Predicate, Object,    Subject */
+  SORD_POS = 1U << 5U, /**< Predicate, Object,    Subject */
+
+  /**
+     Order indices by node ID rather than by node value.
+
+     Node IDs are assigned when nodes are interned, so this makes comparisons
+     much cheaper, but iteration order no longer has any lexical meaning.
+  */
+  SORD_ID_ORDER = 1U << 6U,
+
+  /**
+     Index the values of literal objects by predicate.
+
+     Objects with an xsd:integer, xsd:decimal, xsd:double, or xsd:dateTime
+     datatype are indexed by value, so sord_find_values() can search for a
+     range of values of a predicate.
+  */
+  SORD_VALUES = 1U << 7U
 } SordIndexOption;
 
+/**
+   World option.
+*/
+typedef enum {
+  /**
+     Allocate nodes and quads from large slabs.
+
+     This avoids many small allocations and makes freeing a model or world
+     much faster.  Memory used by removed quads is reused, but memory used by
+     freed nodes is only reclaimed when the world is freed.
+  */
+  SORD_WORLD_ARENA = 1U
+} SordWorldOption;
+
+/**
+   Number of possible indices of a model.
+
+   Arrays of statistics for each index are in the order of SordIndexOption,
+   followed by the same orders with the graph first.
+*/
+#define SORD_NUM_INDICES 12
+
+/**
+   Statistics about the searches and memory of a model.
+
+   Search counts include searches made internally, for example by sord_count()
+   and queries.  They accumulate from when the model is created or
+   sord_reset_stats() is called, and are updated cheaply enough to be left
+   enabled.
+*/
+typedef struct {
+  size_t n_all;          ///< Searches that iterate over everything
+  size_t n_single;       ///< Searches for a single quad
+  size_t n_range;        ///< Searches of a range of an index
+  size_t n_filter_range; ///< Searches that filter a range of an index
+  size_t n_filter_all;   ///< Searches that filter an entire index
+
+  size_t n_searches[SORD_NUM_INDICES]; ///< Searches of each index
+  size_t n_scanned;  ///< Quads visited by freed iterators
+  size_t n_returned; ///< Matches returned by freed iterators
+
+  size_t n_nodes;     ///< Number of nodes in the world
+  size_t node_slots;  ///< Number of slots in the world's node table
+  size_t node_bytes;  ///< Bytes allocated for nodes and their strings
+  size_t n_quads;     ///< Number of quads in the model
+  size_t index_bytes[SORD_NUM_INDICES]; ///< Approximate size of each index
+} SordStats;
+
+/**
+   Type of change to a model.
+*/
+typedef enum {
+  SORD_ADDED   = 1U, /**< A quad was added */
+  SORD_REMOVED = 2U  /**< A quad was removed */
+} SordChangeType;
+
+/**
+   A change to a model.
+
+   Every change has a sequence number, one more than the change before it.
+   The nodes of a change from sord_get_changes() are held by the change log,
+   so they remain valid even if the quad has been removed.
+*/
+typedef struct {
+  uint64_t       seq;  ///< Sequence number, starting at 1
+  SordChangeType type; ///< Type of change
+  SordQuad       quad; ///< Quad which was added or removed
+} SordChange;
+
+/**
+   Function called with each change to a model.
+
+   This is called after a quad is added, and before a removed quad releases
+   its nodes, so the nodes of `change` are valid during the call.  The model
+   must not be modified during the call.
+*/
+typedef void (*SordChangeSink)(void* handle, const SordChange* change);
+
 /**
    @name World
    @{
@@ -129,6 +240,14 @@ typedef enum {
 SORD_API SordWorld*
 sord_world_new(void);
 
+/**
+   Create a new Sord World with options.
+
+   @param options SordWorldOption flags (e.g. SORD_WORLD_ARENA).
+*/
+SORD_API SordWorld*
+sord_world_new_with_options(unsigned options);
+
 /**
    Free `world`.
 */
@@ -250,6 +369,30 @@ sord_node_get_datatype(const SordNode* node);
 SORD_API SerdNodeFlags
 sord_node_get_flags(const SordNode* node);
 
+/**
+   Return the value of a number or date literal.
+
+   This is the value of an xsd:integer, xsd:decimal, or xsd:double literal,
+   or the number of seconds since 1970-01-01T00:00:00Z for an xsd:dateTime
+   literal, which is in UTC if it has no time zone.  Values are parsed once,
+   when the node is created.
+
+   @return The value of `node`, or NaN if it isn't a valid literal of one of
+   these datatypes.
+*/
+SORD_API double
+sord_node_get_value(const SordNode* node);
+
+/**
+   Return the hash of a node.
+
+   This depends only on the contents of the node, so equal nodes in different
+   worlds have the same hash.  It can be passed to sord_intern_many() to avoid
+   hashing the node again.
+*/
+SORD_API size_t
+sord_node_get_hash(const SordNode* node);
+
 /**
    Return true iff node can be serialised as an inline object.
 
@@ -288,6 +431,38 @@ sord_node_from_serd_node(SordWorld*      world,
                          const SerdNode* datatype,
                          const SerdNode* lang);
 
+/**
+   Create many SordNodes from SerdNodes at once.
+
+   This is equivalent to calling sord_node_from_serd_node() for each node, but
+   faster for large batches, since every node is hashed in one pass before any
+   are looked up in another.
+
+   @param world The world to create the nodes in.
+   @param env Environment for expanding CURIEs and resolving relative URIs.
+   @param n_nodes The number of nodes to create.
+   @param nodes Array of `n_nodes` nodes.
+   @param datatypes Array of `n_nodes` literal datatypes, or null.
+   @param langs Array of `n_nodes` literal languages, or null.
+   @param hashes Array of `n_nodes` hashes from sord_node_get_hash(), or null.
+   Zero elements are hashed and set to the hash of the new node, others must be
+   the hash of the node, and are used without hashing it again.  Hashes of
+   CURIEs and relative URIs are ignored since they are expanded first.
+   @param out Array that is set to the `n_nodes` new nodes, which must each be
+   freed with sord_node_free(), or null for nodes that couldn't be created.
+
+   @return The number of nodes created.
+*/
+SORD_API size_t
+sord_intern_many(SordWorld*      world,
+                 SerdEnv*        env,
+                 size_t          n_nodes,
+                 const SerdNode* nodes,
+                 const SerdNode* datatypes,
+                 const SerdNode* langs,
+                 size_t*         hashes,
+                 SordNode**      out);
+
 /**
    @}
    @name Model
@@ -302,18 +477,49 @@ sord_node_from_serd_node(SordWorld*      world,
    @param indices SordIndexOption flags (e.g. SORD_SPO|SORD_OPS).  Be sure to
    enable an index where the most significant node(s) are not variables in your
    queries (e.g. to make (? P O) queries, enable either SORD_OPS or SORD_POS).
+   Adding SORD_ID_ORDER makes every index cheaper to maintain and search, at
+   the cost of sorted iteration.  Adding SORD_VALUES maintains a value index
+   for sord_find_values().
 
    @param graphs If true, store (and index) graph contexts.
 */
 SORD_API SordModel*
 sord_new(SordWorld* world, unsigned indices, bool graphs);
 
+/**
+   Create a read-only snapshot of a model.
+
+   The snapshot shares the storage of `model`, so this is cheap, and stays
+   consistent while `model` continues to change.  The first write to `model`
+   while a snapshot exists copies its quads, so that later changes don't
+   affect the snapshot.  Pending quads of a bulk load are not included.
+
+   A snapshot may be read and freed by another thread while `model` is
+   modified.  Freeing a snapshot after `model` has changed leaves nodes that
+   are no longer used in the world, until the next write to a model, freeing a
+   model that is not a snapshot, or sord_num_nodes().  Nodes copied from a
+   snapshot by another thread must be freed before it, and it must be freed
+   with sord_free() before the world.
+*/
+SORD_API SordModel*
+sord_snapshot(SordModel* model);
+
 /**
    Close and free `model`.
 */
 SORD_API void
 sord_free(SordModel* model);
 
+/**
+   Free `model` and the world it belongs to.
+
+   This is equivalent to sord_free() followed by sord_world_free(), but faster,
+   since the references held by quads don't need to be dropped from nodes that
+   are all freed anyway.  The world must not contain any other models.
+*/
+SORD_API void
+sord_free_with_world(SordModel* model);
+
 /**
    Get the world associated with `model`.
 */
@@ -324,6 +530,8 @@ sord_get_world(SordModel* model);
    Return the number of nodes stored in `world`.
 
    Nodes are included in this count iff they are a part of a quad in `world`.
+   This first frees any nodes left unused by freed snapshots, so it must not
+   be called while another thread writes to `world`.
 */
 SORD_API size_t
 sord_num_nodes(const SordWorld* world);
@@ -383,6 +591,10 @@ sord_ask(SordModel*      model,
 
 /**
    Return the number of matching statements.
+
+   This takes logarithmic time if the model hasn't been modified since it was
+   compacted with sord_compact() and the pattern matches a range in an index.
+   Otherwise, it iterates over every match.
 */
 SORD_API uint64_t
 sord_count(SordModel*      model,
@@ -391,6 +603,21 @@ sord_count(SordModel*      model,
            const SordNode* o,
            const SordNode* g);
 
+/**
+   Return a cheap upper bound on the number of matching statements.
+
+   This is exact in the cases where sord_count() takes logarithmic time.
+   Otherwise, it never scans the model, and is based on the number of
+   references to the given nodes, and the size of the index range a search
+   would filter, if known.
+*/
+SORD_API uint64_t
+sord_estimate_count(SordModel*      model,
+                    const SordNode* s,
+                    const SordNode* p,
+                    const SordNode* o,
+                    const SordNode* g);
+
 /**
    Check if `model` contains a triple pattern.
 
@@ -399,6 +626,23 @@ sord_count(SordModel*      model,
 SORD_API bool
 sord_contains(SordModel* model, const SordQuad pat);
 
+/**
+   Search for statements with a value of a predicate in a range.
+
+   This requires a #SORD_VALUES index, and finds every statement with
+   `predicate` and an object with a value from sord_node_get_value() that is
+   at least `min` and at most `max`.  Statements are returned in order of
+   value.
+
+   @return An iterator to the first match, or null if there are no matches or
+   the model has no value index.
+*/
+SORD_API SordIter*
+sord_find_values(SordModel*      model,
+                 const SordNode* predicate,
+                 double          min,
+                 double          max);
+
 /**
    Add a quad to a model.
 
@@ -409,6 +653,24 @@ sord_contains(SordModel* model, const SordQuad pat);
 SORD_API bool
 sord_add(SordModel* model, const SordQuad tup);
 
+/**
+   Add several quads to a model.
+
+   This is equivalent to calling sord_add() for each quad, but the quads are
+   sorted and inserted in the order of each index, which is much faster for
+   large batches.  If any quad has a null subject, predicate, or object, then
+   nothing is added.  Calling this function invalidates all iterators on
+   `model`.
+
+   The quads in `quads` aren't modified.  The pointer isn't const only because
+   C before C23 doesn't convert `SordQuad*` to `const SordQuad*` implicitly,
+   so every caller would need a cast.
+
+   @return The number of quads that were added (or appended to a bulk load).
+*/
+SORD_API size_t
+sord_add_batch(SordModel* model, SordQuad* quads, size_t n_quads);
+
 /**
    Remove a quad from a model.
 
@@ -418,6 +680,19 @@ sord_add(SordModel* model, const SordQuad tup);
 SORD_API void
 sord_remove(SordModel* model, const SordQuad tup);
 
+/**
+   Remove several quads from a model.
+
+   This is equivalent to calling sord_remove() for each quad, but the quads
+   are sorted and removed in the order of each index.  Calling this function
+   invalidates all iterators on `model`.  As with sord_add_batch(), the quads
+   aren't modified even though the pointer isn't const.
+
+   @return The number of quads that were removed.
+*/
+SORD_API size_t
+sord_remove_batch(SordModel* model, SordQuad* quads, size_t n_quads);
+
 /**
    Remove a quad from a model via an iterator.
 
@@ -430,6 +705,173 @@ sord_remove(SordModel* model, const SordQuad tup);
 SORD_API SerdStatus
 sord_erase(SordModel* model, SordIter* iter);
 
+/**
+   Remove every quad from a model.
+
+   This is much faster than removing quads one at a time, since indices are
+   freed in bulk, and if a snapshot shares the quads, they aren't copied.
+   Every removed quad is reported to any change sink or log.  There must be no
+   iterators on `model`.
+*/
+SORD_API void
+sord_clear(SordModel* model);
+
+/**
+   Start a bulk load.
+
+   After this is called, sord_add() only appends quads to a pending buffer,
+   which is much faster than inserting into every index one at a time.
+   Pending quads are not visible to searches until sord_bulk_commit() is
+   called.  During a bulk load, sord_add() only detects a duplicate of the
+   quad added immediately before it, other duplicates are dropped on commit.
+*/
+SORD_API void
+sord_bulk_begin(SordModel* model);
+
+/**
+   Finish a bulk load and insert all pending quads into the model.
+
+   The pending quads are sorted once for each index and inserted in order.
+   Calling this function invalidates all iterators on `model`.
+
+   @return The number of quads that were actually added, that is, the number
+   of distinct pending quads that were not already in the model.
+*/
+SORD_API size_t
+sord_bulk_commit(SordModel* model);
+
+/**
+   Compact the storage of a model for faster iteration.
+
+   This gives every index its own copy of each quad, stored contiguously in
+   the order of that index, so that scanning an index reads memory
+   sequentially.  This uses more memory, since quads are no longer shared
+   between indices, and the memory of quads removed later is only reclaimed
+   by compacting again or freeing the model.
+
+   Calling this function invalidates all iterators on `model`.
+*/
+SORD_API void
+sord_compact(SordModel* model);
+
+/**
+   Return the indices of a model as SordIndexOption flags.
+*/
+SORD_API unsigned
+sord_get_indices(const SordModel* model);
+
+/**
+   Add indices to a model.
+
+   `indices` is SordIndexOption flags as for sord_new().  Each index that
+   doesn't exist yet is built from the default index, along with its graph
+   index if the model stores graphs.  The records are sorted into a block in
+   the order of the new index, as with sord_compact().
+
+   Calling this function invalidates all iterators on `model`.
+
+   @return False if the model is read-only.
+*/
+SORD_API bool
+sord_add_index(SordModel* model, unsigned indices);
+
+/**
+   Remove indices from a model to save memory.
+
+   `indices` is SordIndexOption flags as for sord_new(), and may not include
+   #SORD_SPO, which every model has.  Any graph index for each order is
+   removed as well.
+
+   Calling this function invalidates all iterators on `model`.
+
+   @return False if the model is read-only or `indices` includes #SORD_SPO.
+*/
+SORD_API bool
+sord_drop_index(SordModel* model, unsigned indices);
+
+/**
+   Add indices automatically when searches need them.
+
+   If `threshold` is not zero, the model counts searches that have to filter
+   because the ideal index for their pattern is missing.  Once `threshold`
+   searches have needed an index, it is built at the next modification of
+   the model (including sord_compact()), as if by sord_add_index().  Building
+   waits for a write since other threads may be reading the model.
+
+   This is disabled by default, and setting a threshold resets the counts.
+*/
+SORD_API void
+sord_set_index_threshold(SordModel* model, size_t threshold);
+
+/**
+   Get statistics about the searches and memory of a model.
+
+   The load factor of the node table is `n_nodes / node_slots`.  Index sizes
+   are estimates, which don't include the quads themselves.  This may be
+   called while other threads are reading the model, but the counts may then
+   be slightly out of date.
+*/
+SORD_API void
+sord_get_stats(const SordModel* model, SordStats* stats);
+
+/**
+   Reset the search counts of a model to zero.
+*/
+SORD_API void
+sord_reset_stats(SordModel* model);
+
+/**
+   Set a function to call with every change to a model.
+
+   Every function that adds or removes quads reports each quad that was
+   actually added or removed, including batches, bulk commits, and binary
+   loads.  The sink is not inherited by snapshots.
+
+   @param model The model to watch.
+   @param sink Function to call for each change, or null to stop.
+   @param handle Handle passed to `sink`.
+*/
+SORD_API void
+sord_set_change_sink(SordModel* model, SordChangeSink sink, void* handle);
+
+/**
+   Keep a log of the most recent changes to a model.
+
+   The log holds up to `size` changes, with references to their nodes, so
+   consumers can catch up with sord_get_changes().  When the log is full, the
+   oldest change is dropped.  Changing the size keeps as many of the most
+   recent changes as fit, and a size of zero disables the log.
+*/
+SORD_API void
+sord_set_change_log_size(SordModel* model, size_t size);
+
+/**
+   Return the sequence number of the last change to a model.
+
+   This counts every change, whether or not a log is kept, and is zero for a
+   model that has never been modified.
+*/
+SORD_API uint64_t
+sord_get_change_seq(const SordModel* model);
+
+/**
+   Copy logged changes that came after a sequence number.
+
+   This copies up to `max` changes with a sequence number greater than
+   `after`, oldest first.  If the first change isn't `after + 1`, or nothing
+   is copied but sord_get_change_seq() is greater than `after`, then changes
+   have been dropped from the log and the consumer must synchronize another
+   way.  The copied nodes are valid until the changes are dropped from the
+   log, or the model is freed.
+
+   @return The number of changes copied to `changes`.
+*/
+SORD_API size_t
+sord_get_changes(const SordModel* model,
+                 uint64_t         after,
+                 SordChange*      changes,
+                 size_t           max);
+
 /**
    @}
    @name Inserter
@@ -438,6 +880,12 @@ sord_erase(SordModel* model, SordIter* iter);
 
 /**
    Create an inserter for writing statements to a model.
+
+   The inserter remembers the last graph, subject, and predicate it was given,
+   so runs of statements with repeated nodes don't intern them every time.
+   Prefixes must be set with sord_inserter_set_prefix() (as a reader created
+   with sord_new_reader() does) rather than directly in `env`, so that these
+   are forgotten when a prefix changes.
 */
 SORD_API SordInserter*
 sord_inserter_new(SordModel* model, SerdEnv* env);
@@ -448,6 +896,24 @@ sord_inserter_new(SordModel* model, SerdEnv* env);
 SORD_API void
 sord_inserter_free(SordInserter* inserter);
 
+/**
+   Set the number of statements to buffer before writing them to the model.
+
+   By default, every statement is added to the model immediately.  With a
+   buffer, statements are instead added with sord_add_batch() whenever
+   `size` of them are pending, when the inserter is flushed, or when it is
+   freed.  Any pending statements are flushed first, and a size of zero
+   disables buffering.
+*/
+SORD_API void
+sord_inserter_set_buffer_size(SordInserter* inserter, size_t size);
+
+/**
+   Add any buffered statements to the model.
+*/
+SORD_API void
+sord_inserter_flush(SordInserter* inserter);
+
 /**
    Set the current base URI for writing to the model.
 
@@ -501,6 +967,35 @@ sord_iter_get(const SordIter* iter, SordQuad tup);
 SORD_API const SordNode*
 sord_iter_get_node(const SordIter* iter, SordQuadIndex index);
 
+/**
+   Copy up to `max` quads from `iter` into `quads` and move past them.
+
+   This is equivalent to calling sord_iter_get() and sord_iter_next() for
+   each quad, but much faster for iterating over many results.  Nodes are
+   not copied, so they are only valid as long as they are in the model.
+
+   @return The number of quads copied, which is less than `max` only if
+   `iter` reached the end.
+*/
+SORD_API size_t
+sord_iter_get_batch(SordIter* iter, SordQuad* quads, size_t max);
+
+/**
+   Copy up to `max` fields from `iter` into `nodes` and move past them.
+
+   This is like sord_iter_get_batch(), but copies only one field of each
+   quad, for example the objects of every match for `(S P ?)`.  Nodes may
+   repeat if the pattern leaves other fields unbound.
+
+   @return The number of nodes copied, which is less than `max` only if
+   `iter` reached the end.
+*/
+SORD_API size_t
+sord_iter_get_nodes(SordIter*        iter,
+                    SordQuadIndex    index,
+                    const SordNode** nodes,
+                    size_t           max);
+
 /**
    Return the store pointed to by `iter`.
 */
@@ -525,6 +1020,70 @@ sord_iter_end(const SordIter* iter);
 SORD_API void
 sord_iter_free(SordIter* iter);
 
+/**
+   @}
+   @name Query
+   @{
+*/
+
+/**
+   Create a new empty query for `model`.
+*/
+SORD_API SordQuery*
+sord_query_new(SordModel* model);
+
+/**
+   Free `query` and its solutions.
+*/
+SORD_API void
+sord_query_free(SordQuery* query);
+
+/**
+   Add a pattern to `query`.
+
+   Each element of `vars` is either a variable number, or negative if that
+   position of the pattern is `pat` as in sord_find() (a fixed node, or null
+   to match any node).  Variables are numbered from zero, and each one is
+   bound to the same node in every pattern that uses it.  A graph variable
+   matches quads in any graph, and is bound to null for the default graph.
+   If `vars` is null, the pattern has no variables and only filters.
+
+   @return True on success, or false if a position has both a node and a
+   variable.
+*/
+SORD_API bool
+sord_query_add(SordQuery* query, const SordQuad pat, const int* vars);
+
+/**
+   Evaluate `query` and return the number of solutions.
+
+   The order of joins is planned from index estimates, starting with the
+   pattern with the fewest matches and continuing with whichever gives the
+   smallest result given the solutions so far.  A pattern is joined by
+   searching for every solution, or if there is an index ordered by the join
+   variable, by merging a sorted table of solutions with that index range.
+
+   Solutions are not in any particular order, and are only valid until the
+   model is modified or the query is executed again.
+*/
+SORD_API size_t
+sord_query_execute(SordQuery* query);
+
+/**
+   Return the number of variables in each solution of `query`.
+*/
+SORD_API size_t
+sord_query_num_vars(const SordQuery* query);
+
+/**
+   Return the node bound to variable `var` in solution `row`.
+
+   Returns null if `row` or `var` is out of range, or if the variable is not
+   used by any pattern or is a graph variable bound to the default graph.
+*/
+SORD_API const SordNode*
+sord_query_get(const SordQuery* query, size_t row, unsigned var);
+
 /**
    @}
    @name Utilities
@@ -556,6 +1115,34 @@ sord_new_reader(SordModel* model,
                 SerdSyntax syntax,
                 SordNode*  graph);
 
+/**
+   Load several files into a model, parsing them in parallel.
+
+   Each file is parsed on one of `n_threads` worker threads into a separate
+   buffer, with its own environment whose base URI is the file URI of its
+   path.  Blank node labels are prefixed so they are scoped to their file.
+   The buffers are then merged into `model` in path order as a bulk load (see
+   sord_bulk_begin()), which is committed before this function returns.
+
+   @param model The model to load into.
+   @param env Environment which receives the prefixes defined by all files.
+   @param syntax The syntax of every input file.
+   @param n_files The number of elements in `paths`.
+   @param paths Paths of the files to load.
+   @param n_threads The maximum number of parsing threads to use.
+   @param statuses If not null, an array of `n_files` elements which is set
+   to the status of loading each file.
+   @return The first error in path order, or #SERD_SUCCESS.
+*/
+SORD_API SerdStatus
+sord_load_files(SordModel*            model,
+                SerdEnv*              env,
+                SerdSyntax            syntax,
+                size_t                n_files,
+                const uint8_t* const* paths,
+                unsigned              n_threads,
+                SerdStatus*           statuses);
+
 /**
    Write a model to a writer.
 */
@@ -570,6 +1157,85 @@ sord_write(SordModel* model, SerdWriter* writer, SordNode* graph);
 SORD_API bool
 sord_write_iter(SordIter* iter, SerdWriter* writer);
 
+/**
+   Write a model as N-Triples or N-Quads, using several threads.
+
+   The model is read in index order, in chunks which are written to separate
+   buffers on up to `n_threads` threads, then passed to `sink` in order.
+   Every statement is written flat, with no inline blank nodes.  If `graph`
+   is null, N-Triples has every triple once, and N-Quads has every quad in
+   every graph.  Otherwise, only statements in `graph` are written.
+
+   The model must not be modified while this function is running.
+
+   @param model The model to write.
+   @param syntax Output syntax, #SERD_NTRIPLES or #SERD_NQUADS.
+   @param style Writer style, like #SERD_STYLE_ASCII.
+   @param graph The graph to write, or null to write everything.
+   @param sink Function to call with each chunk of output.
+   @param stream Handle for `sink`, like a `FILE*` for serd_file_sink().
+   @param n_threads The maximum number of threads, including this one.
+   @return #SERD_ERR_BAD_ARG for another syntax, otherwise the status of
+   writing.
+*/
+SORD_API SerdStatus
+sord_write_parallel(SordModel* model,
+                    SerdSyntax syntax,
+                    SerdStyle  style,
+                    SordNode*  graph,
+                    SerdSink   sink,
+                    void*      stream,
+                    unsigned   n_threads);
+
+/**
+   Save a model to a binary snapshot file.
+
+   The snapshot contains every node used by the model and every quad as a
+   tuple of node numbers.  If `orders` is true, it also contains the order of
+   the quads in each index of the model, so sord_load_binary() can build
+   those indices without sorting.  Pending quads of a bulk load are not
+   saved.
+
+   The format is not portable between architectures, it is meant as a cache
+   which is much faster to load than the data it was loaded from.
+
+   @return #SERD_SUCCESS, or an error if the file could not be written.
+*/
+SORD_API SerdStatus
+sord_save_binary(const SordModel* model, const uint8_t* path, bool orders);
+
+/**
+   Load a binary snapshot written by sord_save_binary() into a model.
+
+   This never parses, and if the model is empty and not ordered by node ID
+   (see #SORD_ID_ORDER), it doesn't sort either.  The snapshot is checked
+   before anything is added, so an invalid file leaves the model unchanged.
+
+   @return #SERD_SUCCESS, or an error if the file could not be read or is
+   not a valid snapshot.
+*/
+SORD_API SerdStatus
+sord_load_binary(SordModel* model, const uint8_t* path);
+
+/**
+   Open a binary snapshot written by sord_save_binary() as a read-only model.
+
+   The file is mapped into memory where possible, and searched in place using
+   the index orders it contains, so opening it only checks it and registers
+   its nodes with the world, without copying strings or building indices.
+   The model can be searched, counted, written, and snapshotted, but not
+   modified.
+
+   Nodes that were not already in the world refer to the file data while the
+   model (or any snapshot of it) is open.  Any that are still in use when it
+   is freed have their strings copied, so they remain valid.
+
+   @return A new model, or null if the file could not be read or is not a
+   valid snapshot.
+*/
+SORD_API SordModel*
+sord_open_binary(SordWorld* world, const uint8_t* path);
+
 /**
    @}
    @}
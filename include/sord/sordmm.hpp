@@ -30,6 +30,15 @@
 #include <set>
 #include <sstream>
 #include <string>
+#include <utility>
+
+#if __cplusplus >= 201703L
+#  include <string_view>
+#endif
+
+#if __cplusplus >= 202002L
+#  include <span>
+#endif
 
 #define SORD_NS_XSD "http://www.w3.org/2001/XMLSchema#"
 
@@ -155,6 +164,80 @@ private:
   uint64_t              _next_blank_id;
 };
 
+/** A borrowed node, which is only valid while the node is in the world.
+
+   This doesn't change the reference count of the node, so it's very cheap to
+   create and copy, and is suitable for reading many nodes, such as the
+   results of a search.
+*/
+class NodeView
+{
+public:
+  inline NodeView(const SordNode* c_obj = nullptr)
+    : _c_obj(c_obj)
+  {}
+
+  inline const SordNode* c_obj() const { return _c_obj; }
+
+  inline bool is_valid() const { return _c_obj != nullptr; }
+
+  inline SordNodeType type() const { return sord_node_get_type(_c_obj); }
+
+  inline bool is_uri() const { return _c_obj && type() == SORD_URI; }
+  inline bool is_blank() const { return _c_obj && type() == SORD_BLANK; }
+  inline bool is_literal() const { return _c_obj && type() == SORD_LITERAL; }
+
+  inline const char* to_c_string() const
+  {
+    return _c_obj ? reinterpret_cast<const char*>(sord_node_get_string(_c_obj))
+                  : "";
+  }
+
+#if __cplusplus >= 201703L
+  /// Return the string of the node, which is not copied
+  inline std::string_view to_string_view() const
+  {
+    size_t               n_bytes = 0U;
+    const uint8_t* const str =
+      _c_obj ? sord_node_get_string_counted(_c_obj, &n_bytes) : nullptr;
+
+    return str ? std::string_view(reinterpret_cast<const char*>(str), n_bytes)
+               : std::string_view();
+  }
+#endif
+
+  inline NodeView datatype() const
+  {
+    return _c_obj ? NodeView(sord_node_get_datatype(_c_obj)) : NodeView();
+  }
+
+  inline const char* language() const
+  {
+    return _c_obj ? sord_node_get_language(_c_obj) : nullptr;
+  }
+
+  inline bool operator==(const NodeView& other) const
+  {
+    return _c_obj == other._c_obj; // Nodes are interned
+  }
+
+  inline bool operator!=(const NodeView& other) const
+  {
+    return _c_obj != other._c_obj;
+  }
+
+private:
+  const SordNode* _c_obj;
+};
+
+/** A borrowed statement, with a view of each node. */
+struct StatementView {
+  NodeView subject;
+  NodeView predicate;
+  NodeView object;
+  NodeView graph;
+};
+
 /** An RDF Node (resource, literal, etc)
  */
 class Node : public Wrapper<SordNode>
@@ -176,7 +259,9 @@ public:
   inline Node(World& world);
   inline Node(World& world, const SordNode* node);
   inline Node(World& world, SordNode* node, bool copy = false);
+  inline Node(World& world, NodeView view);
   inline Node(const Node& other);
+  inline Node(Node&& other) noexcept;
   inline ~Node();
 
   inline Type type() const
@@ -187,6 +272,9 @@ public:
   inline const SordNode* get_node() const { return _c_obj; }
   inline SordNode*       get_node() { return _c_obj; }
 
+  inline NodeView view() const { return NodeView(_c_obj); }
+  inline operator NodeView() const { return NodeView(_c_obj); }
+
   const SerdNode* to_serd_node() const
   {
     return sord_node_to_serd_node(_c_obj);
@@ -215,6 +303,19 @@ public:
     return *this;
   }
 
+  Node& operator=(Node&& other) noexcept
+  {
+    if (&other != this) {
+      if (_c_obj) {
+        sord_node_free(_world->c_obj(), _c_obj);
+      }
+      _world       = other._world;
+      _c_obj       = other._c_obj;
+      other._c_obj = nullptr;
+    }
+    return *this;
+  }
+
   inline bool operator==(const Node& other) const
   {
     return sord_node_equals(_c_obj, other._c_obj);
@@ -224,6 +325,13 @@ public:
   inline const char*    to_c_string() const;
   inline std::string    to_string() const;
 
+#if __cplusplus >= 201703L
+  inline std::string_view to_string_view() const
+  {
+    return view().to_string_view();
+  }
+#endif
+
   inline bool is_literal_type(const char* type_uri) const;
 
   inline bool is_uri() const { return _c_obj && type() == URI; }
@@ -359,6 +467,19 @@ inline Node::Node(World& world, SordNode* node, bool copy)
   _c_obj = copy ? sord_node_copy(node) : node;
 }
 
+inline Node::Node(World& world, NodeView view)
+  : _world(&world)
+{
+  _c_obj = view.is_valid() ? sord_node_copy(view.c_obj()) : nullptr;
+}
+
+inline Node::Node(Node&& other) noexcept
+  : Wrapper<SordNode>(other._c_obj)
+  , _world(other._world)
+{
+  other._c_obj = nullptr;
+}
+
 inline Node::Node(const Node& other) // NOLINT(bugprone-copy-constructor-init)
   : Wrapper<SordNode>()
   , _world(other._world)
@@ -445,9 +566,11 @@ struct Iter : public Wrapper<SordIter> {
   Iter& operator=(const Iter&) = delete;
 
   inline Iter(Iter&& iter) noexcept
-    : Wrapper<SordIter>(iter)
+    : Wrapper<SordIter>(iter._c_obj)
     , _world(iter._world)
-  {}
+  {
+    iter._c_obj = nullptr;
+  }
 
   inline ~Iter() { sord_iter_free(_c_obj); }
 
@@ -461,25 +584,98 @@ struct Iter : public Wrapper<SordIter> {
   }
   inline Node get_subject() const
   {
-    SordQuad quad;
-    sord_iter_get(_c_obj, quad);
-    return Node(_world, quad[SORD_SUBJECT]);
+    return Node(_world, sord_iter_get_node(_c_obj, SORD_SUBJECT));
   }
   inline Node get_predicate() const
   {
-    SordQuad quad;
-    sord_iter_get(_c_obj, quad);
-    return Node(_world, quad[SORD_PREDICATE]);
+    return Node(_world, sord_iter_get_node(_c_obj, SORD_PREDICATE));
   }
   inline Node get_object() const
+  {
+    return Node(_world, sord_iter_get_node(_c_obj, SORD_OBJECT));
+  }
+  inline StatementView get() const
   {
     SordQuad quad;
     sord_iter_get(_c_obj, quad);
-    return Node(_world, quad[SORD_OBJECT]);
+    return {quad[SORD_SUBJECT],
+            quad[SORD_PREDICATE],
+            quad[SORD_OBJECT],
+            quad[SORD_GRAPH]};
   }
   World& _world;
 };
 
+/** A range of statements for use in a range-based for loop.
+
+   Statements are borrowed views, so iterating doesn't copy nodes or change
+   their reference counts.  The model may not be modified during iteration.
+*/
+class Range : public Wrapper<SordIter>
+{
+public:
+  /** Position in a range, which is either at a statement or the end. */
+  class iterator
+  {
+  public:
+    inline explicit iterator(SordIter* iter = nullptr)
+      : _iter(sord_iter_end(iter) ? nullptr : iter)
+    {}
+
+    inline StatementView operator*() const
+    {
+      SordQuad quad;
+      sord_iter_get(_iter, quad);
+      return {quad[SORD_SUBJECT],
+              quad[SORD_PREDICATE],
+              quad[SORD_OBJECT],
+              quad[SORD_GRAPH]};
+    }
+
+    inline iterator& operator++()
+    {
+      if (sord_iter_next(_iter)) {
+        _iter = nullptr;
+      }
+      return *this;
+    }
+
+    inline bool operator==(const iterator& other) const
+    {
+      return _iter == other._iter;
+    }
+
+    inline bool operator!=(const iterator& other) const
+    {
+      return _iter != other._iter;
+    }
+
+  private:
+    SordIter* _iter;
+  };
+
+  inline explicit Range(SordIter* c_obj)
+    : Wrapper<SordIter>(c_obj)
+  {}
+
+  Range(const Range&)            = delete;
+  Range& operator=(const Range&) = delete;
+
+  inline Range(Range&& range) noexcept
+    : Wrapper<SordIter>(range._c_obj)
+  {
+    range._c_obj = nullptr;
+  }
+
+  Range& operator=(Range&&) = delete;
+
+  inline ~Range() { sord_iter_free(_c_obj); }
+
+  /// Return the first position, which may only be called once
+  inline iterator begin() const { return iterator(_c_obj); }
+  inline iterator end() const { return iterator(); }
+};
+
 /** An RDF Model (collection of triples).
  */
 class Model
@@ -526,6 +722,16 @@ public:
                             const Node& predicate,
                             const Node& object);
 
+  /// Add many statements at once, and return the number that were new
+  inline size_t add_statements(const SordQuad* quads, size_t n_quads);
+
+#if __cplusplus >= 202002L
+  inline size_t add_statements(std::span<const SordQuad> quads)
+  {
+    return add_statements(quads.data(), quads.size());
+  }
+#endif
+
   inline Iter find(const Node& subject,
                    const Node& predicate,
                    const Node& object);
@@ -534,6 +740,15 @@ public:
                   const Node& predicate,
                   const Node& object);
 
+  /// Return a range of every statement that matches a pattern
+  inline Range match(NodeView subject   = NodeView(),
+                     NodeView predicate = NodeView(),
+                     NodeView object    = NodeView(),
+                     NodeView graph     = NodeView());
+
+  /// Return a range of every statement in the model
+  inline Range all() { return Range(sord_begin(_c_obj)); }
+
   inline World& world() const { return _world; }
 
 private:
@@ -659,8 +874,14 @@ Model::write_to_string(const std::string& base_uri_str,
 
   std::string ret;
 
-  SerdWriter* writer = serd_writer_new(
-    syntax, style, _world.prefixes().c_obj(), &base_uri, string_sink, &ret);
+  // Write in pages, so the string is appended to rarely
+  SerdWriter* writer =
+    serd_writer_new(syntax,
+                    static_cast<SerdStyle>(style | SERD_STYLE_BULK),
+                    _world.prefixes().c_obj(),
+                    &base_uri,
+                    string_sink,
+                    &ret);
 
   const SerdNode base_uri_node = serd_node_from_string(
     SERD_URI, reinterpret_cast<const uint8_t*>(base_uri_str.c_str()));
@@ -672,6 +893,7 @@ Model::write_to_string(const std::string& base_uri_str,
 
   sord_write(_c_obj, writer, nullptr);
 
+  serd_writer_finish(writer);
   serd_writer_free(writer);
   return ret;
 }
@@ -686,6 +908,13 @@ Model::add_statement(const Node& subject,
   sord_add(_c_obj, quad);
 }
 
+inline size_t
+Model::add_statements(const SordQuad* quads, size_t n_quads)
+{
+  // The batch isn't modified, the C API just can't take a const array
+  return sord_add_batch(_c_obj, const_cast<SordQuad*>(quads), n_quads);
+}
+
 inline Iter
 Model::find(const Node& subject, const Node& predicate, const Node& object)
 {
@@ -702,6 +931,18 @@ Model::get(const Node& subject, const Node& predicate, const Node& object)
   return Node(_world, c_node, false);
 }
 
+inline Range
+Model::match(NodeView subject,
+             NodeView predicate,
+             NodeView object,
+             NodeView graph)
+{
+  SordQuad quad = {
+    subject.c_obj(), predicate.c_obj(), object.c_obj(), graph.c_obj()};
+
+  return Range(sord_find(_c_obj, quad));
+}
+
 } // namespace Sord
 
 #endif // SORD_SORDMM_HPP
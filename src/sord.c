@@ -1,6 +1,9 @@
 // Copyright 2011-2016 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#define _POSIX_C_SOURCE 200112L // for mmap()
+
+#include "sord_config.h"
 #include "sord_internal.h"
 
 #include <serd/serd.h>
@@ -15,6 +18,7 @@
 #include <zix/status.h>
 
 #include <assert.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdint.h>
@@ -22,6 +26,13 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if USE_MMAP
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
 #ifdef __GNUC__
 #  define SORD_LOG_FUNC(fmt, arg1) __attribute__((format(printf, fmt, arg1)))
 #else
@@ -46,7 +57,7 @@
 #  define SORD_WRITE_LOG(...)
 #endif
 
-#define NUM_ORDERS 12
+#define NUM_ORDERS SORD_NUM_INDICES
 #define STATEMENT_LEN 3
 #define TUP_LEN (STATEMENT_LEN + 1)
 #define DEFAULT_ORDER SPO
@@ -111,24 +122,217 @@ static const int orderings[NUM_ORDERS][TUP_LEN] = {
   {3, 1, 2, 0}  // GPOS
 };
 
+/** Number of records a filtering iterator steps over before seeking */
+#define SORD_SCAN_STEPS 4U
+
+/** Size of the data in each slab allocated by an arena */
+#define SORD_SLAB_SIZE (64U * 1024U)
+
+/** Slab of memory that objects are allocated from in order */
+typedef struct SordSlabImpl SordSlab;
+struct SordSlabImpl {
+  SordSlab* next;   ///< Previously allocated slab
+  size_t    size;   ///< Size of data in bytes
+  size_t    used;   ///< Number of bytes of data allocated
+  uint64_t  data[]; ///< Allocated objects
+};
+
+/** Arena that allocates from slabs, and only frees everything at once */
+typedef struct {
+  SordSlab* slabs; ///< Most recently allocated slab
+} SordArena;
+
+static void*
+sord_arena_alloc(SordArena* const arena, const size_t size)
+{
+  const size_t align        = sizeof(uint64_t);
+  const size_t aligned_size = (size + align - 1U) & ~(align - 1U);
+
+  SordSlab* slab = arena->slabs;
+  if (!slab || slab->size - slab->used < aligned_size) {
+    const size_t data_size =
+      (aligned_size > SORD_SLAB_SIZE) ? aligned_size : SORD_SLAB_SIZE;
+
+    slab       = (SordSlab*)malloc(sizeof(SordSlab) + data_size);
+    slab->next = arena->slabs;
+    slab->size = data_size;
+    slab->used = 0U;
+
+    arena->slabs = slab;
+  }
+
+  void* const ptr = (uint8_t*)slab->data + slab->used;
+  slab->used += aligned_size;
+  return ptr;
+}
+
+static void
+sord_arena_free(SordArena* const arena)
+{
+  for (SordSlab* slab = arena->slabs; slab;) {
+    SordSlab* const next = slab->next;
+    free(slab);
+    slab = next;
+  }
+
+  arena->slabs = NULL;
+}
+
+/** Quad record that is not in use, in a free list */
+typedef union SordFreeQuadImpl SordFreeQuad;
+union SordFreeQuadImpl {
+  SordQuad      quad;
+  SordFreeQuad* next;
+};
+
 /** World */
 struct SordWorldImpl {
   ZixHash*      nodes;
   SerdErrorSink error_sink;
   void*         error_handle;
+  size_t        last_id;
+  bool          use_arena;  ///< Allocate nodes and quads from arenas
+  SordArena     node_arena; ///< Arena for nodes and their strings
+  size_t        node_bytes; ///< Bytes allocated for nodes and their strings
+  size_t        n_released; ///< Stores released by snapshots, atomic
+  size_t        n_swept;    ///< Value of n_released at the last sweep
 };
 
-/** Store */
-struct SordModelImpl {
-  SordWorld* world;
-
+/** Quads and their indices, which may be shared by a model and snapshots */
+typedef struct {
   /** Index for each possible triple ordering (may or may not exist).
    * Each index is a tree of SordQuad with the appropriate ordering.
    */
   ZixBTree* indices[NUM_ORDERS];
 
   size_t n_quads;
-  size_t n_iters;
+  size_t refs; ///< Number of models using this store
+
+  /** Pool of quad records, used if the world uses arenas. */
+  SordArena     quad_arena;
+  SordFreeQuad* free_quads;
+
+  /** Records for each index in index order, allocated by sord_compact(). */
+  SordQuad* blocks[NUM_ORDERS];
+  size_t    block_sizes[NUM_ORDERS];
+
+  /** Number of distinct triples before each record in a triple index block. */
+  size_t* ranks[NUM_ORDERS / 2];
+  bool    ranked; ///< True iff blocks exactly match their indices
+
+  /** Tree of SordValueRecord by predicate and value, if values are indexed. */
+  ZixBTree* values;
+} SordStore;
+
+/** Record in a value index, which starts with a quad like an index record. */
+typedef struct {
+  SordQuad quad;  ///< Statement with a number or date object
+  double   value; ///< Value of the object
+} SordValueRecord;
+
+/*
+  Binary snapshots.
+
+  A snapshot is a header, a table of nodes sorted by value, the strings of
+  those nodes, and every quad as a tuple of 1-based node numbers in the
+  default order.  These may be followed by the positions of quads in that
+  table for some other orders.  Since the node table is sorted, node numbers
+  compare in the same order as their nodes, so everything is already in order
+  for a model that compares by value.  Values are in native byte order, and
+  every part is padded to a multiple of 8 bytes so all values are aligned.
+*/
+
+#define SORD_BINARY_MAGIC "SORDBIN"
+#define SORD_BINARY_VERSION 1U
+#define SORD_BINARY_BYTE_ORDER 0x01020304U
+
+/// Header at the start of a binary snapshot
+typedef struct {
+  char     magic[8];     ///< SORD_BINARY_MAGIC with a null terminator
+  uint32_t version;      ///< SORD_BINARY_VERSION
+  uint32_t byte_order;   ///< SORD_BINARY_BYTE_ORDER, as written
+  uint64_t n_nodes;      ///< Number of entries in the node table
+  uint64_t strings_size; ///< Size of the string table in bytes
+  uint64_t n_quads;      ///< Number of quads
+  uint32_t orders;       ///< Bit mask of orders with positions after quads
+  uint32_t reserved;     ///< Zero
+} SordBinaryHeader;
+
+/// Entry in the node table of a binary snapshot
+typedef struct {
+  uint64_t offset;   ///< Offset of null-terminated string in string table
+  uint64_t n_bytes;  ///< Length of string in bytes
+  uint64_t n_chars;  ///< Length of string in characters
+  uint32_t datatype; ///< Number of literal datatype node, or zero
+  uint16_t type;     ///< SerdType
+  uint16_t flags;    ///< SerdNodeFlags
+  char     lang[16]; ///< Literal language tag, or empty
+} SordBinaryNode;
+
+/// Quad of 1-based node numbers, where zero is no node
+typedef uint32_t SordBinaryQuad[TUP_LEN];
+
+/// A binary snapshot in memory, with pointers to each part
+typedef struct {
+  const SordBinaryHeader* header;
+  const SordBinaryNode*   nodes;
+  const char*             strings;
+  const SordBinaryQuad*   quads;
+  const uint32_t*         positions[NUM_ORDERS]; ///< Null if not present
+  size_t                  n_graph;               ///< Quads with a graph
+} SordBinaryView;
+
+/**
+   A binary snapshot used in place by a model from sord_open_binary().
+
+   Nodes which were not already in the world are allocated as records without
+   strings, which point into the snapshot data instead.  If any are still in
+   use when the mapping is released, their strings are copied so that they
+   can stay in the world.
+*/
+typedef struct {
+  size_t         refs;      ///< Number of models using this mapping
+  void*          data;      ///< Snapshot data
+  size_t         size;      ///< Size of data in bytes
+  bool           is_mapped; ///< True iff data is mapped, not allocated
+  SordBinaryView view;      ///< View of data
+  SordNode**     records;   ///< Record for each number if new to the world
+  SordNode**     nodes;     ///< Node for each number, where nodes[0] is null
+  uint32_t*      n_as_obj;  ///< Number of object references to each node
+} SordMapping;
+
+/** Model */
+struct SordModelImpl {
+  SordWorld* world;
+  SordStore* store; ///< Quads, copied on write if shared with a snapshot
+
+  /** Comparator used by every index, either by value or by node ID. */
+  ZixCompareFunc compare;
+
+  size_t       n_iters;
+  bool         read_only;   ///< True iff this is a snapshot
+  bool         is_snapshot; ///< True iff this shares another model's store
+  SordMapping* mapping;     ///< Snapshot used in place, or null
+
+  /** Quads added since sord_bulk_begin(), waiting to be committed. */
+  SordQuad* bulk;
+  size_t    n_bulk;
+  size_t    bulk_size;
+  bool      in_bulk;
+
+  /** Searches that needed each missing triple index, if counted. */
+  size_t misses[NUM_ORDERS / 2];
+  size_t index_threshold; ///< Misses before building an index, or zero
+
+  SordStats stats; ///< Search counts, updated atomically by readers
+
+  /** Change notification, and a ring buffer of the most recent changes. */
+  SordChangeSink change_sink;
+  void*          change_handle;
+  uint64_t       change_seq; ///< Sequence number of the last change
+  SordChange*    changes;    ///< Change log, or null
+  size_t         log_size;   ///< Capacity of the change log
+  size_t         n_logged;   ///< Number of changes in the log
 };
 
 /** Mode for searching or iteration */
@@ -137,37 +341,42 @@ typedef enum {
   SINGLE,       ///< Iteration over a single element (exact search)
   RANGE,        ///< Iterate over range with equal prefix
   FILTER_RANGE, ///< Iterate over range with equal prefix, filtering
-  FILTER_ALL    ///< Iterate to end of store, filtering
+  FILTER_ALL,   ///< Iterate to end of store, filtering
+  VALUES        ///< Iterate over a range of values in the value index
 } SearchMode;
 
 /** Iterator over some range of a store */
 struct SordIterImpl {
-  const SordModel* sord;        ///< Model being iterated over
-  ZixBTreeIter     cur;         ///< Current DB cursor
-  SordQuad         pat;         ///< Pattern (in ordering order)
-  SordOrder        order;       ///< Store order (which index)
-  SearchMode       mode;        ///< Iteration mode
-  int              n_prefix;    ///< Prefix for RANGE and FILTER_RANGE
-  bool             end;         ///< True iff reached end
-  bool             skip_graphs; ///< Iteration should ignore graphs
+  const SordModel* sord;         ///< Model being iterated over
+  ZixBTreeIter     cur;          ///< Current DB cursor
+  SordQuad         pat;          ///< Pattern (in ordering order)
+  SordOrder        order;        ///< Store order (which index)
+  SearchMode       mode;         ///< Iteration mode
+  int              n_prefix;     ///< Prefix for RANGE and FILTER_RANGE
+  bool             end;          ///< True iff reached end
+  bool             skip_graphs;  ///< Iteration should ignore graphs
+  size_t           pos;          ///< Position in a mapped order
+  size_t           end_pos;      ///< End of range in a mapped order
+  uint32_t         ids[TUP_LEN]; ///< Pattern as mapped node numbers
+  size_t           n_scanned;    ///< Number of quads visited
+  size_t           n_returned;   ///< Number of matches
+  double           max_value;    ///< Maximum value for VALUES
 };
 
-static uint8_t*
-sord_strndup(const uint8_t* str, size_t len)
-{
-  uint8_t* dup = (uint8_t*)malloc(len + 1);
-  memcpy(dup, str, len + 1);
-  return dup;
-}
-
 static const SordNode*
 sord_node_record_key(const SordNode* n)
 {
   return n;
 }
 
+/**
+   Compute the hash of a node key.
+
+   This depends only on the contents of the node, including the hash (not the
+   address) of any datatype, so it's the same for equal nodes across worlds.
+*/
 static size_t
-sord_node_hash(const SordNode* const node)
+sord_node_digest(const SordNode* const node)
 {
   const size_t head = node->node.type;
 
@@ -176,35 +385,271 @@ sord_node_hash(const SordNode* const node)
   hash = zix_digest(hash, (const uint8_t*)node->node.buf, node->node.n_bytes);
   hash = zix_digest(hash, &head, sizeof(head));
   if (node->node.type == SERD_LITERAL) {
-    hash = zix_digest(hash, &node->meta.lit, sizeof(node->meta.lit));
+    const SordLiteralMetadata* const lit = &node->meta.lit;
+    const size_t datatype_hash = lit->datatype ? lit->datatype->hash : 0U;
+
+    hash = zix_digest(hash, &datatype_hash, sizeof(datatype_hash));
+    hash = zix_digest(hash, lit->lang, sizeof(lit->lang));
   }
 
   return hash;
 }
 
+static size_t
+sord_node_hash(const SordNode* const node)
+{
+  return node->hash;
+}
+
 static bool
 sord_node_hash_equal(const SordNode* const a, const SordNode* const b)
 {
+  // Language tags are always zero-padded, so they can be compared as blocks
   return (a == b) ||
-         ((a->node.type == b->node.type) &&
+         ((a->hash == b->hash) && (a->node.type == b->node.type) &&
+          (a->node.n_bytes == b->node.n_bytes) &&
           (a->node.type != SERD_LITERAL ||
            (a->meta.lit.datatype == b->meta.lit.datatype &&
-            !strncmp(
+            !memcmp(
               a->meta.lit.lang, b->meta.lit.lang, sizeof(a->meta.lit.lang)))) &&
-          (serd_node_equals(&a->node, &b->node)));
+          !memcmp(a->node.buf, b->node.buf, a->node.n_bytes));
 }
 
-static SordNode*
-sord_node_create(const SordNode* const node)
+/*
+  Literal values.
+
+  Number and date literals are parsed when they are interned, so their values
+  can be indexed without parsing again.  Anything that isn't in the lexical
+  space of its datatype has no value, which is NaN.
+*/
+
+#define SORD_XSD "http://www.w3.org/2001/XMLSchema#"
+
+/** Return the end of the decimal digits at the start of `str`. */
+static const char*
+sord_skip_digits(const char* str)
 {
-  SordNode* const copy = node ? (SordNode*)malloc(sizeof(SordNode)) : NULL;
+  while (*str >= '0' && *str <= '9') {
+    ++str;
+  }
 
-  if (copy) {
-    memcpy(copy, node, sizeof(SordNode));
-    copy->node.buf = sord_strndup(copy->node.buf, copy->node.n_bytes);
-    if (copy->node.type == SERD_LITERAL) {
-      copy->meta.lit.datatype = sord_node_copy(copy->meta.lit.datatype);
+  return str;
+}
+
+/** Parse an xsd:integer, or xsd:decimal if `point`, or xsd:double if `exp`. */
+static double
+sord_parse_number(const char* const str, const bool point, const bool exp)
+{
+  const char* s = str + (*str == '+' || *str == '-');
+  if (exp && !strcmp(s, "INF")) {
+    return (*str == '-') ? -HUGE_VAL : HUGE_VAL;
+  }
+
+  const char* const whole = s;
+  s                       = sord_skip_digits(s);
+  bool has_digits         = s > whole;
+  if (point && *s == '.') {
+    const char* const fraction = ++s;
+    s                          = sord_skip_digits(s);
+    has_digits                 = has_digits || s > fraction;
+  }
+
+  if (exp && (*s == 'e' || *s == 'E')) {
+    s += (s[1] == '+' || s[1] == '-') ? 2 : 1;
+    const char* const exponent = s;
+    s                          = sord_skip_digits(s);
+    has_digits                 = has_digits && s > exponent;
+  }
+
+  return (has_digits && !*s) ? serd_strtod(str, NULL) : (double)NAN;
+}
+
+/** Parse exactly `n` digits from `*str`, or return -1. */
+static long
+sord_parse_field(const char** const str, const unsigned n)
+{
+  long value = 0;
+  for (unsigned i = 0U; i < n; ++i) {
+    const char c = (*str)[i];
+    if (c < '0' || c > '9') {
+      return -1;
+    }
+
+    value = (value * 10) + (c - '0');
+  }
+
+  *str += n;
+  return value;
+}
+
+/** Return the number of days from 1970-01-01 to a proleptic Gregorian date. */
+static long
+sord_days_from_civil(long year, const long month, const long day)
+{
+  year -= (month <= 2) ? 1 : 0;
+
+  const long era = ((year >= 0) ? year : (year - 399)) / 400;
+  const long yoe = year - (era * 400);
+  const long doy = ((153 * (month + ((month > 2) ? -3 : 9)) + 2) / 5) + day - 1;
+  const long doe = (yoe * 365) + (yoe / 4) - (yoe / 100) + doy;
+
+  return (era * 146097) + doe - 719468;
+}
+
+/** Parse an xsd:dateTime as seconds since 1970-01-01T00:00:00Z. */
+static double
+sord_parse_date_time(const char* str)
+{
+  // Year, which may be negative and have more than 4 digits
+  const bool        negative = *str == '-';
+  const char* const digits   = str + (negative ? 1 : 0);
+  const char* const year_end = sord_skip_digits(digits);
+  const size_t      n_digits = (size_t)(year_end - digits);
+  if (n_digits < 4U || n_digits > 9U || *year_end != '-') {
+    return (double)NAN;
+  }
+
+  str             = digits;
+  const long year = sord_parse_field(&str, (unsigned)n_digits);
+
+  // Date and time fields, with separators
+  long month  = -1;
+  long day    = -1;
+  long hour   = -1;
+  long minute = -1;
+  long second = -1;
+  if (*str++ != '-' || (month = sord_parse_field(&str, 2U)) < 1 ||
+      month > 12 || *str++ != '-' || (day = sord_parse_field(&str, 2U)) < 1 ||
+      day > 31 || *str++ != 'T' || (hour = sord_parse_field(&str, 2U)) < 0 ||
+      hour > 24 || *str++ != ':' || (minute = sord_parse_field(&str, 2U)) < 0 ||
+      minute > 59 || *str++ != ':' ||
+      (second = sord_parse_field(&str, 2U)) < 0 || second > 60) {
+    return (double)NAN;
+  }
+
+  // Optional fractional seconds
+  double fraction = 0.0;
+  if (*str == '.') {
+    const char* const start = str;
+    str                     = sord_skip_digits(str + 1);
+    if (str == start + 1) {
+      return (double)NAN;
+    }
+
+    fraction = serd_strtod(start, NULL);
+  }
+
+  // Optional time zone, which is subtracted to get UTC
+  long offset = 0;
+  if (*str == 'Z') {
+    ++str;
+  } else if (*str == '+' || *str == '-') {
+    const long sign = (*str++ == '-') ? -1 : 1;
+    const long tz_h = sord_parse_field(&str, 2U);
+    if (tz_h < 0 || tz_h > 14 || *str++ != ':') {
+      return (double)NAN;
     }
+
+    const long tz_m = sord_parse_field(&str, 2U);
+    if (tz_m < 0 || tz_m > 59) {
+      return (double)NAN;
+    }
+
+    offset = sign * ((tz_h * 60) + tz_m) * 60;
+  }
+
+  if (*str) {
+    return (double)NAN;
+  }
+
+  const long days = sord_days_from_civil(negative ? -year : year, month, day);
+  const double seconds =
+    ((double)days * 86400.0) + (double)((hour * 3600) + (minute * 60) + second);
+
+  return seconds + fraction - (double)offset;
+}
+
+/** Return the value of a number or date literal, or NaN. */
+static double
+sord_literal_value(const SordNode* const literal)
+{
+  static const size_t xsd_len = sizeof(SORD_XSD) - 1U;
+
+  const SordNode* const datatype = literal->meta.lit.datatype;
+  if (!datatype || datatype->node.n_bytes <= xsd_len ||
+      strncmp((const char*)datatype->node.buf, SORD_XSD, xsd_len)) {
+    return (double)NAN;
+  }
+
+  const char* const name = (const char*)datatype->node.buf + xsd_len;
+  const char* const str  = (const char*)literal->node.buf;
+  if (!strcmp(name, "integer")) {
+    return sord_parse_number(str, false, false);
+  } else if (!strcmp(name, "decimal")) {
+    return sord_parse_number(str, true, false);
+  } else if (!strcmp(name, "double")) {
+    return sord_parse_number(str, true, true);
+  } else if (!strcmp(name, "dateTime")) {
+    return sord_parse_date_time(str);
+  }
+
+  return (double)NAN;
+}
+
+/**
+   Return the size of the record for a node in the world.
+
+   Only literals have the full metadata, so the records of other nodes end
+   after the resource metadata, and their strings follow directly.
+*/
+static size_t
+sord_node_record_size(const SordNode* const node)
+{
+  const size_t meta_size = (node->node.type == SERD_LITERAL)
+                             ? sizeof(SordLiteralMetadata)
+                             : sizeof(SordResourceMetadata);
+
+  const size_t size = offsetof(SordNode, meta) + meta_size;
+
+  return (size + sizeof(uint64_t) - 1U) & ~(sizeof(uint64_t) - 1U);
+}
+
+/** Return the number of bytes allocated for a node and its string. */
+static size_t
+sord_node_alloc_size(const SordNode* const node)
+{
+  return sord_node_record_size(node) + node->node.n_bytes + 1U;
+}
+
+/** Allocate memory for a node in a world, and count it in node_bytes. */
+static void*
+sord_node_alloc(SordWorld* const world, const size_t size)
+{
+  world->node_bytes += size;
+  return world->use_arena ? sord_arena_alloc(&world->node_arena, size)
+                          : malloc(size);
+}
+
+static SordNode*
+sord_node_create(SordWorld* const world, const SordNode* const node)
+{
+  if (!node) {
+    return NULL;
+  }
+
+  // Allocate the node with its string directly after it
+  const size_t   record_size = sord_node_record_size(node);
+  uint8_t* const mem =
+    (uint8_t*)sord_node_alloc(world, sord_node_alloc_size(node));
+
+  SordNode* const copy = (SordNode*)mem;
+  memcpy(copy, node, record_size);
+  memcpy(mem + record_size, node->node.buf, node->node.n_bytes + 1U);
+  copy->node.buf = mem + record_size;
+
+  if (copy->node.type == SERD_LITERAL) {
+    copy->meta.lit.datatype = sord_node_copy(copy->meta.lit.datatype);
+    copy->meta.lit.value    = sord_literal_value(copy);
   }
 
   return copy;
@@ -228,9 +673,21 @@ error(SordWorld* world, SerdStatus st, const char* fmt, ...)
 SordWorld*
 sord_world_new(void)
 {
-  SordWorld* world    = (SordWorld*)malloc(sizeof(SordWorld));
-  world->error_sink   = NULL;
-  world->error_handle = NULL;
+  return sord_world_new_with_options(0U);
+}
+
+SordWorld*
+sord_world_new_with_options(const unsigned options)
+{
+  SordWorld* world        = (SordWorld*)malloc(sizeof(SordWorld));
+  world->error_sink       = NULL;
+  world->error_handle     = NULL;
+  world->last_id          = 0U;
+  world->use_arena        = options & SORD_WORLD_ARENA;
+  world->node_arena.slabs = NULL;
+  world->node_bytes       = 0U;
+  world->n_released       = 0U;
+  world->n_swept          = 0U;
 
   world->nodes = zix_hash_new(
     NULL, sord_node_record_key, sord_node_hash, sord_node_hash_equal);
@@ -239,10 +696,18 @@ sord_world_new(void)
 }
 
 static void
-free_node_entry(SordNode* const node)
+free_node_entry(SordWorld* const world, SordNode* const node)
 {
-  free((uint8_t*)node->node.buf);
-  free(node);
+  if (!world->use_arena) {
+    // Nodes that outlived a mapping have their string in a separate block
+    const uint8_t* const buf = (const uint8_t*)node->node.buf;
+    if (buf != (const uint8_t*)node + sord_node_record_size(node)) {
+      free((void*)buf);
+    }
+
+    world->node_bytes -= sord_node_alloc_size(node);
+    free(node);
+  }
 }
 
 void
@@ -251,10 +716,11 @@ sord_world_free(SordWorld* world)
   for (ZixHashIter i = zix_hash_begin(world->nodes);
        i != zix_hash_end(world->nodes);
        i = zix_hash_next(world->nodes, i)) {
-    free_node_entry(zix_hash_get(world->nodes, i));
+    free_node_entry(world, zix_hash_get(world->nodes, i));
   }
 
   zix_hash_free(world->nodes);
+  sord_arena_free(&world->node_arena);
   free(world);
 }
 
@@ -376,112 +842,647 @@ sord_quad_compare(const void* x_ptr, const void* y_ptr, const void* user_data)
   return 0;
 }
 
-static inline bool
-sord_iter_forward(SordIter* iter)
+/** Compare node IDs, considering NULL a wildcard match. */
+static inline int
+sord_node_compare_id(const SordNode* a, const SordNode* b)
 {
-  if (!iter->skip_graphs) {
-    zix_btree_iter_increment(&iter->cur);
-    return zix_btree_iter_is_end(iter->cur);
-  }
-
-  SordNode**     key     = (SordNode**)zix_btree_get(iter->cur);
-  const SordQuad initial = {key[0], key[1], key[2], key[3]};
-  zix_btree_iter_increment(&iter->cur);
-  while (!zix_btree_iter_is_end(iter->cur)) {
-    key = (SordNode**)zix_btree_get(iter->cur);
-    for (int i = 0; i < 3; ++i) {
-      if (key[i] != initial[i]) {
-        return false;
-      }
-    }
-
-    zix_btree_iter_increment(&iter->cur);
+  if (a == b || !a || !b) {
+    return 0; // Exact or wildcard match
   }
 
-  return true;
+  return (a->id < b->id) ? -1 : 1;
 }
 
 /**
-   Seek forward as necessary until `iter` points at a match.
-   @return true iff iterator reached end of valid range.
+   Compare two quads by the IDs of their nodes.
+
+   This is a much cheaper order than sord_quad_compare(), but it has no
+   meaning beyond interning order.  Wildcards are treated the same way.
 */
-static inline bool
-sord_iter_seek_match(SordIter* iter)
+static int
+sord_quad_compare_id(const void* x_ptr,
+                     const void* y_ptr,
+                     const void* user_data)
 {
-  for (iter->end = true; !zix_btree_iter_is_end(iter->cur);
-       sord_iter_forward(iter)) {
-    const SordNode** const key = (const SordNode**)zix_btree_get(iter->cur);
-    if (key && sord_quad_match_inline(key, iter->pat)) {
-      return (iter->end = false);
+  const int* const             ordering = (const int*)user_data;
+  const SordNode* const* const x        = (const SordNode* const*)x_ptr;
+  const SordNode* const* const y        = (const SordNode* const*)y_ptr;
+
+  for (int i = 0; i < TUP_LEN; ++i) {
+    const int idx = ordering[i];
+    const int cmp = sord_node_compare_id(x[idx], y[idx]);
+    if (cmp) {
+      return cmp;
     }
   }
-  return true;
+
+  return 0;
+}
+
+/** Compare value records by predicate, value, and then quad ID. */
+static int
+sord_value_compare(const void* x_ptr, const void* y_ptr, const void* user_data)
+{
+  const SordValueRecord* const x = (const SordValueRecord*)x_ptr;
+  const SordValueRecord* const y = (const SordValueRecord*)y_ptr;
+
+  const int cmp = sord_node_compare_id(x->quad[SORD_PREDICATE],
+                                       y->quad[SORD_PREDICATE]);
+  if (cmp) {
+    return cmp;
+  } else if (x->value < y->value) {
+    return -1;
+  } else if (x->value > y->value) {
+    return 1;
+  }
+
+  return sord_quad_compare_id(x->quad, y->quad, user_data);
 }
 
 /**
-   Seek forward as necessary until `iter` points at a match, or the prefix
-   no longer matches iter->pat.
-   @return true iff iterator reached end of valid range.
+   Compare a value record to a key with the same predicate and a minimum.
+
+   Every record with the predicate that isn't below the minimum is equal to
+   the key, so a lower bound always finds the first of them.
 */
+static int
+sord_value_compare_from(const void* x_ptr,
+                        const void* y_ptr,
+                        const void* user_data)
+{
+  const SordValueRecord* const x = (const SordValueRecord*)x_ptr;
+  const SordValueRecord* const y = (const SordValueRecord*)y_ptr;
+
+  (void)user_data;
+
+  const int cmp = sord_node_compare_id(x->quad[SORD_PREDICATE],
+                                       y->quad[SORD_PREDICATE]);
+
+  return cmp ? cmp : (x->value < y->value) ? -1 : 0;
+}
+
+/** Return true iff `quad` is in the compacted records of an index. */
 static inline bool
-sord_iter_seek_match_range(SordIter* iter)
+sord_in_block(const SordStore* const       store,
+              const SordOrder              order,
+              const SordNode* const* const quad)
 {
-  assert(!iter->end);
+  SordQuad* const block = store->blocks[order];
+  const uintptr_t begin = (uintptr_t)block;
+  const uintptr_t end   = (uintptr_t)(block + store->block_sizes[order]);
+  const uintptr_t ptr   = (uintptr_t)quad;
 
-  do {
-    const SordNode** key = (const SordNode**)zix_btree_get(iter->cur);
+  return ptr >= begin && ptr < end;
+}
 
-    if (sord_quad_match_inline(key, iter->pat)) {
-      return false; // Found match
+/*
+  A model from sord_open_binary() has no indices, it searches the sorted
+  arrays of its snapshot directly.  Iterators over it track a position in one
+  of these orders, and patterns are converted to node numbers once.
+*/
+
+/// Return the quad at a position in a mapped order
+static inline const uint32_t*
+sord_mapped_quad(const SordMapping* const mapping,
+                 const SordOrder          order,
+                 const size_t             pos)
+{
+  const uint32_t* const positions = mapping->view.positions[order];
+  return mapping->view.quads[positions ? positions[pos] : pos];
+}
+
+/// Return the number of a node in a mapping, or zero if it isn't there
+static uint32_t
+sord_mapped_id(const SordMapping* const mapping, const SordNode* const node)
+{
+  // Search the table of nodes, which is sorted
+  const size_t n_nodes = (size_t)mapping->view.header->n_nodes;
+  size_t       lo      = 1U;
+  size_t       hi      = n_nodes + 1U;
+  while (lo < hi) {
+    const size_t mid = lo + ((hi - lo) / 2U);
+    const int    cmp = sord_node_compare(mapping->nodes[mid], node);
+    if (cmp < 0) {
+      lo = mid + 1U;
+    } else if (cmp > 0) {
+      hi = mid;
+    } else {
+      return (mapping->nodes[mid] == node) ? (uint32_t)mid : 0U;
     }
+  }
 
-    for (int i = 0; i < iter->n_prefix; ++i) {
-      const int idx = orderings[iter->order][i];
-      if (!sord_id_match(key[idx], iter->pat[idx])) {
-        iter->end = true; // Reached end of valid range
-        return true;
+  return 0U;
+}
+
+/// Return the available order with the longest prefix of bound nodes
+static SordOrder
+sord_mapped_best_order(const SordMapping* const mapping,
+                       const uint32_t* const    ids,
+                       int* const               n_prefix)
+{
+  SordOrder best = DEFAULT_ORDER;
+  *n_prefix      = -1;
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    if ((o == DEFAULT_ORDER || mapping->view.positions[o]) &&
+        (o < GSPO || ids[TUP_G])) {
+      int n = 0;
+      while (n < TUP_LEN && ids[orderings[o][n]]) {
+        ++n;
+      }
+
+      if (n > *n_prefix) {
+        best      = (SordOrder)o;
+        *n_prefix = n;
       }
     }
-  } while (!sord_iter_forward(iter));
+  }
 
-  return (iter->end = true); // Reached end
+  return best;
 }
 
-static SordIter*
-sord_iter_new(const SordModel*   sord,
-              const ZixBTreeIter cur,
-              const SordQuad     pat,
-              SordOrder          order,
-              SearchMode         mode,
-              int                n_prefix)
+static int
+sord_mapped_compare_prefix(const uint32_t* const quad,
+                           const uint32_t* const ids,
+                           const int* const      ordering,
+                           const int             n_prefix)
 {
-  SordIter* iter    = (SordIter*)malloc(sizeof(SordIter));
-  iter->sord        = sord;
-  iter->cur         = cur;
-  iter->order       = order;
-  iter->mode        = mode;
-  iter->n_prefix    = n_prefix;
-  iter->end         = false;
-  iter->skip_graphs = order < GSPO;
-  for (int i = 0; i < TUP_LEN; ++i) {
-    iter->pat[i] = pat[i];
+  for (int i = 0; i < n_prefix; ++i) {
+    const int idx = ordering[i];
+    if (quad[idx] != ids[idx]) {
+      return (quad[idx] < ids[idx]) ? -1 : 1;
+    }
   }
 
-  switch (iter->mode) {
-  case ALL:
-  case SINGLE:
-  case RANGE:
-    assert(sord_quad_match_inline((const SordNode**)zix_btree_get(iter->cur),
-                                  iter->pat));
-    break;
-  case FILTER_RANGE:
-    sord_iter_seek_match_range(iter);
-    break;
-  case FILTER_ALL:
+  return 0;
+}
+
+/// Find the range of positions in a mapped order that start with a prefix
+static void
+sord_mapped_range(const SordMapping* const mapping,
+                  const SordOrder          order,
+                  const uint32_t* const    ids,
+                  const int                n_prefix,
+                  size_t* const            begin,
+                  size_t* const            end)
+{
+  const int* const ordering = orderings[order];
+  const size_t     n        = (order < GSPO)
+                                ? (size_t)mapping->view.header->n_quads
+                                : mapping->view.n_graph;
+
+  size_t lo = 0U;
+  size_t hi = n;
+  while (lo < hi) {
+    const size_t mid = lo + ((hi - lo) / 2U);
+    if (sord_mapped_compare_prefix(
+          sord_mapped_quad(mapping, order, mid), ids, ordering, n_prefix) <
+        0) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+
+  *begin = lo;
+  hi     = n;
+  while (lo < hi) {
+    const size_t mid = lo + ((hi - lo) / 2U);
+    if (sord_mapped_compare_prefix(
+          sord_mapped_quad(mapping, order, mid), ids, ordering, n_prefix) <=
+        0) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+
+  *end = lo;
+}
+
+static inline bool
+sord_mapped_match(const uint32_t* const quad, const uint32_t* const ids)
+{
+  return (!ids[0] || quad[0] == ids[0]) && (!ids[1] || quad[1] == ids[1]) &&
+         (!ids[2] || quad[2] == ids[2]) && (!ids[3] || quad[3] == ids[3]);
+}
+
+/// Return true iff the quad at a position in a mapped order has a triple
+static inline bool
+sord_mapped_has_triple(const SordMapping* const mapping,
+                       const SordOrder          order,
+                       const size_t             pos,
+                       const uint32_t* const    triple)
+{
+  const uint32_t* const quad = sord_mapped_quad(mapping, order, pos);
+
+  return quad[0] == triple[0] && quad[1] == triple[1] && quad[2] == triple[2];
+}
+
+/// Move a mapped iterator forward, past other graphs if necessary
+static void
+sord_mapped_forward(SordIter* const iter)
+{
+  if (!iter->skip_graphs) {
+    ++iter->pos;
+    return;
+  }
+
+  const SordMapping* const mapping = iter->sord->mapping;
+  const SordOrder          order   = iter->order;
+  const uint32_t* const initial = sord_mapped_quad(mapping, order, iter->pos);
+
+  // Gallop to a position past the triple, so long runs take log time
+  size_t lo   = iter->pos + 1U;
+  size_t hi   = lo;
+  size_t size = 1U;
+  while (hi < iter->end_pos &&
+         sord_mapped_has_triple(mapping, order, hi, initial)) {
+    lo = hi + 1U;
+    hi = lo + size;
+    size *= 2U;
+  }
+
+  // Search between the last duplicate and there for the end of the run
+  hi = (hi < iter->end_pos) ? hi : iter->end_pos;
+  while (lo < hi) {
+    const size_t mid = lo + ((hi - lo) / 2U);
+    if (sord_mapped_has_triple(mapping, order, mid, initial)) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+
+  iter->pos = lo;
+}
+
+/**
+   Seek forward as necessary until a mapped iterator points at a match.
+   @return true iff iterator reached end of valid range.
+*/
+static bool
+sord_mapped_seek(SordIter* const iter)
+{
+  const SordMapping* const mapping = iter->sord->mapping;
+  while (iter->pos < iter->end_pos) {
+    const uint32_t* const quad =
+      sord_mapped_quad(mapping, iter->order, iter->pos);
+    ++iter->n_scanned;
+    if (sord_mapped_match(quad, iter->ids)) {
+      return (iter->end = false);
+    }
+
+    sord_mapped_forward(iter);
+  }
+
+  return (iter->end = true);
+}
+
+/// Count a search of an index in the statistics of a model
+static inline void
+sord_count_search(const SordModel* const model,
+                  const SearchMode       mode,
+                  const SordOrder        order)
+{
+  SordStats* const stats = &((SordModel*)model)->stats;
+  size_t* const    counts[] = {&stats->n_all,
+                               &stats->n_single,
+                               &stats->n_range,
+                               &stats->n_filter_range,
+                               &stats->n_filter_all};
+
+  SORD_ATOMIC_INCREMENT(counts[mode]);
+  SORD_ATOMIC_INCREMENT(&stats->n_searches[order]);
+}
+
+/// Search a mapped model like sord_find()
+static SordIter*
+sord_mapped_find(const SordModel* const model, const SordQuad pat)
+{
+  const SordMapping* const mapping = model->mapping;
+
+  uint32_t ids[TUP_LEN] = {0U, 0U, 0U, 0U};
+  for (int i = 0; i < TUP_LEN; ++i) {
+    ids[i] = pat[i] ? sord_mapped_id(mapping, pat[i]) : 0U;
+    if (pat[i] && !ids[i]) {
+      return NULL; // Node isn't in the model at all
+    }
+  }
+
+  int             n_prefix = 0;
+  const SordOrder order    = sord_mapped_best_order(mapping, ids, &n_prefix);
+
+  int n_bound = 0;
+  for (int i = 0; i < TUP_LEN; ++i) {
+    n_bound += ids[i] ? 1 : 0;
+  }
+
+  const SearchMode mode = (n_bound == TUP_LEN) ? SINGLE
+                          : (n_prefix == n_bound)
+                            ? (n_bound ? RANGE : ALL)
+                            : (n_prefix ? FILTER_RANGE : FILTER_ALL);
+  sord_count_search(model, mode, order);
+
+  SordIter* const iter = (SordIter*)malloc(sizeof(SordIter));
+  iter->sord           = model;
+  iter->cur            = zix_btree_end_iter;
+  iter->order          = order;
+  iter->mode           = FILTER_RANGE;
+  iter->n_prefix       = n_prefix;
+  iter->end            = false;
+  iter->skip_graphs    = order < GSPO && !ids[TUP_G];
+  iter->n_scanned      = 0U;
+  iter->n_returned     = 1U;
+  for (int i = 0; i < TUP_LEN; ++i) {
+    iter->pat[i] = pat[i];
+    iter->ids[i] = ids[i];
+  }
+
+  sord_mapped_range(
+    mapping, order, ids, n_prefix, &iter->pos, &iter->end_pos);
+
+  if (sord_mapped_seek(iter)) {
+    free(iter);
+    return NULL;
+  }
+
+  SORD_ATOMIC_INCREMENT(&((SordModel*)model)->n_iters);
+  return iter;
+}
+
+/// Count quads in a mapped model like sord_count(), or an upper bound
+static uint64_t
+sord_mapped_count(const SordModel* const model,
+                  const SordQuad         pat,
+                  const bool             estimate)
+{
+  const SordMapping* const mapping = model->mapping;
+
+  uint32_t ids[TUP_LEN] = {0U, 0U, 0U, 0U};
+  int      n_bound      = 0;
+  for (int i = 0; i < TUP_LEN; ++i) {
+    ids[i] = pat[i] ? sord_mapped_id(mapping, pat[i]) : 0U;
+    if (pat[i] && !ids[i]) {
+      return 0U; // Node isn't in the model at all
+    }
+
+    n_bound += ids[i] ? 1 : 0;
+  }
+
+  int             n_prefix = 0;
+  size_t          begin    = 0U;
+  size_t          end      = 0U;
+  const SordOrder order    = sord_mapped_best_order(mapping, ids, &n_prefix);
+  sord_mapped_range(mapping, order, ids, n_prefix, &begin, &end);
+
+  // The range is exact if there's no filtering and no graphs to skip
+  const bool distinct = order >= GSPO || ids[TUP_G] || !mapping->view.n_graph;
+  if (estimate || (n_bound == n_prefix && distinct)) {
+    return end - begin;
+  }
+
+  SordIter* i = sord_mapped_find(model, pat);
+  uint64_t  n = 0U;
+  for (; !sord_iter_end(i); sord_iter_next(i)) {
+    ++n;
+  }
+  sord_iter_free(i);
+  return n;
+}
+
+/** Comparator and ordering for seeking past a prefix. */
+typedef struct {
+  ZixCompareFunc compare;
+  const int*     ordering;
+} SordSeekPast;
+
+/** Compare quads, treating those equal to the key as before it. */
+static int
+sord_quad_compare_past(const void* x_ptr,
+                       const void* y_ptr,
+                       const void* user_data)
+{
+  const SordSeekPast* const past = (const SordSeekPast*)user_data;
+  const int cmp = past->compare(x_ptr, y_ptr, past->ordering);
+
+  return cmp ? cmp : -1;
+}
+
+static inline bool
+sord_iter_forward(SordIter* iter)
+{
+  if (!iter->skip_graphs) {
+    zix_btree_iter_increment(&iter->cur);
+    return zix_btree_iter_is_end(iter->cur);
+  }
+
+  SordNode**     key     = (SordNode**)zix_btree_get(iter->cur);
+  const SordQuad initial = {key[0], key[1], key[2], NULL};
+  zix_btree_iter_increment(&iter->cur);
+  for (unsigned n_steps = 0U; !zix_btree_iter_is_end(iter->cur); ++n_steps) {
+    key = (SordNode**)zix_btree_get(iter->cur);
+    for (int i = 0; i < 3; ++i) {
+      if (key[i] != initial[i]) {
+        return false;
+      }
+    }
+
+    if (n_steps == SORD_SCAN_STEPS && iter->mode != VALUES) {
+      // Seek past the remaining graphs of a triple that's in many
+      const SordModel* const model = iter->sord;
+      const SordSeekPast     past  = {model->compare, orderings[iter->order]};
+      ZixBTree* const        db    = model->store->indices[iter->order];
+      ZixBTreeIter           cur   = zix_btree_end_iter;
+
+      zix_btree_lower_bound(db, sord_quad_compare_past, &past, initial, &cur);
+      if (!zix_btree_iter_is_end(cur)) {
+        iter->cur = cur;
+        return false;
+      }
+    }
+
+    zix_btree_iter_increment(&iter->cur);
+  }
+
+  return true;
+}
+
+/**
+   Seek to the next record that could match, if `key` doesn't.
+
+   This finds the first bound position in index order where `key` differs
+   from the pattern.  If `key` is before the pattern there, the iterator
+   seeks to the pattern value, and if it's after, past every record that
+   shares the key up to the last free position before it.
+
+   @return True iff the iterator was moved, otherwise it should be stepped.
+*/
+static bool
+sord_iter_skip(SordIter* const iter, const SordNode* const* const key)
+{
+  const SordModel* const model    = iter->sord;
+  const int* const       ordering = orderings[iter->order];
+  const SordNode* const* pat      = iter->pat;
+
+  int i = 0;
+  for (; i < TUP_LEN; ++i) {
+    const int idx = ordering[i];
+    if (pat[idx] && key[idx] != pat[idx]) {
+      break;
+    }
+  }
+
+  if (i == TUP_LEN) {
+    return false;
+  }
+
+  const int idx = ordering[i];
+  const int cmp = (model->compare == sord_quad_compare_id)
+                    ? sord_node_compare_id(key[idx], pat[idx])
+                    : sord_node_compare(key[idx], pat[idx]);
+
+  const SordNode* seek[TUP_LEN] = {NULL, NULL, NULL, NULL};
+  ZixBTree* const db            = model->store->indices[iter->order];
+  ZixBTreeIter    cur           = zix_btree_end_iter;
+  if (cmp < 0) {
+    // Seek forward to the pattern value, keeping everything before it
+    for (int j = 0; j < i; ++j) {
+      seek[ordering[j]] = key[ordering[j]];
+    }
+
+    seek[idx] = pat[idx];
+    zix_btree_lower_bound(db, model->compare, ordering, seek, &cur);
+  } else {
+    // Seek past every record with this value at the last free position
+    int j = i - 1;
+    while (j >= 0 && pat[ordering[j]]) {
+      --j;
+    }
+
+    const int last = (j < 0) ? i - 1 : j;
+    if (last < 0) {
+      return false;
+    }
+
+    for (int k = 0; k <= last; ++k) {
+      seek[ordering[k]] = key[ordering[k]];
+    }
+
+    const SordSeekPast past = {model->compare, ordering};
+    zix_btree_lower_bound(db, sord_quad_compare_past, &past, seek, &cur);
+  }
+
+  /* When there is no equal record, the lower bound may spuriously be the end
+     if the next record is in a parent node, so only trust other results. */
+  if (zix_btree_iter_is_end(cur)) {
+    return false;
+  }
+
+  iter->cur = cur;
+  return true;
+}
+
+/**
+   Seek forward as necessary until `iter` points at a match.
+   @return true iff iterator reached end of valid range.
+*/
+static inline bool
+sord_iter_seek_match(SordIter* iter)
+{
+  unsigned n_misses = 0U;
+  for (iter->end = true; !zix_btree_iter_is_end(iter->cur);) {
+    const SordNode** const key = (const SordNode**)zix_btree_get(iter->cur);
+    ++iter->n_scanned;
+    if (key && sord_quad_match_inline(key, iter->pat)) {
+      return (iter->end = false);
+    }
+
+    if (++n_misses > SORD_SCAN_STEPS && sord_iter_skip(iter, key)) {
+      n_misses = 0U;
+    } else {
+      sord_iter_forward(iter);
+    }
+  }
+  return true;
+}
+
+/**
+   Seek forward as necessary until `iter` points at a match, or the prefix
+   no longer matches iter->pat.
+   @return true iff iterator reached end of valid range.
+*/
+static inline bool
+sord_iter_seek_match_range(SordIter* iter)
+{
+  assert(!iter->end);
+
+  for (unsigned n_misses = 0U;;) {
+    const SordNode** key = (const SordNode**)zix_btree_get(iter->cur);
+
+    ++iter->n_scanned;
+    if (sord_quad_match_inline(key, iter->pat)) {
+      return false; // Found match
+    }
+
+    for (int i = 0; i < iter->n_prefix; ++i) {
+      const int idx = orderings[iter->order][i];
+      if (!sord_id_match(key[idx], iter->pat[idx])) {
+        iter->end = true; // Reached end of valid range
+        return true;
+      }
+    }
+
+    // Seek past long runs of mismatches rather than stepping over them
+    if (++n_misses > SORD_SCAN_STEPS && sord_iter_skip(iter, key)) {
+      n_misses = 0U;
+    } else if (sord_iter_forward(iter)) {
+      return (iter->end = true); // Reached end
+    }
+  }
+}
+
+static SordIter*
+sord_iter_new(const SordModel*   sord,
+              const ZixBTreeIter cur,
+              const SordQuad     pat,
+              SordOrder          order,
+              SearchMode         mode,
+              int                n_prefix)
+{
+  SordIter* iter    = (SordIter*)malloc(sizeof(SordIter));
+  iter->sord        = sord;
+  iter->cur         = cur;
+  iter->order       = order;
+  iter->mode        = mode;
+  iter->n_prefix    = n_prefix;
+  iter->end         = false;
+  iter->skip_graphs = order < GSPO;
+  iter->n_scanned   = 0U;
+  iter->n_returned  = 0U;
+  iter->max_value   = 0.0;
+  for (int i = 0; i < TUP_LEN; ++i) {
+    iter->pat[i] = pat[i];
+  }
+
+  switch (iter->mode) {
+  case ALL:
+  case SINGLE:
+  case RANGE:
+  case VALUES:
+    assert(sord_quad_match_inline((const SordNode**)zix_btree_get(iter->cur),
+                                  iter->pat));
+    iter->n_scanned = 1U;
+    break;
+  case FILTER_RANGE:
+    sord_iter_seek_match_range(iter);
+    break;
+  case FILTER_ALL:
     sord_iter_seek_match(iter);
     break;
   }
 
+  iter->n_returned = iter->end ? 0U : 1U;
+
 #ifdef SORD_DEBUG_ITER
   SordQuad value;
   sord_iter_get(iter, value);
@@ -493,7 +1494,7 @@ sord_iter_new(const SordModel*   sord,
                 iter->skip_graphs);
 #endif
 
-  ++((SordModel*)sord)->n_iters;
+  SORD_ATOMIC_INCREMENT(&((SordModel*)sord)->n_iters);
   return iter;
 }
 
@@ -506,6 +1507,16 @@ sord_iter_get_model(SordIter* iter)
 void
 sord_iter_get(const SordIter* iter, SordQuad tup)
 {
+  const SordMapping* const mapping = iter->sord->mapping;
+  if (mapping) {
+    const uint32_t* const ids =
+      sord_mapped_quad(mapping, iter->order, iter->pos);
+    for (int i = 0; i < TUP_LEN; ++i) {
+      tup[i] = mapping->nodes[ids[i]];
+    }
+    return;
+  }
+
   SordNode** key = (SordNode**)zix_btree_get(iter->cur);
   for (int i = 0; i < TUP_LEN; ++i) {
     tup[i] = key[i];
@@ -515,6 +1526,12 @@ sord_iter_get(const SordIter* iter, SordQuad tup)
 const SordNode*
 sord_iter_get_node(const SordIter* iter, SordQuadIndex index)
 {
+  if (!sord_iter_end(iter) && iter->sord->mapping) {
+    const SordMapping* const mapping = iter->sord->mapping;
+    return mapping->nodes[sord_mapped_quad(
+      mapping, iter->order, iter->pos)[index]];
+  }
+
   return (!sord_iter_end(iter) ? ((SordNode**)zix_btree_get(iter->cur))[index]
                                : NULL);
 }
@@ -526,11 +1543,13 @@ sord_iter_scan_next(SordIter* iter)
     return true;
   }
 
-  const SordNode** key = NULL;
+  const SordNode**       key   = NULL;
+  const SordValueRecord* value = NULL;
   if (!iter->end) {
     switch (iter->mode) {
     case ALL:
       // At the end if the cursor is (assigned above)
+      ++iter->n_scanned;
       break;
     case SINGLE:
       iter->end = true;
@@ -541,6 +1560,7 @@ sord_iter_scan_next(SordIter* iter)
       // At the end if the MSNs no longer match
       key = (const SordNode**)zix_btree_get(iter->cur);
       assert(key);
+      ++iter->n_scanned;
       for (int i = 0; i < iter->n_prefix; ++i) {
         const int idx = orderings[iter->order][i];
         if (!sord_id_match(key[idx], iter->pat[idx])) {
@@ -558,6 +1578,13 @@ sord_iter_scan_next(SordIter* iter)
       // Seek forward to next match
       sord_iter_seek_match(iter);
       break;
+    case VALUES:
+      // At the end if the predicate changes or the value is past the maximum
+      value     = (const SordValueRecord*)zix_btree_get(iter->cur);
+      iter->end = value->quad[SORD_PREDICATE] != iter->pat[SORD_PREDICATE] ||
+                  value->value > iter->max_value;
+      ++iter->n_scanned;
+      break;
     }
   } else {
     SORD_ITER_LOG("%p reached index end\n", (void*)iter);
@@ -573,6 +1600,7 @@ sord_iter_scan_next(SordIter* iter)
     SORD_ITER_LOG(
       "%p Increment to " TUP_FMT "\n", (void*)iter, TUP_FMT_ARGS(tup));
 #endif
+    ++iter->n_returned;
     return false;
   }
 }
@@ -584,22 +1612,119 @@ sord_iter_next(SordIter* iter)
     return true;
   }
 
+  if (iter->sord->mapping) {
+    sord_mapped_forward(iter);
+    if (sord_mapped_seek(iter)) {
+      return true;
+    }
+
+    ++iter->n_returned;
+    return false;
+  }
+
   iter->end = sord_iter_forward(iter);
   return sord_iter_scan_next(iter);
 }
 
-bool
-sord_iter_end(const SordIter* iter)
-{
-  return !iter || iter->end;
-}
+/**
+   Copy up to `max` quads or fields of quads from `iter` and move past them.
+
+   Exactly one of `quads` and `nodes` is non-null, and `index` is the field to
+   copy to `nodes`.  Complete ranges are read with a tight loop over the index,
+   which skips other graphs of each triple like sord_iter_next(), everything
+   else moves with sord_iter_next().
+*/
+static size_t
+sord_iter_read(SordIter* const        iter,
+               SordQuad* const        quads,
+               const SordNode** const nodes,
+               const SordQuadIndex    index,
+               const size_t           max)
+{
+  size_t n = 0U;
+  if (sord_iter_end(iter)) {
+    return n;
+  }
+
+  if (iter->sord->mapping || (iter->mode != ALL && iter->mode != RANGE)) {
+    for (; n < max && !iter->end; ++n) {
+      if (quads) {
+        sord_iter_get(iter, quads[n]);
+      } else {
+        nodes[n] = sord_iter_get_node(iter, index);
+      }
+
+      sord_iter_next(iter);
+    }
+
+    return n;
+  }
+
+  const int* const       ordering = orderings[iter->order];
+  const SordNode* const* key      = (const SordNode**)zix_btree_get(iter->cur);
+  while (n < max) {
+    if (quads) {
+      const SordNode** const quad = quads[n];
+      quad[0]                     = key[0];
+      quad[1]                     = key[1];
+      quad[2]                     = key[2];
+      quad[3]                     = key[3];
+    } else {
+      nodes[n] = key[index];
+    }
+
+    ++n;
+    if (sord_iter_forward(iter)) {
+      iter->end = true;
+      break;
+    }
+
+    ++iter->n_scanned;
+    key = (const SordNode**)zix_btree_get(iter->cur);
+    for (int i = 0; i < iter->n_prefix; ++i) {
+      const int idx = ordering[i];
+      if (!sord_id_match(key[idx], iter->pat[idx])) {
+        iter->end = true; // Reached end of range
+        return n;
+      }
+    }
+
+    ++iter->n_returned;
+  }
+
+  return n;
+}
+
+size_t
+sord_iter_get_batch(SordIter* iter, SordQuad* quads, size_t max)
+{
+  return sord_iter_read(iter, quads, NULL, SORD_SUBJECT, max);
+}
+
+size_t
+sord_iter_get_nodes(SordIter*        iter,
+                    SordQuadIndex    index,
+                    const SordNode** nodes,
+                    size_t           max)
+{
+  return sord_iter_read(iter, NULL, nodes, index, max);
+}
+
+bool
+sord_iter_end(const SordIter* iter)
+{
+  return !iter || iter->end;
+}
 
 void
 sord_iter_free(SordIter* iter)
 {
   SORD_ITER_LOG("%p Free\n", (void*)iter);
   if (iter) {
-    --((SordModel*)iter->sord)->n_iters;
+    SordModel* const model = (SordModel*)iter->sord;
+    SORD_ATOMIC_ADD(&model->stats.n_scanned, iter->n_scanned);
+    SORD_ATOMIC_ADD(&model->stats.n_returned, iter->n_returned);
+    SORD_ATOMIC_DECREMENT(&model->n_iters);
     free(iter);
   }
 }
@@ -617,7 +1742,7 @@ sord_has_index(SordModel* model, SordOrder* order, int* n_prefix, bool graphs)
     *n_prefix += 1;
   }
 
-  return model->indices[*order];
+  return model->store->indices[*order];
 }
 
 /**
@@ -705,45 +1830,126 @@ sord_best_index(SordModel*     sord,
   }
 }
 
+static SordStore*
+sord_store_new(void)
+{
+  SordStore* const store = (SordStore*)malloc(sizeof(SordStore));
+
+  store->n_quads          = 0U;
+  store->refs             = 1U;
+  store->quad_arena.slabs = NULL;
+  store->free_quads       = NULL;
+  store->ranked           = false;
+  for (unsigned o = 0; o < NUM_ORDERS; ++o) {
+    store->indices[o]     = NULL;
+    store->blocks[o]      = NULL;
+    store->block_sizes[o] = 0U;
+  }
+  for (unsigned o = 0; o < (NUM_ORDERS / 2); ++o) {
+    store->ranks[o] = NULL;
+  }
+  store->values = NULL;
+
+  return store;
+}
+
+/** Initialize a model with no change sink or log. */
+static void
+sord_init_changes(SordModel* const model)
+{
+  model->change_sink   = NULL;
+  model->change_handle = NULL;
+  model->change_seq    = 0U;
+  model->changes       = NULL;
+  model->log_size      = 0U;
+  model->n_logged      = 0U;
+}
+
 SordModel*
 sord_new(SordWorld* world, unsigned indices, bool graphs)
 {
-  SordModel* model = (SordModel*)malloc(sizeof(struct SordModelImpl));
-  model->world     = world;
-  model->n_quads   = 0;
-  model->n_iters   = 0;
+  SordModel* model   = (SordModel*)malloc(sizeof(struct SordModelImpl));
+  model->world       = world;
+  model->store       = sord_store_new();
+  model->n_iters     = 0;
+  model->read_only   = false;
+  model->is_snapshot = false;
+  model->mapping     = NULL;
+  model->bulk        = NULL;
+  model->n_bulk      = 0;
+  model->bulk_size   = 0;
+  model->in_bulk     = false;
+
+  model->index_threshold = 0U;
+  for (unsigned o = 0U; o < (NUM_ORDERS / 2); ++o) {
+    model->misses[o] = 0U;
+  }
+  sord_reset_stats(model);
+  sord_init_changes(model);
+  model->compare =
+    (indices & SORD_ID_ORDER) ? sord_quad_compare_id : sord_quad_compare;
 
+  ZixBTree** const trees = model->store->indices;
   for (unsigned i = 0; i < (NUM_ORDERS / 2); ++i) {
     const int* const ordering   = orderings[i];
     const int* const g_ordering = orderings[i + (NUM_ORDERS / 2)];
 
     if (indices & (1U << i)) {
-      model->indices[i] =
-        zix_btree_new(NULL, sord_quad_compare, (void*)ordering);
+      trees[i] = zix_btree_new(NULL, model->compare, ordering);
       if (graphs) {
-        model->indices[i + (NUM_ORDERS / 2)] =
-          zix_btree_new(NULL, sord_quad_compare, (void*)g_ordering);
-      } else {
-        model->indices[i + (NUM_ORDERS / 2)] = NULL;
+        trees[i + (NUM_ORDERS / 2)] =
+          zix_btree_new(NULL, model->compare, g_ordering);
       }
-    } else {
-      model->indices[i]                    = NULL;
-      model->indices[i + (NUM_ORDERS / 2)] = NULL;
     }
   }
 
-  if (!model->indices[DEFAULT_ORDER]) {
-    model->indices[DEFAULT_ORDER] =
-      zix_btree_new(NULL, sord_quad_compare, (void*)orderings[DEFAULT_ORDER]);
+  if (!trees[DEFAULT_ORDER]) {
+    trees[DEFAULT_ORDER] =
+      zix_btree_new(NULL, model->compare, orderings[DEFAULT_ORDER]);
+  }
+  if (graphs && !trees[DEFAULT_GRAPH_ORDER]) {
+    trees[DEFAULT_GRAPH_ORDER] =
+      zix_btree_new(NULL, model->compare, orderings[DEFAULT_GRAPH_ORDER]);
   }
-  if (graphs && !model->indices[DEFAULT_GRAPH_ORDER]) {
-    model->indices[DEFAULT_GRAPH_ORDER] = zix_btree_new(
-      NULL, sord_quad_compare, (void*)orderings[DEFAULT_GRAPH_ORDER]);
+  if (indices & SORD_VALUES) {
+    model->store->values =
+      zix_btree_new(NULL, sord_value_compare, orderings[DEFAULT_ORDER]);
   }
 
   return model;
 }
 
+SordModel*
+sord_snapshot(SordModel* model)
+{
+  SordModel* snapshot   = (SordModel*)malloc(sizeof(struct SordModelImpl));
+  snapshot->world       = model->world;
+  snapshot->store       = model->store;
+  snapshot->compare     = model->compare;
+  snapshot->n_iters     = 0;
+  snapshot->read_only   = true;
+  snapshot->is_snapshot = true;
+  snapshot->mapping     = model->mapping;
+  snapshot->bulk        = NULL;
+  snapshot->n_bulk      = 0;
+  snapshot->bulk_size   = 0;
+  snapshot->in_bulk     = false;
+
+  snapshot->index_threshold = 0U;
+  for (unsigned o = 0U; o < (NUM_ORDERS / 2); ++o) {
+    snapshot->misses[o] = 0U;
+  }
+  sord_reset_stats(snapshot);
+  sord_init_changes(snapshot);
+  snapshot->change_seq = model->change_seq;
+
+  SORD_ATOMIC_INCREMENT(&model->store->refs);
+  if (model->mapping) {
+    SORD_ATOMIC_INCREMENT(&model->mapping->refs);
+  }
+  return snapshot;
+}
+
 static void
 sord_node_free_internal(SordWorld* world, SordNode* node)
 {
@@ -755,11 +1961,10 @@ sord_node_free_internal(SordWorld* world, SordNode* node)
   // Remove node from the hash table
   ZixHashRecord* removed = NULL;
   if (!zix_hash_remove(world->nodes, node, &removed)) {
-    free((uint8_t*)removed->node.buf);
     if (removed->node.type == SERD_LITERAL) {
       sord_node_free(world, removed->meta.lit.datatype);
     }
-    free(removed);
+    free_node_entry(world, removed);
   } else {
     error(world, SERD_ERR_INTERNAL, "failed to remove node from hash\n");
   }
@@ -772,9 +1977,9 @@ sord_add_quad_ref(SordModel* model, const SordNode* node, SordQuadIndex i)
 
   if (node) {
     assert(node->refs > 0);
-    ++((SordNode*)node)->refs;
+    SORD_ATOMIC_INCREMENT(&((SordNode*)node)->refs);
     if (node->node.type != SERD_LITERAL && i == SORD_OBJECT) {
-      ++((SordNode*)node)->meta.res.refs_as_obj;
+      SORD_ATOMIC_INCREMENT(&((SordNode*)node)->meta.res.refs_as_obj);
     }
   }
 }
@@ -789,45 +1994,326 @@ sord_drop_quad_ref(SordModel* model, const SordNode* node, SordQuadIndex i)
   assert(node->refs > 0);
   if (node->node.type != SERD_LITERAL && i == SORD_OBJECT) {
     assert(node->meta.res.refs_as_obj > 0);
-    --((SordNode*)node)->meta.res.refs_as_obj;
+    SORD_ATOMIC_DECREMENT(&((SordNode*)node)->meta.res.refs_as_obj);
   }
-  if (--((SordNode*)node)->refs == 0) {
+  if (SORD_ATOMIC_DECREMENT(&((SordNode*)node)->refs) == 0) {
     sord_node_free_internal(sord_get_world(model), (SordNode*)node);
   }
 }
 
+static void
+sord_value_record_free(void* const ptr, const void* const user_data)
+{
+  (void)user_data;
+  free(ptr);
+}
+
+/** Drop a quad's reference to a node, leaving it for sord_sweep_nodes(). */
+static void
+sord_release_quad_ref(const SordNode* const node, const SordQuadIndex i)
+{
+  if (node) {
+    assert(node->refs > 0);
+    if (node->node.type != SERD_LITERAL && i == SORD_OBJECT) {
+      SORD_ATOMIC_DECREMENT(&((SordNode*)node)->meta.res.refs_as_obj);
+    }
+    SORD_ATOMIC_DECREMENT(&((SordNode*)node)->refs);
+  }
+}
+
+/** Return the first node in a world that is no longer referenced, or null. */
+static SordNode*
+sord_find_unreferenced(const SordWorld* const world)
+{
+  for (ZixHashIter i = zix_hash_begin(world->nodes);
+       i != zix_hash_end(world->nodes);
+       i = zix_hash_next(world->nodes, i)) {
+    SordNode* const node = zix_hash_get(world->nodes, i);
+    if (!SORD_ATOMIC_ACQUIRE(&node->refs)) {
+      return node;
+    }
+  }
+
+  return NULL;
+}
+
+/** Remove a node from a world, and return its datatype if it became unused. */
+static SordNode*
+sord_remove_unreferenced(SordWorld* const world, SordNode* const node)
+{
+  ZixHashRecord* removed = NULL;
+  if (zix_hash_remove(world->nodes, node, &removed)) {
+    error(world, SERD_ERR_INTERNAL, "failed to remove node from hash\n");
+    return NULL;
+  }
+
+  SordNode* const datatype =
+    node->node.type == SERD_LITERAL ? node->meta.lit.datatype : NULL;
+
+  free_node_entry(world, node);
+  return (datatype && !SORD_ATOMIC_DECREMENT(&datatype->refs)) ? datatype
+                                                               : NULL;
+}
+
+/** Free every node in a world that is no longer referenced. */
+static void
+sord_sweep_nodes(SordWorld* const world)
+{
+  /* Erasing invalidates hash iterators, so collect the unused nodes first.
+     Each released datatype is appended, and there can't be more unused nodes
+     than nodes, so the array never needs to grow. */
+  const size_t     n_nodes = zix_hash_size(world->nodes);
+  SordNode** const unused  = (SordNode**)malloc(n_nodes * sizeof(SordNode*));
+  if (!unused) {
+    // Fall back to starting a new walk after every removal
+    for (SordNode* node = NULL; (node = sord_find_unreferenced(world));) {
+      sord_remove_unreferenced(world, node);
+    }
+    return;
+  }
+
+  size_t n_unused = 0U;
+  for (ZixHashIter i = zix_hash_begin(world->nodes);
+       i != zix_hash_end(world->nodes);
+       i = zix_hash_next(world->nodes, i)) {
+    SordNode* const node = zix_hash_get(world->nodes, i);
+    if (!SORD_ATOMIC_ACQUIRE(&node->refs)) {
+      unused[n_unused++] = node;
+    }
+  }
+
+  for (size_t i = 0U; i < n_unused; ++i) {
+    SordNode* const datatype = sord_remove_unreferenced(world, unused[i]);
+    if (datatype) {
+      assert(n_unused < n_nodes);
+      unused[n_unused++] = datatype;
+    }
+  }
+
+  free(unused);
+}
+
+/** Free the nodes left unused by snapshots released since the last sweep. */
+static void
+sord_sweep_released(SordWorld* const world)
+{
+  const size_t n_released = SORD_ATOMIC_LOAD(&world->n_released);
+  if (n_released != world->n_swept) {
+    world->n_swept = n_released;
+    sord_sweep_nodes(world);
+  }
+}
+
+/**
+   Free a store and its quads.
+
+   If `drop_refs` is false, then node references held by quads are left as
+   they are, which is only correct when the world is about to be freed.
+
+   A snapshot may be freed by a reader while another thread writes to the
+   world, so it only counts references down, and leaves any unused nodes in
+   the world for the writer to free with sord_sweep_released().
+*/
+static void
+sord_store_free(SordModel* const model,
+                SordStore* const store,
+                const bool       drop_refs)
+{
+  SordWorld* const world = model->world;
+
+  /* Dropping references one at a time removes each node from the world as it
+     is released, so for stores that hold much of the world, it's faster to
+     only count them down, then free the unused nodes in one pass. */
+  const bool defer = drop_refs && model->is_snapshot;
+  const bool sweep = drop_refs && !defer &&
+                     store->n_quads * TUP_LEN >= zix_hash_size(world->nodes);
+
+  // Drop node references held by quads, and free them
+  ZixBTreeIter t = zix_btree_begin(store->indices[DEFAULT_ORDER]);
+  for (; !zix_btree_iter_is_end(t); zix_btree_iter_increment(&t)) {
+    const SordNode** const quad = (const SordNode**)zix_btree_get(t);
+    for (int i = 0; drop_refs && i < TUP_LEN; ++i) {
+      if (defer || sweep) {
+        sord_release_quad_ref(quad[i], (SordQuadIndex)i);
+      } else {
+        sord_drop_quad_ref(model, quad[i], (SordQuadIndex)i);
+      }
+    }
+
+    if (!world->use_arena && !sord_in_block(store, DEFAULT_ORDER, quad)) {
+      free(quad);
+    }
+  }
+
+  if (sweep) {
+    sord_sweep_nodes(world);
+  } else if (defer) {
+    SORD_ATOMIC_INCREMENT(&world->n_released);
+  }
+
+  if (world->use_arena) {
+    sord_arena_free(&store->quad_arena);
+  }
+
+  // Free indices and their compacted records
+  for (unsigned o = 0; o < NUM_ORDERS; ++o) {
+    if (store->indices[o]) {
+      zix_btree_free(store->indices[o], NULL, NULL);
+    }
+    free(store->blocks[o]);
+  }
+  for (unsigned o = 0; o < (NUM_ORDERS / 2); ++o) {
+    free(store->ranks[o]);
+  }
+  if (store->values) {
+    zix_btree_free(store->values, sord_value_record_free, NULL);
+  }
+
+  free(store);
+}
+
+/** Drop a model's reference to its store, and free it if that was the last */
+static void
+sord_store_release(SordModel* const model, SordStore* const store)
+{
+  if (SORD_ATOMIC_DECREMENT(&store->refs) == 0U) {
+    sord_store_free(model, store, true);
+  }
+}
+
+/**
+   Drop a mapping's reference to one of its records.
+
+   If the node is still used elsewhere, then its string is copied out of the
+   mapping so that it can stay in the world, otherwise it is freed.
+*/
+static void
+sord_mapping_release_record(SordWorld* const         world,
+                            const SordMapping* const mapping,
+                            const size_t             number)
+{
+  SordNode* const node    = mapping->records[number];
+  ZixHashRecord*  removed = NULL;
+  if (node->node.type != SERD_LITERAL) {
+    node->meta.res.refs_as_obj -= mapping->n_as_obj[number];
+  }
+
+  if (SORD_ATOMIC_DECREMENT(&node->refs) != 0U) {
+    const size_t   size = node->node.n_bytes + 1U;
+    uint8_t* const buf  = (uint8_t*)sord_node_alloc(world, size);
+    memcpy(buf, node->node.buf, size);
+    node->node.buf = buf;
+    return;
+  }
+
+  if (zix_hash_remove(world->nodes, node, &removed)) {
+    error(world, SERD_ERR_INTERNAL, "failed to remove node from hash\n");
+  }
+
+  if (node->node.type == SERD_LITERAL) {
+    sord_node_free(world, node->meta.lit.datatype);
+  }
+
+  if (!world->use_arena) {
+    world->node_bytes -= sord_node_record_size(node);
+    free(node);
+  }
+}
+
+/// Release a reference to a mapping, and free it if it is no longer used
+static void
+sord_mapping_release(SordWorld* const world, SordMapping* const mapping)
+{
+  if (SORD_ATOMIC_DECREMENT(&mapping->refs) != 0U) {
+    return;
+  }
+
+  // Drop references to nodes that were already in the world
+  const size_t n_nodes =
+    mapping->nodes ? (size_t)mapping->view.header->n_nodes : 0U;
+  for (size_t i = 1U; i <= n_nodes; ++i) {
+    SordNode* const node = mapping->nodes[i];
+    if (node && node != mapping->records[i]) {
+      if (node->node.type != SERD_LITERAL) {
+        node->meta.res.refs_as_obj -= mapping->n_as_obj[i];
+      }
+      sord_node_free(world, node);
+    }
+  }
+
+  // Release records, literals first since they refer to their datatypes
+  for (unsigned pass = 0U; pass < 2U; ++pass) {
+    for (size_t i = 1U; i <= n_nodes; ++i) {
+      SordNode* const node = mapping->records[i];
+      if (node && (node->node.type == SERD_LITERAL) == (pass == 0U)) {
+        sord_mapping_release_record(world, mapping, i);
+        mapping->records[i] = NULL;
+      }
+    }
+  }
+
+#if USE_MMAP
+  if (mapping->is_mapped) {
+    munmap(mapping->data, mapping->size);
+  } else {
+    free(mapping->data);
+  }
+#else
+  free(mapping->data);
+#endif
+
+  free(mapping->n_as_obj);
+  free(mapping->nodes);
+  free(mapping->records);
+  free(mapping);
+}
+
 void
 sord_free(SordModel* model)
 {
   if (!model) {
     return;
+  } else if (!model->is_snapshot) {
+    sord_sweep_released(model->world);
   }
 
-  // Free nodes
-  SordQuad  tup;
-  SordIter* i = sord_begin(model);
-  for (; !sord_iter_end(i); sord_iter_next(i)) {
-    sord_iter_get(i, tup);
+  // Drop references held by uncommitted bulk quads
+  for (size_t b = 0U; b < model->n_bulk; ++b) {
     for (int t = 0; t < TUP_LEN; ++t) {
-      sord_drop_quad_ref(model, tup[t], (SordQuadIndex)t);
+      sord_drop_quad_ref(model, model->bulk[b][t], (SordQuadIndex)t);
     }
   }
-  sord_iter_free(i);
+  free(model->bulk);
 
-  // Free quads
-  ZixBTreeIter t = zix_btree_begin(model->indices[DEFAULT_ORDER]);
-  for (; !zix_btree_iter_is_end(t); zix_btree_iter_increment(&t)) {
-    free(zix_btree_get(t));
+  sord_set_change_log_size(model, 0U);
+  sord_store_release(model, model->store);
+  if (model->mapping) {
+    sord_mapping_release(model->world, model->mapping);
+  }
+  free(model);
+}
+
+void
+sord_free_with_world(SordModel* model)
+{
+  if (!model) {
+    return;
   }
 
-  // Free indices
-  for (unsigned o = 0; o < NUM_ORDERS; ++o) {
-    if (model->indices[o]) {
-      zix_btree_free(model->indices[o], NULL, NULL);
+  SordWorld* const world = model->world;
+  if (model->mapping) {
+    sord_free(model); // Mapped nodes must be removed from the world first
+  } else {
+    // Free everything without dropping node references, since nodes are freed
+    free(model->bulk);
+    free(model->changes);
+    if (SORD_ATOMIC_DECREMENT(&model->store->refs) == 0U) {
+      sord_store_free(model, model->store, false);
     }
+    free(model);
   }
 
-  free(model);
+  sord_world_free(world);
 }
 
 SordWorld*
@@ -839,12 +2325,13 @@ sord_get_world(SordModel* model)
 size_t
 sord_num_quads(const SordModel* model)
 {
-  return model->n_quads;
+  return model->store->n_quads;
 }
 
 size_t
 sord_num_nodes(const SordWorld* world)
 {
+  sord_sweep_released((SordWorld*)world);
   return zix_hash_size(world->nodes);
 }
 
@@ -853,13 +2340,45 @@ sord_begin(const SordModel* model)
 {
   if (sord_num_quads(model) == 0) {
     return NULL;
+  } else if (model->mapping) {
+    const SordQuad pat = {0, 0, 0, 0};
+    return sord_mapped_find(model, pat);
   } else {
-    const ZixBTreeIter cur = zix_btree_begin(model->indices[DEFAULT_ORDER]);
-    SordQuad           pat = {0, 0, 0, 0};
+    const ZixBTreeIter cur =
+      zix_btree_begin(model->store->indices[DEFAULT_ORDER]);
+    SordQuad pat = {0, 0, 0, 0};
+    sord_count_search(model, ALL, DEFAULT_ORDER);
     return sord_iter_new(model, cur, pat, DEFAULT_ORDER, ALL, 0);
   }
 }
 
+SordIter*
+sord_begin_all(const SordModel* model)
+{
+  SordIter* const iter = sord_begin(model);
+  if (iter) {
+    iter->skip_graphs = false;
+  }
+
+  return iter;
+}
+
+/** Count a search that filtered because its ideal index is missing. */
+static void
+sord_count_miss(SordModel* const model, const SordQuad pat)
+{
+  // Ideal index for each combination of bound S, P, and O (see above)
+  static const SordOrder wanted[8] = {SPO, OPS, POS, OPS, SPO, SOP, SPO, SPO};
+
+  const unsigned sig =
+    (pat[0] ? 4U : 0U) | (pat[1] ? 2U : 0U) | (pat[2] ? 1U : 0U);
+
+  const SordOrder order = wanted[sig];
+  if (!model->store->indices[order]) {
+    SORD_ATOMIC_INCREMENT(&model->misses[order]);
+  }
+}
+
 SordIter*
 sord_find(SordModel* model, const SordQuad pat)
 {
@@ -867,6 +2386,10 @@ sord_find(SordModel* model, const SordQuad pat)
     return sord_begin(model);
   }
 
+  if (model->mapping) {
+    return sord_mapped_find(model, pat);
+  }
+
   SearchMode      mode        = ALL;
   int             n_prefix    = 0;
   const SordOrder index_order = sord_best_index(model, pat, &mode, &n_prefix);
@@ -879,10 +2402,15 @@ sord_find(SordModel* model, const SordQuad pat)
 
   if (pat[0] && pat[1] && pat[2] && pat[3]) {
     mode = SINGLE; // No duplicate quads (Sord is a set)
+  } else if (model->index_threshold &&
+             (mode == FILTER_RANGE || mode == FILTER_ALL)) {
+    sord_count_miss(model, pat);
   }
 
+  sord_count_search(model, mode, index_order);
+
   const int* const ordering = orderings[index_order];
-  ZixBTree* const  db       = model->indices[index_order];
+  ZixBTree* const  db       = model->store->indices[index_order];
   ZixBTreeIter     cur      = zix_btree_end(db);
 
   if (mode == FILTER_ALL) {
@@ -896,10 +2424,10 @@ sord_find(SordModel* model, const SordQuad pat)
       prefix_pat[ordering[i]] = pat[ordering[i]];
     }
 
-    zix_btree_lower_bound(db, sord_quad_compare, ordering, prefix_pat, &cur);
+    zix_btree_lower_bound(db, model->compare, ordering, prefix_pat, &cur);
   } else {
     // Ideal case, pattern matches an index with no filtering required
-    zix_btree_lower_bound(db, sord_quad_compare, ordering, pat, &cur);
+    zix_btree_lower_bound(db, model->compare, ordering, pat, &cur);
   }
 
   if (zix_btree_iter_is_end(cur)) {
@@ -964,6 +2492,56 @@ sord_ask(SordModel*      model,
   return sord_contains(model, pat);
 }
 
+/**
+   Count the quads in a range of a compacted index in logarithmic time.
+
+   This counts the same quads that iterating over the range would, so in a
+   triple index, quads that differ only by graph are counted once.
+*/
+static uint64_t
+sord_count_range(const SordModel* model,
+                 const SordOrder  order,
+                 const SordQuad   pat)
+{
+  SordQuad* const  block    = model->store->blocks[order];
+  const int* const ordering = orderings[order];
+
+  // Find the first record that is not less than the pattern
+  size_t lo = 0U;
+  size_t hi = model->store->block_sizes[order];
+  while (lo < hi) {
+    const size_t mid = lo + ((hi - lo) / 2U);
+    if (model->compare(block[mid], pat, ordering) < 0) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+
+  // Find the first record that is greater than the pattern
+  const size_t begin = lo;
+  hi                 = model->store->block_sizes[order];
+  while (lo < hi) {
+    const size_t mid = lo + ((hi - lo) / 2U);
+    if (model->compare(block[mid], pat, ordering) <= 0) {
+      lo = mid + 1U;
+    } else {
+      hi = mid;
+    }
+  }
+
+  const size_t end = lo;
+  if (begin == end) {
+    return 0U;
+  } else if (order >= GSPO) {
+    return end - begin;
+  }
+
+  // Every distinct triple starting after begin, plus the one at begin
+  const size_t* const ranks = model->store->ranks[order];
+  return ranks[end] - ranks[begin + 1U] + 1U;
+}
+
 uint64_t
 sord_count(SordModel*      model,
            const SordNode* s,
@@ -971,6 +2549,24 @@ sord_count(SordModel*      model,
            const SordNode* o,
            const SordNode* g)
 {
+  const SordQuad pat = {s, p, o, g};
+  if (model->mapping) {
+    return sord_mapped_count(model, pat, false);
+  }
+
+  if (model->store->ranked && !s && !p && !o && !g) {
+    return sord_count_range(model, DEFAULT_ORDER, pat);
+  }
+
+  if (model->store->ranked) {
+    SearchMode      mode     = ALL;
+    int             n_prefix = 0;
+    const SordOrder order    = sord_best_index(model, pat, &mode, &n_prefix);
+    if (mode == RANGE || mode == SINGLE) {
+      return sord_count_range(model, order, pat);
+    }
+  }
+
   SordIter* i = sord_search(model, s, p, o, g);
   uint64_t  n = 0;
   for (; !sord_iter_end(i); sord_iter_next(i)) {
@@ -980,15 +2576,594 @@ sord_count(SordModel*      model,
   return n;
 }
 
-bool
-sord_contains(SordModel* model, const SordQuad pat)
+uint64_t
+sord_estimate_count(SordModel*      model,
+                    const SordNode* s,
+                    const SordNode* p,
+                    const SordNode* o,
+                    const SordNode* g)
 {
-  SordIter* iter = sord_find(model, pat);
-  bool      ret  = (iter != NULL);
+  const SordQuad pat = {s, p, o, g};
+  if (!s && !p && !o && !g) {
+    return model->store->n_quads;
+  }
+
+  if (model->mapping) {
+    return sord_mapped_count(model, pat, true);
+  }
+
+  SearchMode      mode     = ALL;
+  int             n_prefix = 0;
+  const SordOrder order    = sord_best_index(model, pat, &mode, &n_prefix);
+  if (model->store->ranked && (mode == RANGE || mode == SINGLE)) {
+    return sord_count_range(model, order, pat);
+  }
+
+  // Use the smallest node reference count as an upper bound
+  uint64_t estimate = model->store->n_quads;
+  for (int i = 0; i < TUP_LEN; ++i) {
+    const size_t refs = pat[i] ? SORD_ATOMIC_LOAD(&pat[i]->refs) : 0U;
+    if (pat[i] && refs < estimate) {
+      estimate = refs;
+    }
+  }
+
+  if (model->store->ranked && mode == FILTER_RANGE) {
+    // Count the range that a search would filter, which is also a bound
+    SordQuad prefix_pat = {NULL, NULL, NULL, NULL};
+    for (int i = 0; i < n_prefix; ++i) {
+      prefix_pat[orderings[order][i]] = pat[orderings[order][i]];
+    }
+
+    const uint64_t n_range = sord_count_range(model, order, prefix_pat);
+    estimate               = (n_range < estimate) ? n_range : estimate;
+  }
+
+  return estimate;
+}
+
+bool
+sord_contains(SordModel* model, const SordQuad pat)
+{
+  SordIter* iter = sord_find(model, pat);
+  bool      ret  = (iter != NULL);
   sord_iter_free(iter);
   return ret;
 }
 
+SordIter*
+sord_find_values(SordModel*      model,
+                 const SordNode* predicate,
+                 double          min,
+                 double          max)
+{
+  ZixBTree* const values = model->mapping ? NULL : model->store->values;
+  if (!values || !predicate || !(min <= max)) {
+    return NULL;
+  }
+
+  const SordValueRecord key = {{NULL, predicate, NULL, NULL}, min};
+  ZixBTreeIter          cur = zix_btree_end_iter;
+  zix_btree_lower_bound(values, sord_value_compare_from, NULL, &key, &cur);
+  if (zix_btree_iter_is_end(cur)) {
+    return NULL;
+  }
+
+  const SordValueRecord* const first = (SordValueRecord*)zix_btree_get(cur);
+  if (first->quad[SORD_PREDICATE] != predicate || first->value > max) {
+    return NULL;
+  }
+
+  SordIter* const iter = sord_iter_new(model, cur, key.quad, POS, VALUES, 1);
+  iter->max_value      = max;
+  return iter;
+}
+
+/*
+  Basic graph pattern queries.
+
+  A query is evaluated one pattern at a time into a table of solutions, which
+  starts as a single empty row.  At each step, the planner picks the pattern
+  with the smallest estimated result, found by binding the variables of a
+  sample of rows and asking the indices.  It then joins that pattern either
+  by searching once for every row, or by sorting the rows and merging them
+  with an index range ordered by the join variable.
+*/
+
+/// Maximum number of rows used to estimate the result of joining a pattern
+#define SORD_QUERY_SAMPLES 16U
+
+/// Variable number for each position of a pattern, or negative for none
+typedef int SordQueryVars[TUP_LEN];
+
+/// Table of solutions with a node (or null) for every variable
+typedef struct {
+  const SordNode** rows;   ///< Rows of nodes, one after another
+  size_t           n_rows; ///< Number of rows
+  size_t           size;   ///< Number of allocated rows
+} SordQueryTable;
+
+/// Row of a table with the join key, for sorting
+typedef struct {
+  const SordNode* key; ///< Value of the join variable
+  size_t          row; ///< Index of row in table
+} SordQueryEntry;
+
+struct SordQueryImpl {
+  SordModel*     model;      ///< Model to query
+  SordQuad*      patterns;   ///< Fixed nodes of each pattern
+  SordQueryVars* vars;       ///< Variables of each pattern
+  size_t         n_patterns; ///< Number of patterns
+  size_t         width;      ///< Number of nodes in a row (at least 1)
+  size_t         n_vars;     ///< Number of variables
+  SordQueryTable results;    ///< Solutions from the last execution
+};
+
+SordQuery*
+sord_query_new(SordModel* model)
+{
+  SordQuery* const query = (SordQuery*)calloc(1U, sizeof(SordQuery));
+  query->model           = model;
+  query->width           = 1U;
+  return query;
+}
+
+void
+sord_query_free(SordQuery* query)
+{
+  if (query) {
+    free(query->results.rows);
+    free(query->vars);
+    free(query->patterns);
+    free(query);
+  }
+}
+
+bool
+sord_query_add(SordQuery* query, const SordQuad pat, const int* vars)
+{
+  for (int i = 0; vars && i < TUP_LEN; ++i) {
+    if (vars[i] >= 0 && pat[i]) {
+      error(query->model->world,
+            SERD_ERR_BAD_ARG,
+            "query pattern has both a node and a variable\n");
+      return false;
+    }
+  }
+
+  const size_t n = query->n_patterns + 1U;
+
+  query->patterns = (SordQuad*)realloc(query->patterns, n * sizeof(SordQuad));
+  query->vars =
+    (SordQueryVars*)realloc(query->vars, n * sizeof(SordQueryVars));
+
+  for (int i = 0; i < TUP_LEN; ++i) {
+    const int var              = vars ? vars[i] : -1;
+    query->patterns[n - 1U][i] = pat[i];
+    query->vars[n - 1U][i]     = (var >= 0) ? var : -1;
+    if (var >= 0 && (size_t)var >= query->n_vars) {
+      query->n_vars = (size_t)var + 1U;
+      query->width  = query->n_vars;
+    }
+  }
+
+  query->n_patterns = n;
+  return true;
+}
+
+static const SordNode**
+sord_query_row(const SordQueryTable* const table,
+               const size_t                width,
+               const size_t                r)
+{
+  return table->rows + (r * width);
+}
+
+/// Append an uninitialised row to a table and return it
+static const SordNode**
+sord_query_append(SordQueryTable* const table, const size_t width)
+{
+  if (table->n_rows == table->size) {
+    table->size = table->size ? (table->size * 2U) : 16U;
+    table->rows = (const SordNode**)realloc(
+      table->rows, table->size * width * sizeof(const SordNode*));
+  }
+
+  return sord_query_row(table, width, table->n_rows++);
+}
+
+/**
+   Set `pat` to pattern `p` with the variables bound in `row`.
+
+   @return True iff the pattern has a graph variable, so a search for it must
+   not skip graphs.
+*/
+static bool
+sord_query_bind(const SordQuery* const       query,
+                const size_t                 p,
+                const SordNode* const* const row,
+                const bool* const            bound,
+                SordQuad                     pat)
+{
+  const SordModel* const model = query->model;
+  const int* const       vars  = query->vars[p];
+  for (int i = 0; i < TUP_LEN; ++i) {
+    pat[i] = (vars[i] >= 0 && bound[vars[i]]) ? row[vars[i]]
+                                              : query->patterns[p][i];
+  }
+
+  if (pat[TUP_G] && !model->mapping &&
+      !model->store->indices[DEFAULT_GRAPH_ORDER]) {
+    pat[TUP_G] = NULL; // No graph indices, so filter instead
+  }
+
+  return vars[TUP_G] >= 0;
+}
+
+/// Return true iff `quad` matches pattern `p` with the bindings in `row`
+static bool
+sord_query_match(const SordQuery* const       query,
+                 const size_t                 p,
+                 const SordNode* const* const row,
+                 const bool* const            bound,
+                 const SordQuad               quad)
+{
+  const SordNode* const* const pat  = query->patterns[p];
+  const int* const             vars = query->vars[p];
+  for (int i = 0; i < TUP_LEN; ++i) {
+    const int v = vars[i];
+    if ((pat[i] && quad[i] != pat[i]) ||
+        (v >= 0 && bound[v] && quad[i] != row[v])) {
+      return false;
+    }
+
+    for (int j = 0; v >= 0 && j < i; ++j) {
+      if (vars[j] == v && quad[j] != quad[i]) {
+        return false; // Variable used twice in this pattern
+      }
+    }
+  }
+
+  return true;
+}
+
+/// Append `row` extended with the variables of pattern `p` in `quad`
+static void
+sord_query_extend(const SordQuery* const       query,
+                  const size_t                 p,
+                  const SordNode* const* const row,
+                  const SordQuad               quad,
+                  SordQueryTable* const        out)
+{
+  const SordNode** const result = sord_query_append(out, query->width);
+  memcpy(result, row, query->width * sizeof(const SordNode*));
+  for (int i = 0; i < TUP_LEN; ++i) {
+    if (query->vars[p][i] >= 0) {
+      result[query->vars[p][i]] = quad[i];
+    }
+  }
+}
+
+/// Estimate the number of results of joining pattern `p` with `table`
+static uint64_t
+sord_query_estimate(SordQuery* const            query,
+                    const size_t                p,
+                    const SordQueryTable* const table,
+                    const bool* const           bound)
+{
+  const size_t n_rows = table->n_rows;
+  const size_t n_samples =
+    (n_rows < SORD_QUERY_SAMPLES) ? n_rows : SORD_QUERY_SAMPLES;
+
+  uint64_t total = 0U;
+  for (size_t s = 0U; s < n_samples; ++s) {
+    const SordNode* const* const row =
+      sord_query_row(table, query->width, s * n_rows / n_samples);
+
+    SordQuad pat = {NULL, NULL, NULL, NULL};
+    sord_query_bind(query, p, row, bound, pat);
+    total += sord_estimate_count(query->model, pat[0], pat[1], pat[2], pat[3]);
+  }
+
+  return n_samples ? (total * n_rows / n_samples) : 0U;
+}
+
+/// Return roughly the number of comparisons in a search of `n` elements
+static uint64_t
+sord_query_log2(uint64_t n)
+{
+  uint64_t log = 1U;
+  while (n >>= 1U) {
+    ++log;
+  }
+
+  return log;
+}
+
+/**
+   Find a position of pattern `p` with a bound variable to merge on.
+
+   This requires an index which starts with the fixed nodes of the pattern,
+   then that position, so the range of matches is ordered by it.
+
+   @return The index order, or -1 if there is none.
+*/
+static int
+sord_query_merge_order(const SordQuery* const query,
+                       const size_t           p,
+                       const bool* const      bound,
+                       int* const             pos)
+{
+  const SordModel* const       model = query->model;
+  const SordNode* const* const pat   = query->patterns[p];
+  const int* const             vars  = query->vars[p];
+  if (model->mapping) {
+    return -1;
+  }
+
+  int n_fixed = 0;
+  for (int i = 0; i < TUP_LEN; ++i) {
+    n_fixed += pat[i] ? 1 : 0;
+  }
+
+  if (n_fixed == TUP_LEN) {
+    return -1; // No position is left to merge on
+  }
+
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    const int* const ordering = orderings[o];
+    if (!model->store->indices[o] || (o >= GSPO) != (pat[TUP_G] != NULL)) {
+      continue;
+    }
+
+    int n_prefix = 0;
+    while (n_prefix < n_fixed && pat[ordering[n_prefix]]) {
+      ++n_prefix;
+    }
+
+    const int next = ordering[n_fixed];
+    if (n_prefix == n_fixed && next != TUP_G && vars[next] >= 0 &&
+        bound[vars[next]]) {
+      *pos = next;
+      return (int)o;
+    }
+  }
+
+  return -1;
+}
+
+/// Join pattern `p` with `in` by searching for the bindings of each row
+static void
+sord_query_search_join(SordQuery* const            query,
+                       const size_t                p,
+                       const SordQueryTable* const in,
+                       const bool* const           bound,
+                       SordQueryTable* const       out)
+{
+  for (size_t r = 0U; r < in->n_rows; ++r) {
+    const SordNode* const* const row = sord_query_row(in, query->width, r);
+
+    SordQuad   pat        = {NULL, NULL, NULL, NULL};
+    const bool all_graphs = sord_query_bind(query, p, row, bound, pat);
+    SordIter*  iter       = sord_find(query->model, pat);
+    if (iter && all_graphs) {
+      iter->skip_graphs = false;
+    }
+
+    for (; !sord_iter_end(iter); sord_iter_next(iter)) {
+      SordQuad quad = {NULL, NULL, NULL, NULL};
+      sord_iter_get(iter, quad);
+      if (sord_query_match(query, p, row, bound, quad)) {
+        sord_query_extend(query, p, row, quad, out);
+      }
+    }
+
+    sord_iter_free(iter);
+  }
+}
+
+static int
+sord_query_entry_compare(const void* const a, const void* const b)
+{
+  return sord_node_compare(((const SordQueryEntry*)a)->key,
+                           ((const SordQueryEntry*)b)->key);
+}
+
+static int
+sord_query_entry_compare_id(const void* const a, const void* const b)
+{
+  return sord_node_compare_id(((const SordQueryEntry*)a)->key,
+                              ((const SordQueryEntry*)b)->key);
+}
+
+/// Return an iterator over the quads that start with a prefix in an index
+static SordIter*
+sord_query_range(SordModel* const model,
+                 const SordQuad   pat,
+                 const SordOrder  order)
+{
+  const int* const ordering = orderings[order];
+  ZixBTree* const  db       = model->store->indices[order];
+  ZixBTreeIter     cur      = zix_btree_end(db);
+
+  int n_prefix = 0;
+  for (int i = 0; i < TUP_LEN; ++i) {
+    n_prefix += pat[i] ? 1 : 0;
+  }
+
+  const SearchMode mode = n_prefix ? RANGE : ALL;
+  sord_count_search(model, mode, order);
+
+  zix_btree_lower_bound(db, model->compare, ordering, pat, &cur);
+  if (zix_btree_iter_is_end(cur) ||
+      !sord_quad_match_inline(pat, (const SordNode**)zix_btree_get(cur))) {
+    return NULL;
+  }
+
+  return sord_iter_new(model, cur, pat, order, mode, n_prefix);
+}
+
+/**
+   Join pattern `p` with `in` by merging the rows sorted by the variable at
+   position `pos` with an index range in the same order.
+*/
+static void
+sord_query_merge_join(SordQuery* const            query,
+                      const size_t                p,
+                      const int                   pos,
+                      const SordOrder             order,
+                      const SordQueryTable* const in,
+                      const bool* const           bound,
+                      SordQueryTable* const       out)
+{
+  SordModel* const model = query->model;
+  const int        var   = query->vars[p][pos];
+  const bool       by_id = model->compare == sord_quad_compare_id;
+
+  // Sort the rows by the value of the join variable, in index order
+  SordQueryEntry* const entries =
+    (SordQueryEntry*)malloc((in->n_rows + 1U) * sizeof(SordQueryEntry));
+  size_t n_entries = 0U;
+  for (size_t r = 0U; r < in->n_rows; ++r) {
+    const SordNode* const key = sord_query_row(in, query->width, r)[var];
+    if (key) {
+      entries[n_entries].key   = key;
+      entries[n_entries++].row = r;
+    }
+  }
+
+  qsort(entries,
+        n_entries,
+        sizeof(SordQueryEntry),
+        by_id ? sord_query_entry_compare_id : sord_query_entry_compare);
+
+  SordIter* const iter = sord_query_range(model, query->patterns[p], order);
+  if (iter && query->vars[p][TUP_G] >= 0) {
+    iter->skip_graphs = false;
+  }
+
+  SordQuad* group      = NULL;
+  size_t    group_size = 0U;
+  size_t    e          = 0U;
+  while (e < n_entries && !sord_iter_end(iter)) {
+    const SordNode* const key = sord_iter_get_node(iter, (SordQuadIndex)pos);
+    const int             cmp = by_id
+                                  ? sord_node_compare_id(entries[e].key, key)
+                                  : sord_node_compare(entries[e].key, key);
+    if (cmp < 0) {
+      ++e;
+    } else if (cmp > 0) {
+      sord_iter_next(iter);
+    } else {
+      // Collect every quad with this value, then join them with every row
+      size_t n_group = 0U;
+      for (; !sord_iter_end(iter) &&
+             sord_iter_get_node(iter, (SordQuadIndex)pos) == key;
+           sord_iter_next(iter)) {
+        if (n_group == group_size) {
+          group_size = group_size ? (group_size * 2U) : 16U;
+          group = (SordQuad*)realloc(group, group_size * sizeof(SordQuad));
+        }
+
+        sord_iter_get(iter, group[n_group++]);
+      }
+
+      for (; e < n_entries && entries[e].key == key; ++e) {
+        const SordNode* const* const row =
+          sord_query_row(in, query->width, entries[e].row);
+
+        for (size_t g = 0U; g < n_group; ++g) {
+          if (sord_query_match(query, p, row, bound, group[g])) {
+            sord_query_extend(query, p, row, group[g], out);
+          }
+        }
+      }
+    }
+  }
+
+  sord_iter_free(iter);
+  free(group);
+  free(entries);
+}
+
+size_t
+sord_query_execute(SordQuery* query)
+{
+  SordModel* const model = query->model;
+  const size_t     width = query->width;
+  const uint64_t   seek  = sord_query_log2(sord_num_quads(model));
+
+  // Start with a single empty solution, which every pattern extends
+  SordQueryTable table = {NULL, 0U, 0U};
+  memset(sord_query_append(&table, width), 0, width * sizeof(SordNode*));
+
+  bool* const done  = (bool*)calloc(query->n_patterns + 1U, sizeof(bool));
+  bool* const bound = (bool*)calloc(width, sizeof(bool));
+  for (size_t step = 0U; step < query->n_patterns && table.n_rows; ++step) {
+    // Choose the pattern with the smallest estimated result
+    size_t   best          = query->n_patterns;
+    uint64_t best_estimate = 0U;
+    for (size_t p = 0U; p < query->n_patterns; ++p) {
+      if (!done[p]) {
+        const uint64_t estimate = sord_query_estimate(query, p, &table, bound);
+        if (best == query->n_patterns || estimate < best_estimate) {
+          best          = p;
+          best_estimate = estimate;
+        }
+      }
+    }
+
+    // Merge if reading the whole range is cheaper than a search for each row
+    const SordNode* const* const pat    = query->patterns[best];
+    const uint64_t               n_rows = table.n_rows;
+    int                          pos    = -1;
+    const int order = sord_query_merge_order(query, best, bound, &pos);
+    const uint64_t merge_cost =
+      sord_estimate_count(model, pat[0], pat[1], pat[2], pat[3]) +
+      (n_rows * sord_query_log2(n_rows));
+
+    SordQueryTable next = {NULL, 0U, 0U};
+    if (order >= 0 && merge_cost < best_estimate + (n_rows * seek)) {
+      SORD_FIND_LOG("Merge pattern %zu on %s\n", best, order_names[order]);
+      sord_query_merge_join(
+        query, best, pos, (SordOrder)order, &table, bound, &next);
+    } else {
+      SORD_FIND_LOG("Search pattern %zu for %zu rows\n", best, table.n_rows);
+      sord_query_search_join(query, best, &table, bound, &next);
+    }
+
+    free(table.rows);
+    table      = next;
+    done[best] = true;
+    for (int i = 0; i < TUP_LEN; ++i) {
+      if (query->vars[best][i] >= 0) {
+        bound[query->vars[best][i]] = true;
+      }
+    }
+  }
+
+  free(bound);
+  free(done);
+
+  free(query->results.rows);
+  query->results = table;
+  return table.n_rows;
+}
+
+size_t
+sord_query_num_vars(const SordQuery* query)
+{
+  return query->n_vars;
+}
+
+const SordNode*
+sord_query_get(const SordQuery* query, size_t row, unsigned var)
+{
+  return (row < query->results.n_rows && var < query->n_vars)
+           ? sord_query_row(&query->results, query->width, row)[var]
+           : NULL;
+}
+
 SordNodeType
 sord_node_get_type(const SordNode* node)
 {
@@ -1047,10 +3222,46 @@ sord_node_get_flags(const SordNode* node)
   return node->node.flags;
 }
 
+double
+sord_node_get_value(const SordNode* node)
+{
+  return (node->node.type == SERD_LITERAL) ? node->meta.lit.value
+                                           : (double)NAN;
+}
+
+size_t
+sord_node_get_hash(const SordNode* node)
+{
+  return node->hash;
+}
+
 bool
 sord_node_is_inline_object(const SordNode* node)
 {
-  return (node->node.type == SERD_BLANK) && (node->meta.res.refs_as_obj == 1);
+  return (node->node.type == SERD_BLANK) &&
+         (SORD_ATOMIC_LOAD(&node->meta.res.refs_as_obj) == 1);
+}
+
+/// Return a key for a node with the given metadata, hashing it if `hash` is 0
+static SordNode
+sord_node_key(const SerdNode* const node,
+              SordNode* const       datatype,
+              const char* const     lang,
+              const size_t          hash)
+{
+  SordNode key = {*node, 1, 0, 0, {{0}}};
+  if (node->type == SERD_LITERAL) {
+    key.meta.lit.datatype = datatype;
+    memset(key.meta.lit.lang, 0, sizeof(key.meta.lit.lang));
+    if (lang) {
+      strncpy(key.meta.lit.lang, lang, sizeof(key.meta.lit.lang) - 1);
+    }
+  } else {
+    key.node.flags = 0U;
+  }
+
+  key.hash = hash ? hash : sord_node_digest(&key);
+  return key;
 }
 
 static SordNode*
@@ -1060,16 +3271,17 @@ sord_insert_node(SordWorld* world, const SordNode* key)
   const ZixHashInsertPlan plan     = zix_hash_plan_insert(world->nodes, key);
   SordNode* const         existing = zix_hash_record_at(world->nodes, plan);
   if (existing) {
-    ++existing->refs;
+    SORD_ATOMIC_INCREMENT(&existing->refs);
     return existing;
   }
 
   // Insert a new node into hash table, transferring ownership
-  SordNode* const node = sord_node_create(key);
-  const ZixStatus st   = zix_hash_insert_at(world->nodes, plan, node);
+  SordNode* const node = sord_node_create(world, key);
+  node->id             = ++world->last_id;
+
+  const ZixStatus st = zix_hash_insert_at(world->nodes, plan, node);
   if (st) {
-    free((uint8_t*)node->node.buf);
-    free(node);
+    free_node_entry(world, node);
     error(
       world, SERD_ERR_INTERNAL, "error inserting node `%s'\n", key->node.buf);
     return NULL;
@@ -1089,7 +3301,8 @@ sord_new_uri_counted(SordWorld*     world,
     return NULL; // Can't intern relative URIs
   }
 
-  const SordNode key = {{str, n_bytes, n_chars, 0, SERD_URI}, 1, {{0}}};
+  const SerdNode node = {str, n_bytes, n_chars, 0, SERD_URI};
+  const SordNode key  = sord_node_key(&node, NULL, NULL, 0U);
 
   return sord_insert_node(world, &key);
 }
@@ -1128,7 +3341,8 @@ sord_new_blank_counted(SordWorld*     world,
                        size_t         n_bytes,
                        size_t         n_chars)
 {
-  const SordNode key = {{str, n_bytes, n_chars, 0, SERD_BLANK}, 1, {{0}}};
+  const SerdNode node = {str, n_bytes, n_chars, 0, SERD_BLANK};
+  const SordNode key  = sord_node_key(&node, NULL, NULL, 0U);
 
   return sord_insert_node(world, &key);
 }
@@ -1149,12 +3363,8 @@ sord_new_literal_counted(SordWorld*     world,
                          SerdNodeFlags  flags,
                          const char*    lang)
 {
-  SordNode key = {{str, n_bytes, n_chars, flags, SERD_LITERAL}, 1, {{0}}};
-  key.meta.lit.datatype = sord_node_copy(datatype);
-  memset(key.meta.lit.lang, 0, sizeof(key.meta.lit.lang));
-  if (lang) {
-    strncpy(key.meta.lit.lang, lang, sizeof(key.meta.lit.lang) - 1);
-  }
+  const SerdNode node = {str, n_bytes, n_chars, flags, SERD_LITERAL};
+  const SordNode key  = sord_node_key(&node, datatype, lang, 0U);
 
   return sord_insert_node(world, &key);
 }
@@ -1243,6 +3453,66 @@ sord_node_from_serd_node(SordWorld*      world,
   return NULL;
 }
 
+size_t
+sord_intern_many(SordWorld* const      world,
+                 SerdEnv* const        env,
+                 const size_t          n_nodes,
+                 const SerdNode* const nodes,
+                 const SerdNode* const datatypes,
+                 const SerdNode* const langs,
+                 size_t* const         hashes,
+                 SordNode** const      out)
+{
+  SordNode* const keys = (SordNode*)calloc(n_nodes, sizeof(SordNode));
+
+  // Hash every node that can be interned directly before looking any up
+  for (size_t i = 0U; i < n_nodes; ++i) {
+    const SerdNode* const node = &nodes[i];
+    const size_t          hash = hashes ? hashes[i] : 0U;
+
+    out[i] = NULL;
+    if (node->type == SERD_LITERAL) {
+      const SerdNode* const datatype = datatypes ? &datatypes[i] : NULL;
+      const SerdNode* const lang     = langs ? &langs[i] : NULL;
+
+      keys[i] = sord_node_key(
+        node,
+        sord_node_from_serd_node(world, env, datatype, NULL, NULL),
+        (lang && lang->type) ? (const char*)lang->buf : NULL,
+        hash);
+    } else if (node->type == SERD_BLANK ||
+               (node->type == SERD_URI &&
+                serd_uri_string_has_scheme(node->buf))) {
+      keys[i] = sord_node_key(node, NULL, NULL, hash);
+    } else {
+      // Expand CURIEs and relative URIs, so the node has no reusable hash
+      out[i] = sord_node_from_serd_node(world, env, node, NULL, NULL);
+    }
+  }
+
+  // Find or insert every hashed node
+  size_t n_created = 0U;
+  for (size_t i = 0U; i < n_nodes; ++i) {
+    const SordNode* const key = &keys[i];
+    if (key->node.type) {
+      out[i] = sord_insert_node(world, key);
+      if (key->node.type == SERD_LITERAL) {
+        sord_node_free(world, key->meta.lit.datatype);
+      }
+    }
+
+    if (out[i]) {
+      ++n_created;
+      if (hashes && !hashes[i]) {
+        hashes[i] = out[i]->hash;
+      }
+    }
+  }
+
+  free(keys);
+  return n_created;
+}
+
 const SerdNode*
 sord_node_to_serd_node(const SordNode* node)
 {
@@ -1254,9 +3524,9 @@ sord_node_free(SordWorld* world, SordNode* node)
 {
   if (!node) {
     return;
-  } else if (node->refs == 0) {
+  } else if (SORD_ATOMIC_LOAD(&node->refs) == 0) {
     error(world, SERD_ERR_BAD_ARG, "attempt to free garbage node\n");
-  } else if (--node->refs == 0) {
+  } else if (SORD_ATOMIC_DECREMENT(&node->refs) == 0) {
     sord_node_free_internal(world, node);
   }
 }
@@ -1266,37 +3536,499 @@ sord_node_copy(const SordNode* node)
 {
   SordNode* copy = (SordNode*)node;
   if (copy) {
-    ++copy->refs;
+    SORD_ATOMIC_INCREMENT(&copy->refs);
   }
   return copy;
 }
 
-static inline bool
-sord_add_to_index(SordModel* model, const SordNode** tup, SordOrder order)
+/** Allocate a new quad record and copy `tup` into it. */
+static const SordNode**
+sord_quad_new(SordModel* const model, const SordQuad tup)
 {
-  return !zix_btree_insert(model->indices[order], tup);
+  const SordNode** quad = NULL;
+  if (!model->world->use_arena) {
+    quad = (const SordNode**)malloc(sizeof(SordQuad));
+  } else if (model->store->free_quads) {
+    quad                     = model->store->free_quads->quad;
+    model->store->free_quads = model->store->free_quads->next;
+  } else {
+    quad = (const SordNode**)sord_arena_alloc(&model->store->quad_arena,
+                                              sizeof(SordFreeQuad));
+  }
+
+  memcpy(quad, tup, sizeof(SordQuad));
+  return quad;
 }
 
-bool
-sord_add(SordModel* model, const SordQuad tup)
+/** Free a quad record that was allocated with sord_quad_new(). */
+static void
+sord_quad_free(SordModel* const model, const SordNode** const quad)
+{
+  if (model->world->use_arena) {
+    SordFreeQuad* const record = (SordFreeQuad*)(void*)quad;
+    record->next             = model->store->free_quads;
+    model->store->free_quads = record;
+  } else {
+    free(quad);
+  }
+}
+
+static inline bool
+sord_add_to_index(SordModel* model, const SordNode** tup, SordOrder order)
+{
+  return !zix_btree_insert(model->store->indices[order], tup);
+}
+
+/** Return the value of a quad object, or NaN if it has none. */
+static inline double
+sord_object_value(const SordNode* const* const quad)
+{
+  const SordNode* const object = quad[SORD_OBJECT];
+
+  return (object->node.type == SERD_LITERAL) ? object->meta.lit.value
+                                              : (double)NAN;
+}
+
+/** Add a quad to the value index, if there is one and its object has a value */
+static void
+sord_add_value(SordStore* const store, const SordNode* const* const quad)
+{
+  const double value = sord_object_value(quad);
+  if (store->values && !isnan(value)) {
+    SordValueRecord* const record =
+      (SordValueRecord*)malloc(sizeof(SordValueRecord));
+
+    memcpy(record->quad, quad, sizeof(SordQuad));
+    record->value = value;
+    if (zix_btree_insert(store->values, record)) {
+      free(record);
+    }
+  }
+}
+
+/** Remove a quad from the value index, if it is there. */
+static void
+sord_remove_value(SordStore* const store, const SordNode* const* const quad)
+{
+  const double value = sord_object_value(quad);
+  if (store->values && !isnan(value)) {
+    SordValueRecord key;
+    memcpy(key.quad, quad, sizeof(SordQuad));
+    key.value = value;
+
+    ZixBTreeIter next   = zix_btree_end_iter;
+    void*        record = NULL;
+    if (!zix_btree_remove(store->values, &key, &record, &next)) {
+      free(record);
+    }
+  }
+}
+
+/** Build the value index from the default index. */
+static void
+sord_build_values(SordStore* const store)
+{
+  store->values =
+    zix_btree_new(NULL, sord_value_compare, orderings[DEFAULT_ORDER]);
+
+  ZixBTreeIter t = zix_btree_begin(store->indices[DEFAULT_ORDER]);
+  for (; !zix_btree_iter_is_end(t); zix_btree_iter_increment(&t)) {
+    sord_add_value(store, (const SordNode**)zix_btree_get(t));
+  }
+}
+
+/**
+   Report a change to the change sink and log, if there are any.
+
+   This is called after a quad is added, or before a removed quad drops its
+   node references, so the nodes are always alive.
+*/
+static void
+sord_notify(SordModel* const             model,
+            const SordChangeType         type,
+            const SordNode* const* const quad)
+{
+  const uint64_t seq = ++model->change_seq;
+  if (!model->change_sink && !model->log_size) {
+    return;
+  }
+
+  const SordChange change = {seq, type, {quad[0], quad[1], quad[2], quad[3]}};
+  if (model->change_sink) {
+    model->change_sink(model->change_handle, &change);
+  }
+
+  if (model->log_size) {
+    // Replace the oldest change if the log is full, then take references
+    SordChange* const entry = &model->changes[(seq - 1U) % model->log_size];
+    if (model->n_logged == model->log_size) {
+      for (int i = 0; i < TUP_LEN; ++i) {
+        sord_node_free(model->world, (SordNode*)entry->quad[i]);
+      }
+    } else {
+      ++model->n_logged;
+    }
+
+    *entry = change;
+    for (int i = 0; i < TUP_LEN; ++i) {
+      sord_node_copy(entry->quad[i]);
+    }
+  }
+}
+
+static inline bool
+sord_quad_equals(const SordNode* const* x, const SordNode* const* y)
+{
+  return x[0] == y[0] && x[1] == y[1] && x[2] == y[2] && x[3] == y[3];
+}
+
+static bool
+sord_bulk_add(SordModel* model, const SordQuad tup)
+{
+  if (model->n_bulk &&
+      sord_quad_equals(model->bulk[model->n_bulk - 1U], tup)) {
+    return false; // Cheaply catch an immediate duplicate
+  }
+
+  if (model->n_bulk == model->bulk_size) {
+    model->bulk_size = model->bulk_size ? (model->bulk_size * 2U) : 256U;
+    model->bulk =
+      (SordQuad*)realloc(model->bulk, model->bulk_size * sizeof(SordQuad));
+  }
+
+  memcpy(model->bulk[model->n_bulk++], tup, sizeof(SordQuad));
+  for (int i = 0; i < TUP_LEN; ++i) {
+    sord_add_quad_ref(model, tup[i], (SordQuadIndex)i);
+  }
+
+  return true;
+}
+
+/**
+   Sort quads (by pointer) in the order of an index.
+
+   This is a simple merge sort, and `tmp` must have room for `n` quads.
+   Already sorted runs are detected in constant time, since input data is
+   often already sorted by subject.
+*/
+static void
+sord_sort_quads(const SordNode***    quads,
+                const SordNode***    tmp,
+                const size_t         n,
+                const ZixCompareFunc compare,
+                const int*           ordering)
+{
+  if (n < 2U) {
+    return;
+  }
+
+  const size_t mid = n / 2U;
+  sord_sort_quads(quads, tmp, mid, compare, ordering);
+  sord_sort_quads(quads + mid, tmp, n - mid, compare, ordering);
+  if (compare(quads[mid - 1U], quads[mid], ordering) <= 0) {
+    return; // Halves are already in order
+  }
+
+  size_t i = 0U;
+  size_t j = mid;
+  size_t k = 0U;
+  while (i < mid && j < n) {
+    if (compare(quads[j], quads[i], ordering) < 0) {
+      tmp[k++] = quads[j++];
+    } else {
+      tmp[k++] = quads[i++];
+    }
+  }
+
+  memcpy(tmp + k, quads + i, (mid - i) * sizeof(*quads));
+  memcpy(quads, tmp, (k + mid - i) * sizeof(*quads));
+}
+
+/**
+   Insert quads that are already in the default index into every other index.
+
+   The quads are sorted for each index in turn, so they are inserted in order.
+   Indices in the `skip` bit mask of orders are left untouched.
+*/
+static void
+sord_add_to_other_indices(SordModel* const        model,
+                          const SordNode*** const quads,
+                          const SordNode*** const tmp,
+                          const size_t            n_quads,
+                          const unsigned          skip)
+{
+  // Move quads with a graph to the front, since only they are in graph indices
+  size_t n_graph = 0U;
+  for (size_t i = 0U; i < n_quads; ++i) {
+    if (quads[i][TUP_G]) {
+      const SordNode** const quad = quads[i];
+      quads[i]                    = quads[n_graph];
+      quads[n_graph++]            = quad;
+    }
+  }
+
+  // Sort for each remaining index and insert in order
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    if (o != DEFAULT_ORDER && model->store->indices[o] &&
+        !(skip & (1U << o))) {
+      const size_t n_index = (o < GSPO) ? n_quads : n_graph;
+      sord_sort_quads(quads, tmp, n_index, model->compare, orderings[o]);
+      for (size_t i = 0U; i < n_index; ++i) {
+        sord_add_to_index(model, quads[i], (SordOrder)o);
+      }
+    }
+  }
+}
+
+/**
+   Store quads which aren't already in the model, and return how many were.
+
+   The quads are sorted in the order of each index in turn, so this is much
+   faster than adding every quad separately.  On return, `quads` starts with
+   the new records.  If `add_refs` is true, node references are taken for
+   each stored quad, otherwise the references of each given quad are
+   transferred to it (or dropped, if it wasn't stored).
+*/
+static size_t
+sord_insert_quads(SordModel* const        model,
+                  const SordNode*** const quads,
+                  const SordNode*** const tmp,
+                  const size_t            n_quads,
+                  const bool              add_refs)
+{
+  // Sort in the default order, which puts any duplicates next to each other
+  sord_sort_quads(
+    quads, tmp, n_quads, model->compare, orderings[DEFAULT_ORDER]);
+
+  // Store each distinct quad that isn't already in the default index
+  size_t n_added = 0U;
+  for (size_t i = 0U; i < n_quads; ++i) {
+    const SordNode** const pending = quads[i];
+    const SordNode**       quad    = NULL;
+    if (!i || !sord_quad_equals(pending, quads[i - 1U])) {
+      quad = sord_quad_new(model, pending);
+      if (!sord_add_to_index(model, quad, DEFAULT_ORDER)) {
+        sord_quad_free(model, quad); // Quad already stored
+        quad = NULL;
+      }
+    }
+
+    if (quad) {
+      quads[n_added++] = quad;
+    }
+
+    if (quad && add_refs) {
+      for (int t = 0; t < TUP_LEN; ++t) {
+        sord_add_quad_ref(model, quad[t], (SordQuadIndex)t);
+      }
+    } else if (!quad && !add_refs) {
+      for (int t = 0; t < TUP_LEN; ++t) {
+        sord_drop_quad_ref(model, pending[t], (SordQuadIndex)t);
+      }
+    }
+  }
+
+  sord_add_to_other_indices(model, quads, tmp, n_added, 0U);
+  for (size_t i = 0U; i < n_added; ++i) {
+    sord_add_value(model->store, quads[i]);
+    sord_notify(model, SORD_ADDED, quads[i]);
+  }
+
+  model->store->n_quads += n_added;
+  model->store->ranked = model->store->ranked && !n_added;
+  return n_added;
+}
+
+/**
+   Give a model its own copy of its store, if it is shared with a snapshot.
+
+   This copies every quad into a new record and indexes them in order, so it
+   takes about as long as a bulk load of the whole model.
+*/
+static void
+sord_detach(SordModel* const model)
+{
+  SordStore* const old = model->store;
+  if (SORD_ATOMIC_LOAD(&old->refs) == 1U) {
+    return;
+  }
+
+  SORD_WRITE_LOG("Copy %zu quads shared with snapshots\n", old->n_quads);
+
+  SordStore* const store = sord_store_new();
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    if (old->indices[o]) {
+      store->indices[o] = zix_btree_new(NULL, model->compare, orderings[o]);
+    }
+  }
+
+  model->store = store;
+
+  // Copy every quad into a new record in the default index
+  ZixBTree* const         old_spo = old->indices[DEFAULT_ORDER];
+  const size_t            n_quads = zix_btree_size(old_spo);
+  const SordNode*** const quads =
+    (const SordNode***)malloc(n_quads * sizeof(const SordNode**));
+  const SordNode*** const tmp =
+    (const SordNode***)malloc(n_quads * sizeof(const SordNode**));
+
+  size_t       k = 0U;
+  ZixBTreeIter t = zix_btree_begin(old_spo);
+  for (; !zix_btree_iter_is_end(t); zix_btree_iter_increment(&t)) {
+    const SordNode** const quad =
+      sord_quad_new(model, (const SordNode**)zix_btree_get(t));
+
+    for (int i = 0; i < TUP_LEN; ++i) {
+      sord_add_quad_ref(model, quad[i], (SordQuadIndex)i);
+    }
+
+    sord_add_to_index(model, quad, DEFAULT_ORDER);
+    quads[k++] = quad;
+  }
+
+  sord_add_to_other_indices(model, quads, tmp, n_quads, 0U);
+  store->n_quads = n_quads;
+  if (old->values) {
+    sord_build_values(store);
+  }
+
+  free(tmp);
+  free(quads);
+  sord_store_release(model, old);
+}
+
+/** Count distinct triples before each record in a triple index block. */
+static size_t*
+sord_block_ranks(SordQuad* const block, const size_t n)
+{
+  size_t* const ranks = (size_t*)malloc((n + 1U) * sizeof(size_t));
+
+  ranks[0] = 0U;
+  for (size_t i = 0U; i < n; ++i) {
+    const bool is_new = !i || block[i][0] != block[i - 1U][0] ||
+                        block[i][1] != block[i - 1U][1] ||
+                        block[i][2] != block[i - 1U][2];
+
+    ranks[i + 1U] = ranks[i] + (is_new ? 1U : 0U);
+  }
+
+  return ranks;
+}
+
+/**
+   Build a missing index from the default index.
+
+   The records are sorted into a new block in the order of the index, as
+   sord_compact() would do, so the index is built in order and without
+   allocating a record for every quad.
+*/
+static void
+sord_build_index(SordModel* const model, const SordOrder order)
+{
+  SordStore* const store   = model->store;
+  ZixBTree* const  spo     = store->indices[DEFAULT_ORDER];
+  const size_t     n_quads = zix_btree_size(spo);
+
+  SORD_WRITE_LOG("Build index %u of %zu quads\n", (unsigned)order, n_quads);
+
+  const SordNode*** const quads =
+    (const SordNode***)malloc((n_quads + 1U) * sizeof(const SordNode**));
+  const SordNode*** const tmp =
+    (const SordNode***)malloc((n_quads + 1U) * sizeof(const SordNode**));
+
+  // Collect the quads that belong in the index, and sort them in its order
+  size_t       n = 0U;
+  ZixBTreeIter t = zix_btree_begin(spo);
+  for (; !zix_btree_iter_is_end(t); zix_btree_iter_increment(&t)) {
+    const SordNode** const quad = (const SordNode**)zix_btree_get(t);
+    if (order < GSPO || quad[TUP_G]) {
+      quads[n++] = quad;
+    }
+  }
+
+  sord_sort_quads(quads, tmp, n, model->compare, orderings[order]);
+
+  // Copy them into a block and insert each record in order
+  SordQuad* const block = (SordQuad*)malloc((n + 1U) * sizeof(SordQuad));
+  ZixBTree* const index = zix_btree_new(NULL, model->compare, orderings[order]);
+  for (size_t i = 0U; i < n; ++i) {
+    memcpy(block[i], quads[i], sizeof(SordQuad));
+    zix_btree_insert(index, block[i]);
+  }
+
+  store->indices[order]     = index;
+  store->blocks[order]      = block;
+  store->block_sizes[order] = n;
+  if (order < GSPO && store->ranked) {
+    store->ranks[order] = sord_block_ranks(block, n);
+  }
+
+  free(tmp);
+  free(quads);
+}
+
+/** Build a missing triple index, and its graph index if the model has one. */
+static void
+sord_build_indices(SordModel* const model, const SordOrder order)
+{
+  SordStore* const store = model->store;
+  if (!store->indices[order]) {
+    sord_build_index(model, order);
+  }
+
+  const SordOrder graph_order = (SordOrder)(order + GSPO);
+  if (store->indices[DEFAULT_GRAPH_ORDER] && !store->indices[graph_order]) {
+    sord_build_index(model, graph_order);
+  }
+
+  model->misses[order] = 0U;
+}
+
+/** Prepare to modify a model, or report an error if it is read-only. */
+static bool
+sord_prepare_write(SordModel* const model)
+{
+  if (model->read_only) {
+    error(model->world, SERD_ERR_BAD_ARG, "attempt to modify snapshot\n");
+    return false;
+  }
+
+  sord_sweep_released(model->world);
+  sord_detach(model);
+
+  // Build any indices that enough searches have needed since the last write
+  for (unsigned o = 0U; model->index_threshold && o < (NUM_ORDERS / 2); ++o) {
+    if (SORD_ATOMIC_LOAD(&model->misses[o]) >= model->index_threshold) {
+      sord_build_indices(model, (SordOrder)o);
+    }
+  }
+
+  return true;
+}
+
+bool
+sord_add(SordModel* model, const SordQuad tup)
 {
   SORD_WRITE_LOG("Add " TUP_FMT "\n", TUP_FMT_ARGS(tup));
   if (!tup[0] || !tup[1] || !tup[2]) {
     error(
       model->world, SERD_ERR_BAD_ARG, "attempt to add quad with NULL field\n");
     return false;
+  } else if (!sord_prepare_write(model)) {
+    return false;
+  } else if (model->in_bulk) {
+    return sord_bulk_add(model, tup);
   } else if (model->n_iters > 0) {
     error(model->world, SERD_ERR_BAD_ARG, "added tuple during iteration\n");
   }
 
-  const SordNode** quad = (const SordNode**)malloc(sizeof(SordQuad));
-  memcpy(quad, tup, sizeof(SordQuad));
+  const SordNode** quad = sord_quad_new(model, tup);
 
   for (unsigned i = 0; i < NUM_ORDERS; ++i) {
-    if (model->indices[i] && (i < GSPO || tup[3])) {
+    if (model->store->indices[i] && (i < GSPO || tup[3])) {
       if (!sord_add_to_index(model, quad, (SordOrder)i)) {
         assert(i == 0); // Assuming index coherency
-        free(quad);
+        sord_quad_free(model, quad);
         return false; // Quad already stored, do nothing
       }
     }
@@ -1306,72 +4038,1384 @@ sord_add(SordModel* model, const SordQuad tup)
     sord_add_quad_ref(model, tup[i], (SordQuadIndex)i);
   }
 
-  ++model->n_quads;
+  sord_add_value(model->store, quad);
+  ++model->store->n_quads;
+  model->store->ranked = false;
+  sord_notify(model, SORD_ADDED, quad);
   return true;
 }
 
 void
-sord_remove(SordModel* model, const SordQuad tup)
+sord_bulk_begin(SordModel* model)
 {
-  SORD_WRITE_LOG("Remove " TUP_FMT "\n", TUP_FMT_ARGS(tup));
-  if (model->n_iters > 0) {
-    error(model->world, SERD_ERR_BAD_ARG, "remove with iterator\n");
+  if (sord_prepare_write(model)) {
+    model->in_bulk = true;
   }
+}
 
-  SordNode* quad = NULL;
-  for (unsigned i = 0; i < NUM_ORDERS; ++i) {
-    if (model->indices[i] && (i < GSPO || tup[3])) {
-      ZixBTreeIter r = zix_btree_end_iter;
-      if (zix_btree_remove(model->indices[i], tup, (void**)&quad, &r)) {
-        assert(i == 0); // Assuming index coherency
-        return;         // Quad not found, do nothing
-      }
+size_t
+sord_bulk_commit(SordModel* model)
+{
+  const size_t n_pending = model->n_bulk;
+  if (!model->in_bulk || !sord_prepare_write(model)) {
+    return 0U;
+  } else if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "committed during iteration\n");
+  }
+
+  SORD_WRITE_LOG("Commit %zu bulk quads\n", n_pending);
+
+  const SordNode*** const quads =
+    (const SordNode***)malloc(n_pending * sizeof(const SordNode**));
+  const SordNode*** const tmp =
+    (const SordNode***)malloc(n_pending * sizeof(const SordNode**));
+
+  for (size_t i = 0U; i < n_pending; ++i) {
+    quads[i] = model->bulk[i];
+  }
+
+  const size_t n_added = sord_insert_quads(model, quads, tmp, n_pending, false);
+
+  free(tmp);
+  free(quads);
+  free(model->bulk);
+  model->bulk      = NULL;
+  model->n_bulk    = 0U;
+  model->bulk_size = 0U;
+  model->in_bulk   = false;
+  return n_added;
+}
+
+size_t
+sord_add_batch(SordModel* model, SordQuad* quads, size_t n_quads)
+{
+  for (size_t i = 0U; i < n_quads; ++i) {
+    if (!quads[i][0] || !quads[i][1] || !quads[i][2]) {
+      error(model->world,
+            SERD_ERR_BAD_ARG,
+            "attempt to add quad with NULL field\n");
+      return 0U;
+    }
+  }
+
+  if (!n_quads || !sord_prepare_write(model)) {
+    return 0U;
+  } else if (model->in_bulk) {
+    size_t n_pending = 0U;
+    for (size_t i = 0U; i < n_quads; ++i) {
+      n_pending += sord_bulk_add(model, quads[i]) ? 1U : 0U;
     }
+    return n_pending;
+  } else if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "added tuple during iteration\n");
   }
 
-  free(quad);
+  SORD_WRITE_LOG("Add %zu quads\n", n_quads);
 
-  for (int i = 0; i < TUP_LEN; ++i) {
-    sord_drop_quad_ref(model, tup[i], (SordQuadIndex)i);
+  const SordNode*** const batch =
+    (const SordNode***)malloc(n_quads * sizeof(const SordNode**));
+  const SordNode*** const tmp =
+    (const SordNode***)malloc(n_quads * sizeof(const SordNode**));
+
+  for (size_t i = 0U; i < n_quads; ++i) {
+    batch[i] = (const SordNode**)quads[i];
   }
 
-  --model->n_quads;
+  const size_t n_added = sord_insert_quads(model, batch, tmp, n_quads, true);
+
+  free(tmp);
+  free(batch);
+  return n_added;
 }
 
-SerdStatus
-sord_erase(SordModel* model, SordIter* iter)
+void
+sord_compact(SordModel* model)
 {
-  if (model->n_iters > 1) {
-    error(model->world, SERD_ERR_BAD_ARG, "erased with many iterators\n");
-    return SERD_ERR_BAD_ARG;
+  if (!sord_prepare_write(model)) {
+    return;
+  } else if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "compacted during iteration\n");
   }
 
-  SordQuad tup;
-  sord_iter_get(iter, tup);
+  SORD_WRITE_LOG("Compact %zu quads\n", model->store->n_quads);
 
-  SORD_WRITE_LOG("Remove " TUP_FMT "\n", TUP_FMT_ARGS(tup));
+  // Collect the records that are currently shared by every index
+  ZixBTree* const         spo    = model->store->indices[DEFAULT_ORDER];
+  const SordNode*** const shared = (const SordNode***)malloc(
+    zix_btree_size(spo) * sizeof(const SordNode**));
 
-  SordNode* quad = NULL;
-  for (unsigned i = 0; i < NUM_ORDERS; ++i) {
-    if (model->indices[i] && (i < GSPO || tup[3])) {
-      ZixBTreeIter r = zix_btree_end_iter;
-      if (zix_btree_remove(model->indices[i],
-                           tup,
-                           (void**)&quad,
-                           (SordOrder)i == iter->order ? &iter->cur : &r)) {
-        return (i == 0) ? SERD_ERR_NOT_FOUND : SERD_ERR_INTERNAL;
-      }
+  size_t       n_shared = 0U;
+  ZixBTreeIter t        = zix_btree_begin(spo);
+  for (; !zix_btree_iter_is_end(t); zix_btree_iter_increment(&t)) {
+    const SordNode** const quad = (const SordNode**)zix_btree_get(t);
+    if (!sord_in_block(model->store, DEFAULT_ORDER, quad)) {
+      shared[n_shared++] = quad;
     }
   }
-  iter->end = zix_btree_iter_is_end(iter->cur);
-  sord_iter_scan_next(iter);
 
-  free(quad);
+  // Copy the records of every index into a new block in its order
+  SordQuad* old_blocks[NUM_ORDERS];
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    ZixBTree* const index = model->store->indices[o];
 
-  for (int i = 0; i < TUP_LEN; ++i) {
-    sord_drop_quad_ref(model, tup[i], (SordQuadIndex)i);
+    old_blocks[o]                = model->store->blocks[o];
+    model->store->blocks[o]      = NULL;
+    model->store->block_sizes[o] = 0U;
+    if (!index || !zix_btree_size(index)) {
+      continue;
+    }
+
+    const size_t    n     = zix_btree_size(index);
+    SordQuad* const block = (SordQuad*)malloc(n * sizeof(SordQuad));
+    size_t          k     = 0U;
+    for (t = zix_btree_begin(index); !zix_btree_iter_is_end(t);
+         zix_btree_iter_increment(&t)) {
+      memcpy(block[k++], zix_btree_get(t), sizeof(SordQuad));
+    }
+
+    // Rebuild the index in order, pointing to the new records
+    zix_btree_clear(index, NULL, NULL);
+    for (k = 0U; k < n; ++k) {
+      zix_btree_insert(index, block[k]);
+    }
+
+    model->store->blocks[o]      = block;
+    model->store->block_sizes[o] = n;
   }
 
-  --model->n_quads;
-  return SERD_SUCCESS;
+  // Count distinct triples before each record, for counting ranges quickly
+  for (unsigned o = 0U; o < (NUM_ORDERS / 2); ++o) {
+    free(model->store->ranks[o]);
+    model->store->ranks[o] = NULL;
+    if (model->store->blocks[o]) {
+      model->store->ranks[o] = sord_block_ranks(model->store->blocks[o],
+                                                model->store->block_sizes[o]);
+    }
+  }
+
+  // Free the old records, which are no longer referenced by any index
+  for (size_t i = 0U; i < n_shared; ++i) {
+    sord_quad_free(model, shared[i]);
+  }
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    free(old_blocks[o]);
+  }
+  free(shared);
+
+  model->store->ranked = true;
+}
+
+unsigned
+sord_get_indices(const SordModel* model)
+{
+  const SordMapping* const mapping = model->mapping;
+
+  unsigned indices = 0U;
+  for (unsigned o = 0U; o < (NUM_ORDERS / 2); ++o) {
+    const bool present =
+      mapping ? (o == DEFAULT_ORDER || mapping->view.positions[o])
+              : (model->store->indices[o] != NULL);
+    if (present) {
+      indices |= 1U << o;
+    }
+  }
+
+  if (model->compare == sord_quad_compare_id) {
+    indices |= SORD_ID_ORDER;
+  }
+  if (!mapping && model->store->values) {
+    indices |= SORD_VALUES;
+  }
+
+  return indices;
+}
+
+bool
+sord_add_index(SordModel* model, unsigned indices)
+{
+  if (!sord_prepare_write(model)) {
+    return false;
+  } else if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "added index during iteration\n");
+  }
+
+  for (unsigned o = 0U; o < (NUM_ORDERS / 2); ++o) {
+    if (indices & (1U << o)) {
+      sord_build_indices(model, (SordOrder)o);
+    }
+  }
+
+  if ((indices & SORD_VALUES) && !model->store->values) {
+    sord_build_values(model->store);
+  }
+
+  return true;
+}
+
+/** Free an index and its compacted records, if it exists. */
+static void
+sord_free_index(SordStore* const store, const SordOrder order)
+{
+  if (store->indices[order]) {
+    zix_btree_free(store->indices[order], NULL, NULL);
+    free(store->blocks[order]);
+    store->indices[order]     = NULL;
+    store->blocks[order]      = NULL;
+    store->block_sizes[order] = 0U;
+    if (order < GSPO) {
+      free(store->ranks[order]);
+      store->ranks[order] = NULL;
+    }
+  }
+}
+
+bool
+sord_drop_index(SordModel* model, unsigned indices)
+{
+  if (indices & (1U << DEFAULT_ORDER)) {
+    error(model->world, SERD_ERR_BAD_ARG, "attempt to drop default index\n");
+    return false;
+  } else if (!sord_prepare_write(model)) {
+    return false;
+  } else if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "dropped index during iteration\n");
+  }
+
+  // Records that aren't in a block are shared with the default index
+  for (unsigned o = 0U; o < (NUM_ORDERS / 2); ++o) {
+    if (indices & (1U << o)) {
+      sord_free_index(model->store, (SordOrder)o);
+      sord_free_index(model->store, (SordOrder)(o + GSPO));
+    }
+  }
+
+  if ((indices & SORD_VALUES) && model->store->values) {
+    zix_btree_free(model->store->values, sord_value_record_free, NULL);
+    model->store->values = NULL;
+  }
+
+  return true;
+}
+
+void
+sord_set_index_threshold(SordModel* model, size_t threshold)
+{
+  model->index_threshold = threshold;
+  for (unsigned o = 0U; o < (NUM_ORDERS / 2); ++o) {
+    model->misses[o] = 0U;
+  }
+}
+
+/// Return the approximate number of bytes used by an index
+static size_t
+sord_index_bytes(const SordModel* const model, const SordOrder order)
+{
+  const SordMapping* const mapping = model->mapping;
+  if (mapping) {
+    const size_t n_quads = (order < GSPO)
+                             ? (size_t)mapping->view.header->n_quads
+                             : mapping->view.n_graph;
+
+    return mapping->view.positions[order] ? n_quads * sizeof(uint32_t) : 0U;
+  }
+
+  const SordStore* const store = model->store;
+  if (!store->indices[order]) {
+    return 0U;
+  }
+
+  // Assume that B-tree nodes are about three quarters full on average
+  const size_t n_records = zix_btree_size(store->indices[order]);
+  const size_t n_blocked = store->block_sizes[order];
+  size_t       n_bytes   = (n_records * sizeof(void*) * 4U) / 3U;
+
+  n_bytes += n_blocked * sizeof(SordQuad);
+  if (order < GSPO && store->ranks[order]) {
+    n_bytes += n_blocked * sizeof(size_t);
+  }
+
+  return n_bytes;
+}
+
+void
+sord_get_stats(const SordModel* model, SordStats* stats)
+{
+  const SordStats* const counts = &model->stats;
+
+  stats->n_all          = SORD_ATOMIC_LOAD(&counts->n_all);
+  stats->n_single       = SORD_ATOMIC_LOAD(&counts->n_single);
+  stats->n_range        = SORD_ATOMIC_LOAD(&counts->n_range);
+  stats->n_filter_range = SORD_ATOMIC_LOAD(&counts->n_filter_range);
+  stats->n_filter_all   = SORD_ATOMIC_LOAD(&counts->n_filter_all);
+  stats->n_scanned      = SORD_ATOMIC_LOAD(&counts->n_scanned);
+  stats->n_returned     = SORD_ATOMIC_LOAD(&counts->n_returned);
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    stats->n_searches[o]  = SORD_ATOMIC_LOAD(&counts->n_searches[o]);
+    stats->index_bytes[o] = sord_index_bytes(model, (SordOrder)o);
+  }
+
+  // Iterators of the node table are slot indices, so the end is the size
+  stats->n_nodes    = zix_hash_size(model->world->nodes);
+  stats->node_slots = zix_hash_end(model->world->nodes);
+  stats->node_bytes = model->world->node_bytes;
+  stats->n_quads    = sord_num_quads(model);
+}
+
+void
+sord_reset_stats(SordModel* model)
+{
+  memset(&model->stats, 0, sizeof(SordStats));
+}
+
+void
+sord_set_change_sink(SordModel* model, SordChangeSink sink, void* handle)
+{
+  model->change_sink   = sink;
+  model->change_handle = handle;
+}
+
+void
+sord_set_change_log_size(SordModel* model, size_t size)
+{
+  const size_t old_size = model->log_size;
+  const size_t n_kept   = (model->n_logged < size) ? model->n_logged : size;
+
+  // Move the most recent changes to a new log, and drop the rest
+  SordChange* const changes =
+    size ? (SordChange*)calloc(size, sizeof(SordChange)) : NULL;
+  for (size_t i = 0U; i < model->n_logged; ++i) {
+    const uint64_t    seq   = model->change_seq - i;
+    SordChange* const entry = &model->changes[(seq - 1U) % old_size];
+    if (i < n_kept) {
+      changes[(seq - 1U) % size] = *entry;
+    } else {
+      for (int t = 0; t < TUP_LEN; ++t) {
+        sord_node_free(model->world, (SordNode*)entry->quad[t]);
+      }
+    }
+  }
+
+  free(model->changes);
+  model->changes  = changes;
+  model->log_size = size;
+  model->n_logged = n_kept;
+}
+
+uint64_t
+sord_get_change_seq(const SordModel* model)
+{
+  return model->change_seq;
+}
+
+size_t
+sord_get_changes(const SordModel* model,
+                 uint64_t         after,
+                 SordChange*      changes,
+                 size_t           max)
+{
+  const uint64_t first = model->change_seq - model->n_logged + 1U;
+  uint64_t       seq   = (after < first) ? first : (after + 1U);
+
+  size_t n = 0U;
+  for (; n < max && seq <= model->change_seq; ++n, ++seq) {
+    changes[n] = model->changes[(seq - 1U) % model->log_size];
+  }
+
+  return n;
+}
+
+void
+sord_remove(SordModel* model, const SordQuad tup)
+{
+  SORD_WRITE_LOG("Remove " TUP_FMT "\n", TUP_FMT_ARGS(tup));
+  if (!sord_prepare_write(model)) {
+    return;
+  } else if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "remove with iterator\n");
+  }
+
+  SordStore* const store  = model->store;
+  const SordNode** shared = NULL;
+  for (unsigned i = 0; i < NUM_ORDERS; ++i) {
+    if (store->indices[i] && (i < GSPO || tup[3])) {
+      ZixBTreeIter r    = zix_btree_end_iter;
+      void*        quad = NULL;
+      if (zix_btree_remove(store->indices[i], tup, &quad, &r)) {
+        assert(i == 0); // Assuming index coherency
+        return;         // Quad not found, do nothing
+      }
+
+      if (!sord_in_block(store, (SordOrder)i, (const SordNode**)quad)) {
+        shared = (const SordNode**)quad;
+      }
+    }
+  }
+
+  if (shared) {
+    sord_quad_free(model, shared);
+  }
+
+  sord_remove_value(store, tup);
+  --model->store->n_quads;
+  model->store->ranked = false;
+  sord_notify(model, SORD_REMOVED, tup);
+  for (int i = 0; i < TUP_LEN; ++i) {
+    sord_drop_quad_ref(model, tup[i], (SordQuadIndex)i);
+  }
+}
+
+size_t
+sord_remove_batch(SordModel* model, SordQuad* quads, size_t n_quads)
+{
+  if (!n_quads || !sord_prepare_write(model)) {
+    return 0U;
+  } else if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "remove with iterator\n");
+  }
+
+  SORD_WRITE_LOG("Remove %zu quads\n", n_quads);
+
+  SordStore* const        store = model->store;
+  const SordNode*** const batch =
+    (const SordNode***)malloc(n_quads * sizeof(const SordNode**));
+  const SordNode*** const tmp =
+    (const SordNode***)malloc(n_quads * sizeof(const SordNode**));
+  const SordNode*** const shared =
+    (const SordNode***)malloc(n_quads * sizeof(const SordNode**));
+
+  for (size_t i = 0U; i < n_quads; ++i) {
+    batch[i] = (const SordNode**)quads[i];
+  }
+
+  // Remove from the default index in order, keeping only the quads found
+  sord_sort_quads(
+    batch, tmp, n_quads, model->compare, orderings[DEFAULT_ORDER]);
+
+  size_t n_removed = 0U;
+  size_t n_shared  = 0U;
+  for (size_t i = 0U; i < n_quads; ++i) {
+    ZixBTreeIter r    = zix_btree_end_iter;
+    void*        quad = NULL;
+    if (!zix_btree_remove(store->indices[DEFAULT_ORDER], batch[i], &quad, &r)) {
+      if (!sord_in_block(store, DEFAULT_ORDER, (const SordNode**)quad)) {
+        shared[n_shared++] = (const SordNode**)quad;
+      }
+      batch[n_removed++] = batch[i];
+    }
+  }
+
+  // Move quads with a graph to the front, since only they are in graph indices
+  size_t n_graph = 0U;
+  for (size_t i = 0U; i < n_removed; ++i) {
+    if (batch[i][TUP_G]) {
+      const SordNode** const quad = batch[i];
+      batch[i]                    = batch[n_graph];
+      batch[n_graph++]            = quad;
+    }
+  }
+
+  // Remove from every other index in its order
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    if (o != DEFAULT_ORDER && store->indices[o]) {
+      const size_t n_index = (o < GSPO) ? n_removed : n_graph;
+      sord_sort_quads(batch, tmp, n_index, model->compare, orderings[o]);
+      for (size_t i = 0U; i < n_index; ++i) {
+        ZixBTreeIter r    = zix_btree_end_iter;
+        void*        quad = NULL;
+        zix_btree_remove(store->indices[o], batch[i], &quad, &r);
+      }
+    }
+  }
+
+  // Free the records and drop references now that no index refers to them
+  for (size_t i = 0U; i < n_shared; ++i) {
+    sord_quad_free(model, shared[i]);
+  }
+
+  for (size_t i = 0U; i < n_removed; ++i) {
+    sord_remove_value(store, batch[i]);
+    sord_notify(model, SORD_REMOVED, batch[i]);
+    for (int t = 0; t < TUP_LEN; ++t) {
+      sord_drop_quad_ref(model, batch[i][t], (SordQuadIndex)t);
+    }
+  }
+
+  free(shared);
+  free(tmp);
+  free(batch);
+  store->n_quads -= n_removed;
+  store->ranked = store->ranked && !n_removed;
+  return n_removed;
+}
+
+void
+sord_clear(SordModel* model)
+{
+  SORD_WRITE_LOG("Clear %zu quads\n", model->store->n_quads);
+  if (model->read_only) {
+    error(model->world, SERD_ERR_BAD_ARG, "attempt to modify snapshot\n");
+    return;
+  } else if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "clear with iterator\n");
+    return;
+  }
+
+  sord_sweep_released(model->world);
+
+  // Drop references held by uncommitted bulk quads
+  for (size_t b = 0U; b < model->n_bulk; ++b) {
+    for (int t = 0; t < TUP_LEN; ++t) {
+      sord_drop_quad_ref(model, model->bulk[b][t], (SordQuadIndex)t);
+    }
+  }
+  model->n_bulk = 0U;
+
+  // Report every removed quad, if anything is listening
+  SordStore* const old = model->store;
+  if (model->change_sink || model->log_size) {
+    ZixBTreeIter t = zix_btree_begin(old->indices[DEFAULT_ORDER]);
+    for (; !zix_btree_iter_is_end(t); zix_btree_iter_increment(&t)) {
+      sord_notify(model, SORD_REMOVED, (const SordNode**)zix_btree_get(t));
+    }
+  } else {
+    model->change_seq += old->n_quads;
+  }
+
+  // Replace the store with an empty one that has the same indices
+  SordStore* const store = sord_store_new();
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    if (old->indices[o]) {
+      store->indices[o] = zix_btree_new(NULL, model->compare, orderings[o]);
+    }
+  }
+  if (old->values) {
+    store->values =
+      zix_btree_new(NULL, sord_value_compare, orderings[DEFAULT_ORDER]);
+  }
+
+  // Free the old store in bulk, unless it is shared with snapshots
+  model->store = store;
+  sord_store_release(model, old);
+}
+
+SerdStatus
+sord_erase(SordModel* model, SordIter* iter)
+{
+  if (model->n_iters > 1) {
+    error(model->world, SERD_ERR_BAD_ARG, "erased with many iterators\n");
+    return SERD_ERR_BAD_ARG;
+  } else if (iter->mode == VALUES) {
+    error(model->world, SERD_ERR_BAD_ARG, "erased with value iterator\n");
+    return SERD_ERR_BAD_ARG;
+  }
+
+  SordQuad tup;
+  sord_iter_get(iter, tup);
+
+  SORD_WRITE_LOG("Remove " TUP_FMT "\n", TUP_FMT_ARGS(tup));
+
+  // Move the iterator to the model's own copy if it was shared
+  const SordStore* const old_store = model->store;
+  if (!sord_prepare_write(model)) {
+    return SERD_ERR_BAD_ARG;
+  } else if (model->store != old_store) {
+    zix_btree_find(model->store->indices[iter->order], tup, &iter->cur);
+  }
+
+  SordStore* const store  = model->store;
+  const SordNode** shared = NULL;
+  for (unsigned i = 0; i < NUM_ORDERS; ++i) {
+    if (store->indices[i] && (i < GSPO || tup[3])) {
+      ZixBTreeIter r    = zix_btree_end_iter;
+      void*        quad = NULL;
+      if (zix_btree_remove(store->indices[i],
+                           tup,
+                           &quad,
+                           (SordOrder)i == iter->order ? &iter->cur : &r)) {
+        return (i == 0) ? SERD_ERR_NOT_FOUND : SERD_ERR_INTERNAL;
+      }
+
+      if (!sord_in_block(store, (SordOrder)i, (const SordNode**)quad)) {
+        shared = (const SordNode**)quad;
+      }
+    }
+  }
+  iter->end = zix_btree_iter_is_end(iter->cur);
+  sord_iter_scan_next(iter);
+
+  if (shared) {
+    sord_quad_free(model, shared);
+  }
+
+  sord_remove_value(store, tup);
+  --model->store->n_quads;
+  model->store->ranked = false;
+  sord_notify(model, SORD_REMOVED, tup);
+  for (int i = 0; i < TUP_LEN; ++i) {
+    sord_drop_quad_ref(model, tup[i], (SordQuadIndex)i);
+  }
+
+  return SERD_SUCCESS;
+}
+
+static int
+sord_binary_quad_compare(const SordBinaryQuad x,
+                         const SordBinaryQuad y,
+                         const int* const     ordering)
+{
+  for (int i = 0; i < TUP_LEN; ++i) {
+    const int idx = ordering[i];
+    if (x[idx] != y[idx]) {
+      return (x[idx] < y[idx]) ? -1 : 1;
+    }
+  }
+
+  return 0;
+}
+
+/// Sort positions of quads in the order of an index, like sord_sort_quads()
+static void
+sord_sort_positions(uint32_t* const       positions,
+                    uint32_t* const       tmp,
+                    const size_t          n,
+                    SordBinaryQuad* const quads,
+                    const int* const      ordering)
+{
+  if (n < 2U) {
+    return;
+  }
+
+  const size_t mid = n / 2U;
+  sord_sort_positions(positions, tmp, mid, quads, ordering);
+  sord_sort_positions(positions + mid, tmp, n - mid, quads, ordering);
+  if (sord_binary_quad_compare(
+        quads[positions[mid - 1U]], quads[positions[mid]], ordering) <= 0) {
+    return; // Halves are already in order
+  }
+
+  size_t i = 0U;
+  size_t j = mid;
+  size_t k = 0U;
+  while (i < mid && j < n) {
+    if (sord_binary_quad_compare(
+          quads[positions[j]], quads[positions[i]], ordering) < 0) {
+      tmp[k++] = positions[j++];
+    } else {
+      tmp[k++] = positions[i++];
+    }
+  }
+
+  memcpy(tmp + k, positions + i, (mid - i) * sizeof(*positions));
+  memcpy(positions, tmp, (k + mid - i) * sizeof(*positions));
+}
+
+static int
+sord_node_ptr_compare(const void* const a, const void* const b)
+{
+  return sord_node_compare(*(const SordNode* const*)a,
+                           *(const SordNode* const*)b);
+}
+
+/// Add a node and its datatype to `nodes` if they are not marked in `marks`
+static void
+sord_binary_collect(SordNode* const  node,
+                    uint32_t* const  marks,
+                    SordNode** const nodes,
+                    size_t* const    n_nodes)
+{
+  if (node && !marks[node->id]) {
+    marks[node->id]     = 1U;
+    nodes[(*n_nodes)++] = node;
+    if (node->node.type == SERD_LITERAL) {
+      sord_binary_collect(node->meta.lit.datatype, marks, nodes, n_nodes);
+    }
+  }
+}
+
+/// Write zeros after `size` bytes of data up to the next multiple of 8
+static bool
+sord_binary_pad(FILE* const stream, const uint64_t size)
+{
+  static const uint8_t zeros[8] = {0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U};
+
+  const size_t pad = (size_t)((8U - (size % 8U)) % 8U);
+  return !pad || fwrite(zeros, 1U, pad, stream) == pad;
+}
+
+/// Write `size` bytes of data followed by padding
+static bool
+sord_binary_write(FILE* const stream, const void* const data, const size_t size)
+{
+  return (!size || fwrite(data, 1U, size, stream) == size) &&
+         sord_binary_pad(stream, size);
+}
+
+SerdStatus
+sord_save_binary(const SordModel* model, const uint8_t* path, bool orders)
+{
+  SordWorld* const world = model->world;
+  if (model->mapping) {
+    // The model is a snapshot already, so write it as it is
+    const void* const data   = model->mapping->data;
+    const size_t      size   = model->mapping->size;
+    FILE* const       stream = fopen((const char*)path, "wb");
+    bool good = stream && fwrite(data, 1U, size, stream) == size;
+    if (stream && fclose(stream)) {
+      good = false;
+    }
+
+    if (!good) {
+      error(world, SERD_ERR_UNKNOWN, "failed to write `%s'\n", path);
+      return SERD_ERR_UNKNOWN;
+    }
+
+    return SERD_SUCCESS;
+  }
+
+  ZixBTree* const spo     = model->store->indices[DEFAULT_ORDER];
+  const size_t    n_quads = zix_btree_size(spo);
+
+  // Collect every node used by the model, including literal datatypes
+  uint32_t* const ids =
+    (uint32_t*)calloc(world->last_id + 1U, sizeof(uint32_t));
+  SordNode** const nodes =
+    (SordNode**)malloc(((TUP_LEN + 1U) * n_quads + 1U) * sizeof(SordNode*));
+
+  size_t       n_nodes = 0U;
+  ZixBTreeIter t       = zix_btree_begin(spo);
+  for (; !zix_btree_iter_is_end(t); zix_btree_iter_increment(&t)) {
+    SordNode* const* const quad = (SordNode* const*)zix_btree_get(t);
+    for (int i = 0; i < TUP_LEN; ++i) {
+      sord_binary_collect(quad[i], ids, nodes, &n_nodes);
+    }
+  }
+
+  if (n_nodes >= UINT32_MAX || n_quads >= UINT32_MAX) {
+    free(nodes);
+    free(ids);
+    error(world, SERD_ERR_BAD_ARG, "model too large for binary snapshot\n");
+    return SERD_ERR_BAD_ARG;
+  }
+
+  // Number nodes in value order, and lay out the string table
+  qsort(nodes, n_nodes, sizeof(SordNode*), sord_node_ptr_compare);
+
+  SordBinaryNode* const entries =
+    (SordBinaryNode*)calloc(n_nodes + 1U, sizeof(SordBinaryNode));
+  uint64_t strings_size = 0U;
+  for (size_t i = 0U; i < n_nodes; ++i) {
+    const SordNode* const node  = nodes[i];
+    SordBinaryNode* const entry = &entries[i];
+
+    ids[node->id]  = (uint32_t)(i + 1U);
+    entry->offset  = strings_size;
+    entry->n_bytes = node->node.n_bytes;
+    entry->n_chars = node->node.n_chars;
+    entry->type    = (uint16_t)node->node.type;
+    entry->flags   = (uint16_t)node->node.flags;
+
+    strings_size += node->node.n_bytes + 1U;
+  }
+
+  for (size_t i = 0U; i < n_nodes; ++i) {
+    if (nodes[i]->node.type == SERD_LITERAL) {
+      const SordNode* const datatype = nodes[i]->meta.lit.datatype;
+
+      entries[i].datatype = datatype ? ids[datatype->id] : 0U;
+      memcpy(entries[i].lang, nodes[i]->meta.lit.lang, sizeof(entries[i].lang));
+    }
+  }
+
+  // Build the quad table, and positions which sort it by value if necessary
+  SordBinaryQuad* const table =
+    (SordBinaryQuad*)malloc((n_quads + 1U) * sizeof(SordBinaryQuad));
+  SordBinaryQuad* const quads =
+    (SordBinaryQuad*)malloc((n_quads + 1U) * sizeof(SordBinaryQuad));
+  uint32_t* const positions =
+    (uint32_t*)malloc((n_quads + 1U) * sizeof(uint32_t));
+  uint32_t* const tmp = (uint32_t*)malloc((n_quads + 1U) * sizeof(uint32_t));
+
+  size_t k = 0U;
+  for (t = zix_btree_begin(spo); !zix_btree_iter_is_end(t);
+       zix_btree_iter_increment(&t), ++k) {
+    const SordNode* const* const quad =
+      (const SordNode* const*)zix_btree_get(t);
+
+    for (int i = 0; i < TUP_LEN; ++i) {
+      table[k][i] = quad[i] ? ids[quad[i]->id] : 0U;
+    }
+    positions[k] = (uint32_t)k;
+  }
+
+  sord_sort_positions(
+    positions, tmp, n_quads, table, orderings[DEFAULT_ORDER]);
+  for (k = 0U; k < n_quads; ++k) {
+    memcpy(quads[k], table[positions[k]], sizeof(SordBinaryQuad));
+  }
+
+  SordBinaryHeader header = {SORD_BINARY_MAGIC,
+                             SORD_BINARY_VERSION,
+                             SORD_BINARY_BYTE_ORDER,
+                             n_nodes,
+                             strings_size,
+                             n_quads,
+                             0U,
+                             0U};
+
+  for (unsigned o = 0U; orders && o < NUM_ORDERS; ++o) {
+    if (o != DEFAULT_ORDER && model->store->indices[o]) {
+      header.orders |= 1U << o;
+    }
+  }
+
+  // Write everything in order
+  FILE* const stream = fopen((const char*)path, "wb");
+  bool good = stream && sord_binary_write(stream, &header, sizeof(header));
+
+  good = good && sord_binary_write(
+                   stream, entries, n_nodes * sizeof(SordBinaryNode));
+
+  for (size_t i = 0U; good && i < n_nodes; ++i) {
+    const size_t size = nodes[i]->node.n_bytes + 1U;
+    good              = fwrite(nodes[i]->node.buf, 1U, size, stream) == size;
+  }
+
+  good = good && sord_binary_pad(stream, strings_size);
+  good = good && sord_binary_write(
+                   stream, quads, n_quads * sizeof(SordBinaryQuad));
+
+  for (unsigned o = 0U; good && o < NUM_ORDERS; ++o) {
+    if (header.orders & (1U << o)) {
+      size_t n = 0U;
+      for (k = 0U; k < n_quads; ++k) {
+        if (o < GSPO || quads[k][TUP_G]) {
+          positions[n++] = (uint32_t)k;
+        }
+      }
+
+      sord_sort_positions(positions, tmp, n, quads, orderings[o]);
+      good = sord_binary_write(stream, positions, n * sizeof(uint32_t));
+    }
+  }
+
+  if (stream && fclose(stream)) {
+    good = false;
+  }
+
+  free(tmp);
+  free(positions);
+  free(quads);
+  free(table);
+  free(entries);
+  free(nodes);
+  free(ids);
+
+  if (!good) {
+    error(world, SERD_ERR_UNKNOWN, "failed to write `%s'\n", path);
+    return SERD_ERR_UNKNOWN;
+  }
+
+  return SERD_SUCCESS;
+}
+
+/// Return the next part of a snapshot and advance past it, or null
+static const void*
+sord_binary_part(const uint8_t* const data,
+                 const size_t         size,
+                 size_t* const        offset,
+                 const uint64_t       count,
+                 const size_t         elem_size)
+{
+  if (count > (size - *offset) / elem_size) {
+    return NULL;
+  }
+
+  const size_t n_bytes = (size_t)count * elem_size;
+  const size_t padded  = n_bytes + ((8U - (n_bytes % 8U)) % 8U);
+  if (padded > size - *offset) {
+    return NULL;
+  }
+
+  const void* const part = data + *offset;
+  *offset += padded;
+  return part;
+}
+
+static bool
+sord_binary_node_is_valid(const SordBinaryView* const view,
+                          const SordBinaryNode* const entry)
+{
+  const uint64_t strings_size = view->header->strings_size;
+  if (entry->offset >= strings_size ||
+      entry->n_bytes >= strings_size - entry->offset ||
+      entry->lang[sizeof(entry->lang) - 1U]) {
+    return false;
+  }
+
+  const char* const str = view->strings + entry->offset;
+  if (memchr(str, 0, (size_t)entry->n_bytes) || str[entry->n_bytes]) {
+    return false;
+  }
+
+  if (entry->type == SERD_LITERAL) {
+    return !entry->datatype ||
+           (entry->datatype <= view->header->n_nodes && !entry->lang[0] &&
+            view->nodes[entry->datatype - 1U].type == SERD_URI);
+  }
+
+  return (entry->type == SERD_URI || entry->type == SERD_BLANK) &&
+         !entry->datatype && !entry->lang[0];
+}
+
+static bool
+sord_binary_quad_is_valid(const SordBinaryView* const view,
+                          const SordBinaryQuad        quad)
+{
+  const uint64_t n_nodes = view->header->n_nodes;
+
+  return quad[0] && quad[1] && quad[2] && quad[0] <= n_nodes &&
+         quad[1] <= n_nodes && quad[2] <= n_nodes && quad[TUP_G] <= n_nodes;
+}
+
+/**
+   Return true iff `x` is before `y` in an index.
+
+   Since no graph matches any graph in a model, a quad without a graph can't
+   be next to the same triple with a graph.
+*/
+static bool
+sord_binary_in_order(const SordBinaryQuad x,
+                     const SordBinaryQuad y,
+                     const int* const     ordering)
+{
+  return sord_binary_quad_compare(x, y, ordering) < 0 &&
+         (x[TUP_G] || x[0] != y[0] || x[1] != y[1] || x[2] != y[2]);
+}
+
+/// Set up a view of a snapshot in memory, if it is entirely valid
+static SerdStatus
+sord_binary_view(const uint8_t* const  data,
+                 const size_t          size,
+                 SordBinaryView* const view)
+{
+  memset(view, 0, sizeof(SordBinaryView));
+
+  size_t                        offset = 0U;
+  const SordBinaryHeader* const header = (const SordBinaryHeader*)
+    sord_binary_part(data, size, &offset, 1U, sizeof(SordBinaryHeader));
+
+  const uint32_t all_orders = (1U << NUM_ORDERS) - 1U;
+  if (!header ||
+      memcmp(header->magic, SORD_BINARY_MAGIC, sizeof(header->magic)) ||
+      header->version != SORD_BINARY_VERSION ||
+      header->byte_order != SORD_BINARY_BYTE_ORDER || header->reserved ||
+      (header->orders & ~all_orders) ||
+      (header->orders & (1U << DEFAULT_ORDER)) ||
+      header->n_nodes >= UINT32_MAX || header->n_quads >= UINT32_MAX) {
+    return SERD_ERR_BAD_SYNTAX;
+  }
+
+  view->header  = header;
+  view->nodes   = (const SordBinaryNode*)sord_binary_part(
+    data, size, &offset, header->n_nodes, sizeof(SordBinaryNode));
+  view->strings = (const char*)sord_binary_part(
+    data, size, &offset, header->strings_size, 1U);
+  view->quads   = (const SordBinaryQuad*)sord_binary_part(
+    data, size, &offset, header->n_quads, sizeof(SordBinaryQuad));
+  if (!view->nodes || !view->strings || !view->quads) {
+    return SERD_ERR_BAD_SYNTAX;
+  }
+
+  for (uint64_t i = 0U; i < header->n_nodes; ++i) {
+    if (!sord_binary_node_is_valid(view, &view->nodes[i])) {
+      return SERD_ERR_BAD_SYNTAX;
+    }
+  }
+
+  const int* const spo = orderings[DEFAULT_ORDER];
+  for (uint64_t i = 0U; i < header->n_quads; ++i) {
+    const SordBinaryQuad* const quad = &view->quads[i];
+    if (!sord_binary_quad_is_valid(view, *quad) ||
+        (i && !sord_binary_in_order(view->quads[i - 1U], *quad, spo))) {
+      return SERD_ERR_BAD_SYNTAX;
+    }
+
+    view->n_graph += (*quad)[TUP_G] ? 1U : 0U;
+  }
+
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    if (!(header->orders & (1U << o))) {
+      continue;
+    }
+
+    const size_t n = (o < GSPO) ? (size_t)header->n_quads : view->n_graph;
+    const uint32_t* const positions = (const uint32_t*)sord_binary_part(
+      data, size, &offset, n, sizeof(uint32_t));
+    if (!positions) {
+      return SERD_ERR_BAD_SYNTAX;
+    }
+
+    for (size_t i = 0U; i < n; ++i) {
+      if (positions[i] >= header->n_quads ||
+          (o >= GSPO && !view->quads[positions[i]][TUP_G]) ||
+          (i && !sord_binary_in_order(view->quads[positions[i - 1U]],
+                                      view->quads[positions[i]],
+                                      orderings[o]))) {
+        return SERD_ERR_BAD_SYNTAX;
+      }
+    }
+
+    view->positions[o] = positions;
+  }
+
+  return (offset == size) ? SERD_SUCCESS : SERD_ERR_BAD_SYNTAX;
+}
+
+static SordNode*
+sord_binary_node_new(SordWorld* const            world,
+                     const SordBinaryView* const view,
+                     const SordBinaryNode* const entry,
+                     SordNode* const* const      nodes)
+{
+  const uint8_t* const str     = (const uint8_t*)view->strings + entry->offset;
+  const size_t         n_bytes = (size_t)entry->n_bytes;
+  const size_t         n_chars = (size_t)entry->n_chars;
+
+  if (entry->type == SERD_URI) {
+    return sord_new_uri_counted(world, str, n_bytes, n_chars);
+  } else if (entry->type == SERD_BLANK) {
+    return sord_new_blank_counted(world, str, n_bytes, n_chars);
+  }
+
+  return sord_new_literal_counted(world,
+                                  nodes[entry->datatype],
+                                  str,
+                                  n_bytes,
+                                  n_chars,
+                                  (SerdNodeFlags)entry->flags,
+                                  entry->lang[0] ? entry->lang : NULL);
+}
+
+/**
+   Insert snapshot quads into an empty model which compares by value.
+
+   Every part of the snapshot is already in order, so the default index and
+   any index with stored positions are built without sorting.
+*/
+static void
+sord_insert_binary_quads(SordModel* const            model,
+                         const SordBinaryView* const view,
+                         SordQuad* const             tuples)
+{
+  const size_t n_quads = (size_t)view->header->n_quads;
+  if (model->n_iters > 0) {
+    error(model->world, SERD_ERR_BAD_ARG, "added tuple during iteration\n");
+  }
+
+  SORD_WRITE_LOG("Load %zu binary quads\n", n_quads);
+
+  const SordNode*** const records =
+    (const SordNode***)malloc((n_quads + 1U) * sizeof(const SordNode**));
+  const SordNode*** const tmp =
+    (const SordNode***)malloc((n_quads + 1U) * sizeof(const SordNode**));
+
+  for (size_t i = 0U; i < n_quads; ++i) {
+    records[i] = sord_quad_new(model, tuples[i]);
+    sord_add_to_index(model, records[i], DEFAULT_ORDER);
+    for (int t = 0; t < TUP_LEN; ++t) {
+      sord_add_quad_ref(model, records[i][t], (SordQuadIndex)t);
+    }
+  }
+
+  unsigned skip = 0U;
+  for (unsigned o = 0U; o < NUM_ORDERS; ++o) {
+    const uint32_t* const positions = view->positions[o];
+    if (positions && model->store->indices[o]) {
+      const size_t n = (o < GSPO) ? n_quads : view->n_graph;
+      for (size_t i = 0U; i < n; ++i) {
+        sord_add_to_index(model, records[positions[i]], (SordOrder)o);
+      }
+
+      skip |= 1U << o;
+    }
+  }
+
+  sord_add_to_other_indices(model, records, tmp, n_quads, skip);
+
+  model->store->n_quads = n_quads;
+  model->store->ranked  = false;
+  for (size_t i = 0U; i < n_quads; ++i) {
+    sord_add_value(model->store, records[i]);
+    sord_notify(model, SORD_ADDED, records[i]);
+  }
+
+  free(tmp);
+  free(records);
+}
+
+/// Read an entire file into a new buffer, or return null
+static uint8_t*
+sord_binary_read(const uint8_t* const path, size_t* const size)
+{
+  FILE* const stream = fopen((const char*)path, "rb");
+  if (!stream) {
+    return NULL;
+  }
+
+  uint8_t* data = NULL;
+  if (!fseek(stream, 0, SEEK_END)) {
+    const long end = ftell(stream);
+    if (end >= 0 && !fseek(stream, 0, SEEK_SET)) {
+      *size = (size_t)end;
+      data  = (uint8_t*)malloc(*size + 1U);
+      if (fread(data, 1U, *size, stream) != *size) {
+        free(data);
+        data = NULL;
+      }
+    }
+  }
+
+  fclose(stream);
+  return data;
+}
+
+SerdStatus
+sord_load_binary(SordModel* model, const uint8_t* path)
+{
+  SordWorld* const world = model->world;
+  if (!sord_prepare_write(model)) {
+    return SERD_ERR_BAD_ARG;
+  }
+
+  size_t         size = 0U;
+  uint8_t* const data = sord_binary_read(path, &size);
+  if (!data) {
+    error(world, SERD_ERR_UNKNOWN, "failed to read `%s'\n", path);
+    return SERD_ERR_UNKNOWN;
+  }
+
+  SordBinaryView view;
+  SerdStatus     st = sord_binary_view(data, size, &view);
+  if (st) {
+    free(data);
+    error(world, st, "invalid binary snapshot `%s'\n", path);
+    return st;
+  }
+
+  // Create resources first, since literals refer to them as datatypes
+  const size_t     n_nodes = (size_t)view.header->n_nodes;
+  SordNode** const nodes =
+    (SordNode**)calloc(n_nodes + 1U, sizeof(SordNode*));
+
+  for (unsigned pass = 0U; !st && pass < 2U; ++pass) {
+    for (size_t i = 0U; !st && i < n_nodes; ++i) {
+      const SordBinaryNode* const entry = &view.nodes[i];
+      if ((entry->type == SERD_LITERAL) == (pass == 1U)) {
+        nodes[i + 1U] = sord_binary_node_new(world, &view, entry, nodes);
+        st            = nodes[i + 1U] ? SERD_SUCCESS : SERD_ERR_BAD_SYNTAX;
+      }
+    }
+  }
+
+  // Check that nodes are numbered in value order, so quads are sorted
+  for (size_t i = 1U; !st && i < n_nodes; ++i) {
+    if (sord_node_compare(nodes[i], nodes[i + 1U]) >= 0) {
+      st = SERD_ERR_BAD_SYNTAX;
+    }
+  }
+
+  const size_t    n_quads = (size_t)view.header->n_quads;
+  SordQuad* const tuples =
+    (SordQuad*)malloc((n_quads + 1U) * sizeof(SordQuad));
+  for (size_t i = 0U; !st && i < n_quads; ++i) {
+    for (int t = 0; t < TUP_LEN; ++t) {
+      tuples[i][t] = nodes[view.quads[i][t]];
+    }
+  }
+
+  if (st) {
+    error(world, st, "invalid binary snapshot `%s'\n", path);
+  } else if (model->store->n_quads || model->in_bulk ||
+             model->compare != sord_quad_compare) {
+    sord_add_batch(model, tuples, n_quads);
+  } else {
+    sord_insert_binary_quads(model, &view, tuples);
+  }
+
+  // Drop the references to nodes that were taken while creating them
+  for (size_t i = 1U; i <= n_nodes; ++i) {
+    sord_node_free(world, nodes[i]);
+  }
+
+  free(tuples);
+  free(nodes);
+  free(data);
+  return st;
+}
+
+/// Map an entire file into memory, or read it if that isn't possible
+static SordMapping*
+sord_mapping_open(const uint8_t* const path)
+{
+  SordMapping* const mapping = (SordMapping*)calloc(1U, sizeof(SordMapping));
+  mapping->refs              = 1U;
+
+#if USE_MMAP
+  struct stat info;
+  const int   fd = open((const char*)path, O_RDONLY);
+  if (fd >= 0 && !fstat(fd, &info) && info.st_size > 0) {
+    const size_t size = (size_t)info.st_size;
+    void* const  data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED) {
+      mapping->data      = data;
+      mapping->size      = size;
+      mapping->is_mapped = true;
+    }
+  }
+
+  if (fd >= 0) {
+    close(fd);
+  }
+#endif
+
+  if (!mapping->data) {
+    mapping->data = sord_binary_read(path, &mapping->size);
+  }
+
+  if (!mapping->data) {
+    free(mapping);
+    return NULL;
+  }
+
+  return mapping;
+}
+
+/// Register a node in the world with a string that points into a mapping
+static SordNode*
+sord_mapping_intern(SordWorld* const   world,
+                    SordMapping* const mapping,
+                    const size_t       number)
+{
+  const SordBinaryNode* const entry = &mapping->view.nodes[number - 1U];
+  const uint8_t* const        str =
+    (const uint8_t*)mapping->view.strings + entry->offset;
+
+  if (entry->type == SERD_URI && !serd_uri_string_has_scheme(str)) {
+    error(world, SERD_ERR_BAD_ARG, "attempt to map invalid URI `%s'\n", str);
+    return NULL; // Can't intern relative URIs
+  }
+
+  const SerdType type = (SerdType)entry->type;
+
+  SordNode key;
+  memset(&key, 0, sizeof(key));
+  key.node.buf     = str;
+  key.node.n_bytes = (size_t)entry->n_bytes;
+  key.node.n_chars = (size_t)entry->n_chars;
+  key.node.flags   = (type == SERD_LITERAL) ? entry->flags : 0U;
+  key.node.type    = type;
+  key.refs         = 1U;
+  if (type == SERD_LITERAL) {
+    key.meta.lit.datatype = mapping->nodes[entry->datatype];
+    strncpy(key.meta.lit.lang, entry->lang, sizeof(entry->lang) - 1U);
+    key.meta.lit.value = sord_literal_value(&key);
+  }
+
+  key.hash = sord_node_digest(&key);
+
+  const ZixHashInsertPlan plan = zix_hash_plan_insert(world->nodes, &key);
+  SordNode*               node = zix_hash_record_at(world->nodes, plan);
+  if (node) {
+    SORD_ATOMIC_INCREMENT(&node->refs);
+  } else {
+    // Allocate a record with a string that points into the mapping
+    const size_t record_size = sord_node_record_size(&key);
+
+    node     = (SordNode*)sord_node_alloc(world, record_size);
+    memcpy(node, &key, record_size);
+    node->id = ++world->last_id;
+    if (type == SERD_LITERAL) {
+      sord_node_copy(node->meta.lit.datatype);
+    }
+
+    if (zix_hash_insert_at(world->nodes, plan, node)) {
+      if (type == SERD_LITERAL) {
+        sord_node_free(world, node->meta.lit.datatype);
+      }
+
+      error(world, SERD_ERR_INTERNAL, "error inserting node `%s'\n", str);
+      if (!world->use_arena) {
+        world->node_bytes -= record_size;
+        free(node);
+      }
+      return NULL;
+    }
+
+    mapping->records[number] = node;
+  }
+
+  if (type != SERD_LITERAL) {
+    node->meta.res.refs_as_obj += mapping->n_as_obj[number];
+  }
+
+  return node;
+}
+
+SordModel*
+sord_open_binary(SordWorld* world, const uint8_t* path)
+{
+  SordMapping* const mapping = sord_mapping_open(path);
+  if (!mapping) {
+    error(world, SERD_ERR_UNKNOWN, "failed to read `%s'\n", path);
+    return NULL;
+  }
+
+  SordBinaryView* const view = &mapping->view;
+  const size_t          size = mapping->size;
+  SerdStatus            st   = sord_binary_view(mapping->data, size, view);
+  if (st) {
+    error(world, st, "invalid binary snapshot `%s'\n", path);
+    sord_mapping_release(world, mapping);
+    return NULL;
+  }
+
+  const size_t n_nodes = (size_t)view->header->n_nodes;
+  const size_t n_quads = (size_t)view->header->n_quads;
+
+  mapping->records  = (SordNode**)calloc(n_nodes + 1U, sizeof(SordNode*));
+  mapping->nodes    = (SordNode**)calloc(n_nodes + 1U, sizeof(SordNode*));
+  mapping->n_as_obj = (uint32_t*)calloc(n_nodes + 1U, sizeof(uint32_t));
+  for (size_t i = 0U; i < n_quads; ++i) {
+    ++mapping->n_as_obj[view->quads[i][SORD_OBJECT]];
+  }
+
+  // Register resources first, since literals refer to them as datatypes
+  for (unsigned pass = 0U; !st && pass < 2U; ++pass) {
+    for (size_t i = 1U; !st && i <= n_nodes; ++i) {
+      const SordBinaryNode* const entry = &view->nodes[i - 1U];
+      if ((entry->type == SERD_LITERAL) == (pass == 1U)) {
+        mapping->nodes[i] = sord_mapping_intern(world, mapping, i);
+        st = mapping->nodes[i] ? SERD_SUCCESS : SERD_ERR_BAD_SYNTAX;
+      }
+    }
+  }
+
+  // Check that nodes are numbered in value order, so quads are sorted
+  for (size_t i = 1U; !st && i < n_nodes; ++i) {
+    if (sord_node_compare(mapping->nodes[i], mapping->nodes[i + 1U]) >= 0) {
+      st = SERD_ERR_BAD_SYNTAX;
+    }
+  }
+
+  if (st) {
+    error(world, st, "invalid binary snapshot `%s'\n", path);
+    sord_mapping_release(world, mapping);
+    return NULL;
+  }
+
+  SordModel* const model = sord_new(world, SORD_SPO, false);
+  model->read_only       = true;
+  model->mapping         = mapping;
+  model->store->n_quads  = n_quads;
+  return model;
 }
@@ -20,6 +20,31 @@
 
 #if !defined(SORD_NO_DEFAULT_CONFIG)
 
+// We need unistd.h to check _POSIX_VERSION
+#  ifndef SORD_NO_POSIX
+#    ifdef __has_include
+#      if __has_include(<unistd.h>)
+#        include <unistd.h>
+#      endif
+#    elif defined(__APPLE__) || defined(__unix__)
+#      include <unistd.h>
+#    endif
+#  endif
+
+// Define SORD_POSIX_VERSION unconditionally for convenience
+#  if defined(_POSIX_VERSION)
+#    define SORD_POSIX_VERSION _POSIX_VERSION
+#  else
+#    define SORD_POSIX_VERSION 0
+#  endif
+
+// POSIX.1-2001: mmap()
+#  ifndef HAVE_MMAP
+#    if SORD_POSIX_VERSION >= 200112L
+#      define HAVE_MMAP 1
+#    endif
+#  endif
+
 // The validator uses PCRE2 for literal pattern matching
 #  ifndef HAVE_PCRE2
 #    ifdef __has_include
@@ -39,6 +64,12 @@
   if the build system defines them all.
 */
 
+#ifdef HAVE_MMAP
+#  define USE_MMAP 1
+#else
+#  define USE_MMAP 0
+#endif
+
 #ifdef HAVE_PCRE2
 #  define USE_PCRE2 1
 #else
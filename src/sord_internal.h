@@ -17,6 +17,47 @@
 #  define SORD_UNREACHABLE()
 #endif
 
+/*
+  Atomic counter operations, used for anything that readers modify.  Writers
+  have exclusive access, so they can use plain operations on the same counts,
+  but must acquire a count that a reader may have dropped before freeing it.
+*/
+#if defined(__GNUC__) || defined(__clang__)
+#  define SORD_ATOMIC_LOAD(ptr) __atomic_load_n(ptr, __ATOMIC_RELAXED)
+#  define SORD_ATOMIC_ACQUIRE(ptr) __atomic_load_n(ptr, __ATOMIC_ACQUIRE)
+#  define SORD_ATOMIC_INCREMENT(ptr) \
+    __atomic_add_fetch(ptr, 1U, __ATOMIC_RELAXED)
+#  define SORD_ATOMIC_DECREMENT(ptr) \
+    __atomic_sub_fetch(ptr, 1U, __ATOMIC_ACQ_REL)
+#  define SORD_ATOMIC_ADD(ptr, n) __atomic_add_fetch(ptr, n, __ATOMIC_RELAXED)
+#elif defined(_MSC_VER) && defined(_WIN64)
+#  include <intrin.h>
+#  define SORD_ATOMIC_LOAD(ptr) (*(const volatile size_t*)(ptr))
+#  define SORD_ATOMIC_ACQUIRE(ptr) (*(const volatile size_t*)(ptr))
+#  define SORD_ATOMIC_INCREMENT(ptr) \
+    ((size_t)_InterlockedIncrement64((volatile __int64*)(ptr)))
+#  define SORD_ATOMIC_DECREMENT(ptr) \
+    ((size_t)_InterlockedDecrement64((volatile __int64*)(ptr)))
+#  define SORD_ATOMIC_ADD(ptr, n) \
+    ((size_t)_InterlockedExchangeAdd64((volatile __int64*)(ptr), (__int64)(n)))
+#elif defined(_MSC_VER)
+#  include <intrin.h>
+#  define SORD_ATOMIC_LOAD(ptr) (*(const volatile size_t*)(ptr))
+#  define SORD_ATOMIC_ACQUIRE(ptr) (*(const volatile size_t*)(ptr))
+#  define SORD_ATOMIC_INCREMENT(ptr) \
+    ((size_t)_InterlockedIncrement((volatile long*)(ptr)))
+#  define SORD_ATOMIC_DECREMENT(ptr) \
+    ((size_t)_InterlockedDecrement((volatile long*)(ptr)))
+#  define SORD_ATOMIC_ADD(ptr, n) \
+    ((size_t)_InterlockedExchangeAdd((volatile long*)(ptr), (long)(n)))
+#else
+#  define SORD_ATOMIC_LOAD(ptr) (*(ptr))
+#  define SORD_ATOMIC_ACQUIRE(ptr) (*(ptr))
+#  define SORD_ATOMIC_INCREMENT(ptr) (++*(ptr))
+#  define SORD_ATOMIC_DECREMENT(ptr) (--*(ptr))
+#  define SORD_ATOMIC_ADD(ptr, n) (*(ptr) += (n))
+#endif
+
 /** Resource node metadata */
 typedef struct {
   size_t refs_as_obj; ///< References as a quad object
@@ -26,16 +67,27 @@ typedef struct {
 typedef struct {
   SordNode* datatype; ///< Optional literal data type URI
   char      lang[16]; ///< Optional language tag
+  double    value;    ///< Value of a number or date literal, or NaN
 } SordLiteralMetadata;
 
 /** Node */
 struct SordNodeImpl {
   SerdNode node; ///< Serd node
   size_t   refs; ///< Reference count (# of containing quads)
+  size_t   id;   ///< Unique ID in world, assigned when interned
+  size_t   hash; ///< Hash of the string and metadata, computed once
   union {
     SordResourceMetadata res;
     SordLiteralMetadata  lit;
   } meta;
 };
 
+/**
+   Return an iterator to every quad in a model.
+
+   Unlike sord_begin(), this visits a triple once for every graph it is in.
+*/
+SordIter*
+sord_begin_all(const SordModel* model);
+
 #endif /* SORD_SORD_INTERNAL_H */
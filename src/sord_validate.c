@@ -5,11 +5,13 @@
 #define _DEFAULT_SOURCE 1 // for realpath
 
 #include "sord_config.h"
+#include "sord_internal.h"
 
 #include <serd/serd.h>
 #include <sord/sord.h>
 #include <zix/allocator.h>
 #include <zix/filesystem.h>
+#include <zix/thread.h>
 
 #if USE_PCRE2
 #  if defined(__clang__)
@@ -84,10 +86,73 @@ typedef struct {
   SordNode* xsd_string;
 } URIs;
 
-static int  n_errors        = 0;
-static int  n_restrictions  = 0;
 static bool one_line_errors = false;
 
+/// A memoized result of is_descendant_of()
+typedef struct {
+  const SordNode* child;
+  const SordNode* parent;
+  const SordNode* pred;
+  bool            is_descendant;
+} Descent;
+
+/// Cached facts about a predicate, used to check every statement that uses it
+typedef struct {
+  const SordNode*  pred;
+  const SordNode*  domain;   ///< First rdfs:domain, or null
+  const SordNode** ranges;   ///< Every rdfs:range
+  size_t           n_ranges; ///< Number of elements in ranges
+  bool             is_any_property;
+  bool             is_ObjectProperty;
+  bool             is_FunctionalProperty;
+  bool             is_InverseFunctionalProperty;
+  bool             is_DatatypeProperty;
+  bool             has_label;
+} Property;
+
+#if USE_PCRE2
+
+/// A compiled xsd:pattern, cached so each pattern is only compiled once
+typedef struct {
+  const SordNode*   pattern;    ///< Interned pattern literal
+  pcre2_code*       re;         ///< Compiled pattern, or null if invalid
+  pcre2_match_data* match_data; ///< Match data reused for every match
+} Regex;
+
+#endif // USE_PCRE2
+
+/// Output buffered while checking part of a model in parallel
+typedef struct {
+  char*  buf;
+  size_t len;
+  size_t size;
+} Output;
+
+/**
+   The state for checking a model, or some part of it.
+
+   Each checking thread has its own, so that checks don't share the caches
+   or counters, and each writes its output to a separate buffer.  Tables are
+   open-addressed hash tables, with a power of two size and null empty keys.
+*/
+typedef struct {
+  SordModel*  model;
+  const URIs* uris;
+  Output*     out;             ///< Output buffer, or null to print directly
+  int         n_errors;        ///< Number of errors found
+  int         n_restrictions;  ///< Number of restrictions checked
+  Descent*    descents;        ///< Memoized is_descendant_of() results
+  size_t      n_descents;      ///< Number of elements in descents
+  size_t      descents_size;   ///< Size of descents table
+  Property*   properties;      ///< Cached predicate facts
+  size_t      n_properties;    ///< Number of elements in properties
+  size_t      properties_size; ///< Size of properties table
+#if USE_PCRE2
+  Regex*      regexes;         ///< Compiled patterns
+  size_t      n_regexes;       ///< Number of elements in regexes
+#endif
+} Checker;
+
 static int
 print_version(void)
 {
@@ -106,9 +171,10 @@ print_usage(const char* name, bool error)
   FILE* const os = error ? stderr : stdout;
   fprintf(os, "Usage: %s [OPTION]... INPUT...\n", name);
   fprintf(os, "Validate RDF data.\n\n");
-  fprintf(os, "  -h  Display this help and exit\n");
-  fprintf(os, "  -l  Print errors on a single line\n");
-  fprintf(os, "  -v  Display version information and exit\n");
+  fprintf(os, "  -h    Display this help and exit\n");
+  fprintf(os, "  -j N  Use up to N threads for parsing and checking\n");
+  fprintf(os, "  -l    Print errors on a single line\n");
+  fprintf(os, "  -v    Display version information and exit\n");
   fprintf(os,
           "\n"
           "Validate RDF data.  This is a simple validator which checks\n"
@@ -118,17 +184,59 @@ print_usage(const char* name, bool error)
   return error ? 1 : 0;
 }
 
-SORD_LOG_FUNC(2, 3) static int
-errorf(const SordQuad quad, const char* fmt, ...)
+SORD_LOG_FUNC(2, 0) static void
+voutputf(Checker* checker, const char* fmt, va_list args)
+{
+  Output* const out = checker->out;
+  if (!out) {
+    vfprintf(stderr, fmt, args);
+    return;
+  }
+
+  va_list copy;
+  va_copy(copy, args);
+  const int len = vsnprintf(NULL, 0, fmt, copy);
+  va_end(copy);
+  if (len < 0) {
+    return;
+  }
+
+  const size_t needed = out->len + (size_t)len + 1U;
+  if (needed > out->size) {
+    const size_t new_size = needed > out->size * 2U ? needed : out->size * 2U;
+    char* const  new_buf  = (char*)realloc(out->buf, new_size);
+    if (!new_buf) {
+      return;
+    }
+
+    out->buf  = new_buf;
+    out->size = new_size;
+  }
+
+  vsnprintf(out->buf + out->len, out->size - out->len, fmt, args);
+  out->len += (size_t)len;
+}
+
+SORD_LOG_FUNC(2, 3) static void
+outputf(Checker* checker, const char* fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  voutputf(checker, fmt, args);
+  va_end(args);
+}
+
+SORD_LOG_FUNC(3, 4) static int
+errorf(Checker* checker, const SordQuad quad, const char* fmt, ...)
 {
   va_list args;
   va_start(args, fmt);
-  fprintf(stderr, "error: ");
-  vfprintf(stderr, fmt, args);
+  outputf(checker, "error: ");
+  voutputf(checker, fmt, args);
   va_end(args);
 
   const char* sep = one_line_errors ? "\t" : "\n       ";
-  fprintf(stderr,
+  outputf(checker,
           "%s%s%s%s%s%s\n",
           sep,
           (const char*)sord_node_get_string(quad[SORD_SUBJECT]),
@@ -137,21 +245,86 @@ errorf(const SordQuad quad, const char* fmt, ...)
           sep,
           (const char*)sord_node_get_string(quad[SORD_OBJECT]));
 
-  ++n_errors;
+  ++checker->n_errors;
   return 1;
 }
 
+static size_t
+hash_nodes(const SordNode* a, const SordNode* b, const SordNode* c)
+{
+  uint64_t h = (uint64_t)(uintptr_t)a;
+  h          = (h * 0x9E3779B97F4A7C15U) ^ (uint64_t)(uintptr_t)b;
+  h          = (h * 0x9E3779B97F4A7C15U) ^ (uint64_t)(uintptr_t)c;
+  return (size_t)(h ^ (h >> 29U));
+}
+
+static Descent*
+find_descent(Descent* const        table,
+             const size_t          size,
+             const SordNode* const child,
+             const SordNode* const parent,
+             const SordNode* const pred)
+{
+  size_t i = hash_nodes(child, parent, pred) & (size - 1U);
+  while (table[i].child &&
+         (table[i].child != child || table[i].parent != parent ||
+          table[i].pred != pred)) {
+    i = (i + 1U) & (size - 1U);
+  }
+
+  return &table[i];
+}
+
+static void
+add_descent(Checker* const checker, const Descent descent)
+{
+  if ((checker->n_descents + 1U) * 2U > checker->descents_size) {
+    const size_t old_size = checker->descents_size;
+    const size_t new_size = old_size ? old_size * 2U : 256U;
+
+    Descent* const table = (Descent*)calloc(new_size, sizeof(Descent));
+    if (!table) {
+      return;
+    }
+
+    for (size_t i = 0U; i < old_size; ++i) {
+      const Descent* const d = &checker->descents[i];
+      if (d->child) {
+        *find_descent(table, new_size, d->child, d->parent, d->pred) = *d;
+      }
+    }
+
+    free(checker->descents);
+    checker->descents      = table;
+    checker->descents_size = new_size;
+  }
+
+  *find_descent(checker->descents,
+                checker->descents_size,
+                descent.child,
+                descent.parent,
+                descent.pred) = descent;
+
+  ++checker->n_descents;
+}
+
 static bool
-is_descendant_of(SordModel*      model,
-                 const URIs*     uris,
+is_descendant_of(Checker*        checker,
                  const SordNode* child,
                  const SordNode* parent,
-                 const SordNode* pred)
+                 const SordNode* pred);
+
+static bool
+search_descendant_of(Checker*        checker,
+                     const SordNode* child,
+                     const SordNode* parent,
+                     const SordNode* pred)
 {
-  if (!child) {
-    return false;
-  } else if (sord_node_equals(child, parent) ||
-             sord_ask(model, child, uris->owl_equivalentClass, parent, NULL)) {
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
+
+  if (sord_node_equals(child, parent) ||
+      sord_ask(model, child, uris->owl_equivalentClass, parent, NULL)) {
     return true;
   }
 
@@ -161,7 +334,7 @@ is_descendant_of(SordModel*      model,
     if (sord_node_equals(child, o)) {
       continue; // Weird class is explicitly a descendent of itself
     }
-    if (is_descendant_of(model, uris, o, parent, pred)) {
+    if (is_descendant_of(checker, o, parent, pred)) {
       sord_iter_free(i);
       return true;
     }
@@ -172,59 +345,248 @@ is_descendant_of(SordModel*      model,
 }
 
 static bool
-regexp_match(const uint8_t* const pattern, const char* const str)
+is_descendant_of(Checker*        checker,
+                 const SordNode* child,
+                 const SordNode* parent,
+                 const SordNode* pred)
+{
+  if (!child) {
+    return false;
+  }
+
+  // The model doesn't change while validating, so results never go stale
+  if (checker->descents_size) {
+    const Descent* const d = find_descent(
+      checker->descents, checker->descents_size, child, parent, pred);
+    if (d->child) {
+      return d->is_descendant;
+    }
+  }
+
+  const Descent descent = {
+    child,
+    parent,
+    pred,
+    search_descendant_of(checker, child, parent, pred),
+  };
+
+  add_descent(checker, descent);
+  return descent.is_descendant;
+}
+
+static Property*
+find_property(Property* const table, const size_t size, const SordNode* pred)
 {
+  size_t i = hash_nodes(pred, NULL, NULL) & (size - 1U);
+  while (table[i].pred && table[i].pred != pred) {
+    i = (i + 1U) & (size - 1U);
+  }
+
+  return &table[i];
+}
+
+static Property
+load_property(Checker* checker, const SordNode* pred)
+{
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
+
+  Property prop = {
+    pred, NULL, NULL, 0U, false, false, false, false, false, false};
+
+  SordIter* t = sord_search(model, pred, uris->rdf_type, NULL, NULL);
+  for (; !sord_iter_end(t); sord_iter_next(t)) {
+    if (is_descendant_of(checker,
+                         sord_iter_get_node(t, SORD_OBJECT),
+                         uris->rdf_Property,
+                         uris->rdfs_subClassOf)) {
+      prop.is_any_property = true;
+      break;
+    }
+  }
+  sord_iter_free(t);
+
+  prop.is_ObjectProperty =
+    sord_ask(model, pred, uris->rdf_type, uris->owl_ObjectProperty, 0);
+  prop.is_FunctionalProperty =
+    sord_ask(model, pred, uris->rdf_type, uris->owl_FunctionalProperty, 0);
+  prop.is_InverseFunctionalProperty = sord_ask(
+    model, pred, uris->rdf_type, uris->owl_InverseFunctionalProperty, 0);
+  prop.is_DatatypeProperty =
+    sord_ask(model, pred, uris->rdf_type, uris->owl_DatatypeProperty, 0);
+  prop.has_label = sord_ask(model, pred, uris->rdfs_label, NULL, NULL);
+
+  SordIter* d = sord_search(model, pred, uris->rdfs_domain, NULL, NULL);
+  if (d) {
+    prop.domain = sord_iter_get_node(d, SORD_OBJECT);
+    sord_iter_free(d);
+  }
+
+  const size_t n_ranges = sord_count(model, pred, uris->rdfs_range, NULL, NULL);
+  if (n_ranges) {
+    prop.ranges = (const SordNode**)calloc(n_ranges, sizeof(SordNode*));
+
+    SordIter* r = sord_search(model, pred, uris->rdfs_range, NULL, NULL);
+    for (; prop.ranges && !sord_iter_end(r); sord_iter_next(r)) {
+      prop.ranges[prop.n_ranges++] = sord_iter_get_node(r, SORD_OBJECT);
+    }
+    sord_iter_free(r);
+  }
+
+  return prop;
+}
+
+static const Property*
+get_property(Checker* checker, const SordNode* pred)
+{
+  if (checker->properties_size) {
+    Property* const prop =
+      find_property(checker->properties, checker->properties_size, pred);
+    if (prop->pred) {
+      return prop;
+    }
+  }
+
+  if ((checker->n_properties + 1U) * 2U > checker->properties_size) {
+    const size_t old_size = checker->properties_size;
+    const size_t new_size = old_size ? old_size * 2U : 64U;
+
+    Property* const table = (Property*)calloc(new_size, sizeof(Property));
+    if (!table) {
+      return NULL;
+    }
+
+    for (size_t i = 0U; i < old_size; ++i) {
+      const Property* const prop = &checker->properties[i];
+      if (prop->pred) {
+        *find_property(table, new_size, prop->pred) = *prop;
+      }
+    }
+
+    free(checker->properties);
+    checker->properties      = table;
+    checker->properties_size = new_size;
+  }
+
+  Property* const prop =
+    find_property(checker->properties, checker->properties_size, pred);
+
+  *prop = load_property(checker, pred);
+  ++checker->n_properties;
+  return prop;
+}
+
 #if USE_PCRE2
+
+static const Regex*
+get_regex(Checker* const checker, const SordNode* const pattern)
+{
   static const uint32_t options = PCRE2_ANCHORED | PCRE2_ENDANCHORED;
 
-  int    err       = 0;
-  size_t erroffset = 0U;
+  for (size_t i = 0U; i < checker->n_regexes; ++i) {
+    if (checker->regexes[i].pattern == pattern) {
+      return &checker->regexes[i];
+    }
+  }
 
-  pcre2_code* const re = pcre2_compile(
-    pattern, PCRE2_ZERO_TERMINATED, options, &err, &erroffset, NULL);
+  const uint8_t* const str       = sord_node_get_string(pattern);
+  int                  err       = 0;
+  size_t               erroffset = 0U;
+
+  pcre2_code* const re =
+    pcre2_compile(str, PCRE2_ZERO_TERMINATED, options, &err, &erroffset, NULL);
 
   if (!re) {
-    fprintf(stderr,
+    outputf(checker,
             "Error in pattern `%s' at offset %zu (%d)\n",
-            pattern,
+            str,
             erroffset,
             err);
-    return false;
+  } else {
+    pcre2_jit_compile(re, PCRE2_JIT_COMPLETE); // Falls back to interpreter
+  }
+
+  Regex* const regexes = (Regex*)realloc(
+    checker->regexes, (checker->n_regexes + 1U) * sizeof(Regex));
+  if (!regexes) {
+    pcre2_code_free(re);
+    return NULL;
+  }
+
+  Regex* const regex = &regexes[checker->n_regexes++];
+  regex->pattern     = pattern;
+  regex->re          = re;
+  regex->match_data  = NULL;
+  if (re) {
+    regex->match_data = pcre2_match_data_create_from_pattern(re, NULL);
+  }
+
+  checker->regexes = regexes;
+  return regex;
+}
+
+#endif // USE_PCRE2
+
+static void
+free_checker(Checker* const checker)
+{
+  for (size_t i = 0U; i < checker->properties_size; ++i) {
+    free(checker->properties[i].ranges);
   }
 
-  pcre2_match_data* const match_data =
-    pcre2_match_data_create_from_pattern(re, NULL);
+  free(checker->properties);
+  free(checker->descents);
 
-  const int rc = pcre2_match(re,
-                             (const uint8_t*)str,
-                             PCRE2_ZERO_TERMINATED,
-                             0,
-                             options,
-                             match_data,
-                             NULL);
+#if USE_PCRE2
+  for (size_t i = 0U; i < checker->n_regexes; ++i) {
+    pcre2_match_data_free(checker->regexes[i].match_data);
+    pcre2_code_free(checker->regexes[i].re);
+  }
 
-  pcre2_match_data_free(match_data);
+  free(checker->regexes);
+#endif
+}
+
+static bool
+regexp_match(Checker* const        checker,
+             const SordNode* const pattern,
+             const char* const     str,
+             const size_t          len)
+{
+#if USE_PCRE2
+  const Regex* const regex = get_regex(checker, pattern);
+  if (!regex || !regex->re || !regex->match_data) {
+    return false;
+  }
+
+  // Anchoring is compiled into the pattern, so JIT code can be used
+  const int rc = pcre2_match(
+    regex->re, (const uint8_t*)str, len, 0, 0U, regex->match_data, NULL);
 
-  pcre2_code_free(re);
   return rc > 0;
 #else
+  (void)checker;
+  (void)pattern;
+  (void)str;
+  (void)len;
   return true;
 #endif // USE_PCRE2
 }
 
 static int
-bound_cmp(SordModel*      model,
-          const URIs*     uris,
+bound_cmp(Checker*        checker,
           const SordNode* literal,
           const SordNode* type,
           const SordNode* bound)
 {
+  const URIs* const uris = checker->uris;
+
   const char*     str       = (const char*)sord_node_get_string(literal);
   const char*     bound_str = (const char*)sord_node_get_string(bound);
   const SordNode* pred      = uris->owl_onDatatype;
   const bool      is_numeric =
-    is_descendant_of(model, uris, type, uris->xsd_decimal, pred) ||
-    is_descendant_of(model, uris, type, uris->xsd_double, pred);
+    is_descendant_of(checker, type, uris->xsd_decimal, pred) ||
+    is_descendant_of(checker, type, uris->xsd_double, pred);
 
   if (is_numeric) {
     const double fbound   = serd_strtod(bound_str, NULL);
@@ -236,12 +598,14 @@ bound_cmp(SordModel*      model,
 }
 
 static bool
-check_restriction(SordModel*      model,
-                  const URIs*     uris,
+check_restriction(Checker*        checker,
                   const SordNode* literal,
                   const SordNode* type,
                   const SordNode* restriction)
 {
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
+
   size_t      len = 0;
   const char* str = (const char*)sord_node_get_string_counted(literal, &len);
 
@@ -249,8 +613,8 @@ check_restriction(SordModel*      model,
   SordIter* p = sord_search(model, restriction, uris->xsd_pattern, 0, 0);
   if (p) {
     const SordNode* pat = sord_iter_get_node(p, SORD_OBJECT);
-    if (!regexp_match(sord_node_get_string(pat), str)) {
-      fprintf(stderr,
+    if (!regexp_match(checker, pat, str, len)) {
+      outputf(checker,
               "`%s' does not match <%s> pattern `%s'\n",
               sord_node_get_string(literal),
               sord_node_get_string(type),
@@ -259,15 +623,15 @@ check_restriction(SordModel*      model,
       return false;
     }
     sord_iter_free(p);
-    ++n_restrictions;
+    ++checker->n_restrictions;
   }
 
   // Check xsd:minInclusive
   SordIter* l = sord_search(model, restriction, uris->xsd_minInclusive, 0, 0);
   if (l) {
     const SordNode* lower = sord_iter_get_node(l, SORD_OBJECT);
-    if (bound_cmp(model, uris, literal, type, lower) < 0) {
-      fprintf(stderr,
+    if (bound_cmp(checker, literal, type, lower) < 0) {
+      outputf(checker,
               "`%s' is not >= <%s> minimum `%s'\n",
               sord_node_get_string(literal),
               sord_node_get_string(type),
@@ -276,15 +640,15 @@ check_restriction(SordModel*      model,
       return false;
     }
     sord_iter_free(l);
-    ++n_restrictions;
+    ++checker->n_restrictions;
   }
 
   // Check xsd:maxInclusive
   SordIter* u = sord_search(model, restriction, uris->xsd_maxInclusive, 0, 0);
   if (u) {
     const SordNode* upper = sord_iter_get_node(u, SORD_OBJECT);
-    if (bound_cmp(model, uris, literal, type, upper) > 0) {
-      fprintf(stderr,
+    if (bound_cmp(checker, literal, type, upper) > 0) {
+      outputf(checker,
               "`%s' is not <= <%s> maximum `%s'\n",
               sord_node_get_string(literal),
               sord_node_get_string(type),
@@ -293,19 +657,21 @@ check_restriction(SordModel*      model,
       return false;
     }
     sord_iter_free(u);
-    ++n_restrictions;
+    ++checker->n_restrictions;
   }
 
   return true; // Unknown restriction, be quietly tolerant
 }
 
 static bool
-literal_is_valid(SordModel*      model,
-                 const URIs*     uris,
+literal_is_valid(Checker*        checker,
                  const SordQuad  quad,
                  const SordNode* literal,
                  const SordNode* type)
 {
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
+
   if (!type) {
     return true;
   }
@@ -317,12 +683,13 @@ literal_is_valid(SordModel*      model,
      (e.g. xsd:decimal and xsd:string) there is a problem. */
   const SordNode* datatype = sord_node_get_datatype(literal);
   if (datatype && datatype != type) {
-    if (!is_descendant_of(model, uris, datatype, type, uris->owl_onDatatype) &&
-        !is_descendant_of(model, uris, type, datatype, uris->owl_onDatatype) &&
+    if (!is_descendant_of(checker, datatype, type, uris->owl_onDatatype) &&
+        !is_descendant_of(checker, type, datatype, uris->owl_onDatatype) &&
         !(sord_node_equals(datatype, uris->xsd_decimal) &&
           is_descendant_of(
-            model, uris, type, uris->xsd_double, uris->owl_onDatatype))) {
-      errorf(quad,
+            checker, type, uris->xsd_double, uris->owl_onDatatype))) {
+      errorf(checker,
+             quad,
              "Literal `%s' datatype <%s> is not compatible with <%s>\n",
              sord_node_get_string(literal),
              sord_node_get_string(datatype),
@@ -347,7 +714,7 @@ literal_is_valid(SordModel*      model,
 
     // Check this restriction
     const bool good = check_restriction(
-      model, uris, literal, type, sord_iter_get_node(f, SORD_OBJECT));
+      checker, literal, type, sord_iter_get_node(f, SORD_OBJECT));
     sord_iter_free(f);
 
     if (!good) {
@@ -366,7 +733,7 @@ literal_is_valid(SordModel*      model,
   SordIter* s = sord_search(model, type, uris->owl_onDatatype, 0, 0);
   if (s) {
     const SordNode* super = sord_iter_get_node(s, SORD_OBJECT);
-    const bool      good  = literal_is_valid(model, uris, quad, literal, super);
+    const bool      good  = literal_is_valid(checker, quad, literal, super);
     sord_iter_free(s);
     return good; // Match iff literal also matches supertype
   }
@@ -375,12 +742,14 @@ literal_is_valid(SordModel*      model,
 }
 
 static bool
-check_type(SordModel*      model,
-           const URIs*     uris,
+check_type(Checker*        checker,
            const SordQuad  quad,
            const SordNode* node,
            const SordNode* type)
 {
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
+
   if (sord_node_equals(type, uris->rdfs_Resource) ||
       sord_node_equals(type, uris->owl_Thing)) {
     return true;
@@ -392,21 +761,20 @@ check_type(SordModel*      model,
     } else if (sord_node_equals(type, uris->rdf_PlainLiteral)) {
       return !sord_node_get_language(node);
     } else {
-      return literal_is_valid(model, uris, quad, node, type);
+      return literal_is_valid(checker, quad, node, type);
     }
   } else if (sord_node_get_type(node) == SORD_URI) {
     if (sord_node_equals(type, uris->foaf_Document)) {
       return true; // Questionable...
     } else if (is_descendant_of(
-                 model, uris, type, uris->xsd_anyURI, uris->owl_onDatatype)) {
+                 checker, type, uris->xsd_anyURI, uris->owl_onDatatype)) {
       /* Type is any URI and this is a URI, so pass.  Restrictions on
          anyURI subtypes are not currently checked (very uncommon). */
       return true; // Type is anyURI, and this is a URI
     } else {
       SordIter* t = sord_search(model, node, uris->rdf_type, NULL, NULL);
       for (; !sord_iter_end(t); sord_iter_next(t)) {
-        if (is_descendant_of(model,
-                             uris,
+        if (is_descendant_of(checker,
                              sord_iter_get_node(t, SORD_OBJECT),
                              type,
                              uris->rdfs_subClassOf)) {
@@ -436,120 +804,118 @@ count_non_blanks(SordIter* i, SordQuadIndex field)
 }
 
 static int
-check_properties(SordModel* model, URIs* uris)
+check_statement(Checker* checker, const SordQuad quad)
 {
-  int       st = 0;
-  SordIter* i  = sord_begin(model);
-  for (; !sord_iter_end(i); sord_iter_next(i)) {
-    SordQuad quad;
-    sord_iter_get(i, quad);
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
 
-    const SordNode* subj = quad[SORD_SUBJECT];
-    const SordNode* pred = quad[SORD_PREDICATE];
-    const SordNode* obj  = quad[SORD_OBJECT];
-
-    bool      is_any_property = false;
-    SordIter* t = sord_search(model, pred, uris->rdf_type, NULL, NULL);
-    for (; !sord_iter_end(t); sord_iter_next(t)) {
-      if (is_descendant_of(model,
-                           uris,
-                           sord_iter_get_node(t, SORD_OBJECT),
-                           uris->rdf_Property,
-                           uris->rdfs_subClassOf)) {
-        is_any_property = true;
-        break;
-      }
-    }
-    sord_iter_free(t);
+  int st = 0;
 
-    const bool is_ObjectProperty =
-      sord_ask(model, pred, uris->rdf_type, uris->owl_ObjectProperty, 0);
-    const bool is_FunctionalProperty =
-      sord_ask(model, pred, uris->rdf_type, uris->owl_FunctionalProperty, 0);
-    const bool is_InverseFunctionalProperty = sord_ask(
-      model, pred, uris->rdf_type, uris->owl_InverseFunctionalProperty, 0);
-    const bool is_DatatypeProperty =
-      sord_ask(model, pred, uris->rdf_type, uris->owl_DatatypeProperty, 0);
+  const SordNode* subj = quad[SORD_SUBJECT];
+  const SordNode* pred = quad[SORD_PREDICATE];
+  const SordNode* obj  = quad[SORD_OBJECT];
 
-    if (!is_any_property) {
-      st = errorf(quad, "Use of undefined property");
-    }
+  const Property* const prop = get_property(checker, pred);
+  if (!prop) {
+    return errorf(checker, quad, "Failed to allocate property");
+  }
 
-    if (!sord_ask(model, pred, uris->rdfs_label, NULL, NULL)) {
-      st =
-        errorf(quad, "Property <%s> has no label", sord_node_get_string(pred));
-    }
+  if (!prop->is_any_property) {
+    st = errorf(checker, quad, "Use of undefined property");
+  }
 
-    if (is_DatatypeProperty && sord_node_get_type(obj) != SORD_LITERAL) {
-      st = errorf(quad, "Datatype property with non-literal value");
-    }
+  if (!prop->has_label) {
+    st = errorf(
+      checker, quad, "Property <%s> has no label", sord_node_get_string(pred));
+  }
 
-    if (is_ObjectProperty && sord_node_get_type(obj) == SORD_LITERAL) {
-      st = errorf(quad, "Object property with literal value");
-    }
+  if (prop->is_DatatypeProperty && sord_node_get_type(obj) != SORD_LITERAL) {
+    st = errorf(checker, quad, "Datatype property with non-literal value");
+  }
 
-    if (is_FunctionalProperty) {
-      SordIter*      o = sord_search(model, subj, pred, NULL, NULL);
-      const uint64_t n = count_non_blanks(o, SORD_OBJECT);
-      if (n > 1) {
-        st = errorf(quad, "Functional property with %" PRIu64 " objects", n);
-      }
-      sord_iter_free(o);
-    }
+  if (prop->is_ObjectProperty && sord_node_get_type(obj) == SORD_LITERAL) {
+    st = errorf(checker, quad, "Object property with literal value");
+  }
 
-    if (is_InverseFunctionalProperty) {
-      SordIter*      s = sord_search(model, NULL, pred, obj, NULL);
-      const uint64_t n = count_non_blanks(s, SORD_SUBJECT);
-      if (n > 1) {
-        st = errorf(
-          quad, "Inverse functional property with %" PRIu64 " subjects", n);
-      }
-      sord_iter_free(s);
+  if (prop->is_FunctionalProperty) {
+    SordIter*      o = sord_search(model, subj, pred, NULL, NULL);
+    const uint64_t n = count_non_blanks(o, SORD_OBJECT);
+    if (n > 1) {
+      st = errorf(
+        checker, quad, "Functional property with %" PRIu64 " objects", n);
     }
+    sord_iter_free(o);
+  }
 
-    if (sord_node_equals(pred, uris->rdf_type) &&
-        !sord_ask(model, obj, uris->rdf_type, uris->rdfs_Class, NULL) &&
-        !sord_ask(model, obj, uris->rdf_type, uris->owl_Class, NULL)) {
-      st = errorf(quad, "Type is not a rdfs:Class or owl:Class");
+  if (prop->is_InverseFunctionalProperty) {
+    SordIter*      s = sord_search(model, NULL, pred, obj, NULL);
+    const uint64_t n = count_non_blanks(s, SORD_SUBJECT);
+    if (n > 1) {
+      st = errorf(checker,
+                  quad,
+                  "Inverse functional property with %" PRIu64 " subjects",
+                  n);
     }
+    sord_iter_free(s);
+  }
 
-    if (sord_node_get_type(obj) == SORD_LITERAL &&
-        !literal_is_valid(
-          model, uris, quad, obj, sord_node_get_datatype(obj))) {
-      st = errorf(quad, "Literal does not match datatype");
-    }
+  if (sord_node_equals(pred, uris->rdf_type) &&
+      !sord_ask(model, obj, uris->rdf_type, uris->rdfs_Class, NULL) &&
+      !sord_ask(model, obj, uris->rdf_type, uris->owl_Class, NULL)) {
+    st = errorf(checker, quad, "Type is not a rdfs:Class or owl:Class");
+  }
 
-    SordIter* r = sord_search(model, pred, uris->rdfs_range, NULL, NULL);
-    for (; !sord_iter_end(r); sord_iter_next(r)) {
-      const SordNode* range = sord_iter_get_node(r, SORD_OBJECT);
-      if (!check_type(model, uris, quad, obj, range)) {
-        st = errorf(
-          quad, "Object not in range <%s>\n", sord_node_get_string(range));
-      }
+  if (sord_node_get_type(obj) == SORD_LITERAL &&
+      !literal_is_valid(checker, quad, obj, sord_node_get_datatype(obj))) {
+    st = errorf(checker, quad, "Literal does not match datatype");
+  }
+
+  for (size_t r = 0U; r < prop->n_ranges; ++r) {
+    const SordNode* range = prop->ranges[r];
+    if (!check_type(checker, quad, obj, range)) {
+      st = errorf(checker,
+                  quad,
+                  "Object not in range <%s>\n",
+                  sord_node_get_string(range));
     }
-    sord_iter_free(r);
+  }
 
-    SordIter* d = sord_search(model, pred, uris->rdfs_domain, NULL, NULL);
-    if (d) {
-      const SordNode* domain = sord_iter_get_node(d, SORD_OBJECT);
-      if (!check_type(model, uris, quad, subj, domain)) {
-        st = errorf(
-          quad, "Subject not in domain <%s>", sord_node_get_string(domain));
-      }
-      sord_iter_free(d);
+  if (prop->domain) {
+    const SordNode* domain = prop->domain;
+    if (!check_type(checker, quad, subj, domain)) {
+      st = errorf(checker,
+                  quad,
+                  "Subject not in domain <%s>",
+                  sord_node_get_string(domain));
     }
   }
+
+  return st;
+}
+
+static int
+check_properties(Checker* checker)
+{
+  int       st = 0;
+  SordIter* i  = sord_begin(checker->model);
+  for (; !sord_iter_end(i); sord_iter_next(i)) {
+    SordQuad quad;
+    sord_iter_get(i, quad);
+    st = check_statement(checker, quad) || st;
+  }
   sord_iter_free(i);
 
   return st;
 }
 
 static int
-check_instance(SordModel*      model,
-               const URIs*     uris,
+check_instance(Checker*        checker,
                const SordNode* restriction,
                const SordQuad  quad)
 {
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
+
   const SordNode* instance = quad[SORD_SUBJECT];
   int             st       = 0;
 
@@ -568,7 +934,8 @@ check_instance(SordModel*      model,
   if (card) {
     const unsigned c = (unsigned)atoi((const char*)sord_node_get_string(card));
     if (values != c) {
-      st = errorf(quad,
+      st = errorf(checker,
+                  quad,
                   "Property %s on %s has %u != %u values",
                   sord_node_get_string(prop),
                   sord_node_get_string(instance),
@@ -584,7 +951,8 @@ check_instance(SordModel*      model,
     const unsigned m =
       (unsigned)atoi((const char*)sord_node_get_string(minCard));
     if (values < m) {
-      st = errorf(quad,
+      st = errorf(checker,
+                  quad,
                   "Property %s on %s has %u < %u values",
                   sord_node_get_string(prop),
                   sord_node_get_string(instance),
@@ -600,7 +968,8 @@ check_instance(SordModel*      model,
     const unsigned m =
       (unsigned)atoi((const char*)sord_node_get_string(maxCard));
     if (values < m) {
-      st = errorf(quad,
+      st = errorf(checker,
+                  quad,
                   "Property %s on %s has %u > %u values",
                   sord_node_get_string(prop),
                   sord_node_get_string(instance),
@@ -619,13 +988,14 @@ check_instance(SordModel*      model,
     bool      found = false;
     for (; !sord_iter_end(v); sord_iter_next(v)) {
       const SordNode* value = sord_iter_get_node(v, SORD_OBJECT);
-      if (check_type(model, uris, quad, value, type)) {
+      if (check_type(checker, quad, value, type)) {
         found = true;
         break;
       }
     }
     if (!found) {
-      st = errorf(quad,
+      st = errorf(checker,
+                  quad,
                   "%s has no <%s> values of type <%s>\n",
                   sord_node_get_string(instance),
                   sord_node_get_string(prop),
@@ -639,17 +1009,19 @@ check_instance(SordModel*      model,
 }
 
 static int
-check_class_instances(SordModel*      model,
-                      const URIs*     uris,
+check_class_instances(Checker*        checker,
                       const SordNode* restriction,
                       const SordNode* klass)
 {
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
+
   // Check immediate instances of this class
   SordIter* i = sord_search(model, NULL, uris->rdf_type, klass, NULL);
   for (; !sord_iter_end(i); sord_iter_next(i)) {
     SordQuad quad;
     sord_iter_get(i, quad);
-    check_instance(model, uris, restriction, quad);
+    check_instance(checker, restriction, quad);
   }
   sord_iter_free(i);
 
@@ -657,40 +1029,254 @@ check_class_instances(SordModel*      model,
   SordIter* s = sord_search(model, NULL, uris->rdfs_subClassOf, klass, NULL);
   for (; !sord_iter_end(s); sord_iter_next(s)) {
     const SordNode* subklass = sord_iter_get_node(s, SORD_SUBJECT);
-    check_class_instances(model, uris, restriction, subklass);
+    check_class_instances(checker, restriction, subklass);
   }
   sord_iter_free(s);
 
   return 0;
 }
 
+static void
+check_restriction_instances(Checker* checker, const SordNode* restriction)
+{
+  SordModel* const  model = checker->model;
+  const URIs* const uris  = checker->uris;
+
+  const SordNode* prop =
+    sord_get(model, restriction, uris->owl_onProperty, NULL, NULL);
+  if (!prop) {
+    return;
+  }
+
+  SordIter* c =
+    sord_search(model, NULL, uris->rdfs_subClassOf, restriction, NULL);
+  for (; !sord_iter_end(c); sord_iter_next(c)) {
+    const SordNode* klass = sord_iter_get_node(c, SORD_SUBJECT);
+    check_class_instances(checker, restriction, klass);
+  }
+  sord_iter_free(c);
+}
+
 static int
-check_instances(SordModel* model, const URIs* uris)
+check_instances(Checker* checker)
 {
+  const URIs* const uris = checker->uris;
+
   int       st = 0;
+  SordIter* r  = sord_search(
+    checker->model, NULL, uris->rdf_type, uris->owl_Restriction, NULL);
+  for (; !sord_iter_end(r); sord_iter_next(r)) {
+    check_restriction_instances(checker, sord_iter_get_node(r, SORD_SUBJECT));
+  }
+  sord_iter_free(r);
+
+  return st;
+}
+
+/// The number of work items in each chunk claimed by a checking thread
+#define CHUNK_SIZE 256U
+
+/// Return the number of chunks needed for `n` work items
+static size_t
+count_chunks(const size_t n)
+{
+  return (n + CHUNK_SIZE - 1U) / CHUNK_SIZE;
+}
+
+/**
+   A thread that checks chunks of statements, then chunks of restrictions.
+
+   Threads claim the next unchecked chunk from a shared counter, so a thread
+   that finishes quickly takes more chunks.  The output of each chunk is
+   written to a separate buffer, so it can be printed in the same order as
+   when checking on a single thread.
+*/
+typedef struct {
+  Checker          checker;
+  SordQuad*        quads;
+  size_t           n_quads;
+  const SordNode** restrictions;
+  size_t           n_restrictions;
+  Output*          outputs;
+  size_t*          next_chunk;
+  int              st;
+} CheckThread;
+
+static ZixThreadResult ZIX_THREAD_FUNC
+check_thread(void* const arg)
+{
+  CheckThread* const thread        = (CheckThread*)arg;
+  Checker* const     checker       = &thread->checker;
+  const size_t       n_quad_chunks = count_chunks(thread->n_quads);
+  const size_t       n_chunks =
+    n_quad_chunks + count_chunks(thread->n_restrictions);
+
+  size_t c = SORD_ATOMIC_INCREMENT(thread->next_chunk) - 1U;
+  for (; c < n_chunks; c = SORD_ATOMIC_INCREMENT(thread->next_chunk) - 1U) {
+    checker->out = &thread->outputs[c];
+    if (c < n_quad_chunks) {
+      const size_t end = c * CHUNK_SIZE + CHUNK_SIZE;
+      for (size_t i = c * CHUNK_SIZE; i < end && i < thread->n_quads; ++i) {
+        thread->st = check_statement(checker, thread->quads[i]) || thread->st;
+      }
+    } else {
+      const size_t begin = (c - n_quad_chunks) * CHUNK_SIZE;
+      const size_t end   = begin + CHUNK_SIZE;
+      for (size_t i = begin; i < end && i < thread->n_restrictions; ++i) {
+        check_restriction_instances(checker, thread->restrictions[i]);
+      }
+    }
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+/**
+   Check a model like check_properties() and check_instances() on threads.
+
+   @return The status of checking, or -1 if nothing was checked because
+   memory couldn't be allocated.
+*/
+static int
+check_in_parallel(Checker* const result, const unsigned n_threads)
+{
+  SordModel* const  model = result->model;
+  const URIs* const uris  = result->uris;
+
+  const size_t n_quads = sord_num_quads(model);
+  const size_t n_restrictions =
+    sord_count(model, NULL, uris->rdf_type, uris->owl_Restriction, NULL);
+  const size_t max_chunks =
+    count_chunks(n_quads) + count_chunks(n_restrictions);
+
+  SordQuad* const quads = (SordQuad*)calloc(n_quads + 1U, sizeof(SordQuad));
+  const SordNode** const restrictions =
+    (const SordNode**)calloc(n_restrictions + 1U, sizeof(SordNode*));
+  Output* const outputs = (Output*)calloc(max_chunks + 1U, sizeof(Output));
+  CheckThread* const threads =
+    (CheckThread*)calloc(n_threads, sizeof(CheckThread));
+  ZixThread* const handles = (ZixThread*)calloc(n_threads, sizeof(ZixThread));
+  bool* const      started = (bool*)calloc(n_threads, sizeof(bool));
+  if (!quads || !restrictions || !outputs || !threads || !handles ||
+      !started) {
+    free(started);
+    free(handles);
+    free(threads);
+    free(outputs);
+    free(restrictions);
+    free(quads);
+    return -1;
+  }
+
+  // Gather the statements and restrictions to check, in the serial order
+  size_t    n = 0U;
+  SordIter* i = sord_begin(model);
+  for (; n < n_quads && !sord_iter_end(i); sord_iter_next(i)) {
+    sord_iter_get(i, quads[n++]);
+  }
+  sord_iter_free(i);
+
+  size_t    n_r = 0U;
   SordIter* r =
     sord_search(model, NULL, uris->rdf_type, uris->owl_Restriction, NULL);
-  for (; !sord_iter_end(r); sord_iter_next(r)) {
-    const SordNode* restriction = sord_iter_get_node(r, SORD_SUBJECT);
-    const SordNode* prop =
-      sord_get(model, restriction, uris->owl_onProperty, NULL, NULL);
-    if (!prop) {
-      continue;
+  for (; n_r < n_restrictions && !sord_iter_end(r); sord_iter_next(r)) {
+    restrictions[n_r++] = sord_iter_get_node(r, SORD_SUBJECT);
+  }
+  sord_iter_free(r);
+
+  size_t next_chunk = 0U;
+  for (unsigned t = 0U; t < n_threads; ++t) {
+    threads[t].checker.model  = model;
+    threads[t].checker.uris   = uris;
+    threads[t].quads          = quads;
+    threads[t].n_quads        = n;
+    threads[t].restrictions   = restrictions;
+    threads[t].n_restrictions = n_r;
+    threads[t].outputs        = outputs;
+    threads[t].next_chunk     = &next_chunk;
+    started[t] = !zix_thread_create(&handles[t], 0U, check_thread, &threads[t]);
+  }
+
+  // Join threads (checking here if one failed to start) and merge results
+  int st = 0;
+  for (unsigned t = 0U; t < n_threads; ++t) {
+    if (started[t]) {
+      zix_thread_join(handles[t]);
+    } else {
+      check_thread(&threads[t]);
     }
 
-    SordIter* c =
-      sord_search(model, NULL, uris->rdfs_subClassOf, restriction, NULL);
-    for (; !sord_iter_end(c); sord_iter_next(c)) {
-      const SordNode* klass = sord_iter_get_node(c, SORD_SUBJECT);
-      check_class_instances(model, uris, restriction, klass);
+    result->n_errors += threads[t].checker.n_errors;
+    result->n_restrictions += threads[t].checker.n_restrictions;
+    st = st || threads[t].st;
+    free_checker(&threads[t].checker);
+  }
+
+  // Print the output of every chunk in order
+  const size_t n_chunks = count_chunks(n) + count_chunks(n_r);
+  for (size_t c = 0U; c < n_chunks; ++c) {
+    if (outputs[c].buf) {
+      fwrite(outputs[c].buf, 1U, outputs[c].len, stderr);
+      free(outputs[c].buf);
     }
-    sord_iter_free(c);
   }
-  sord_iter_free(r);
 
+  free(started);
+  free(handles);
+  free(threads);
+  free(outputs);
+  free(restrictions);
+  free(quads);
   return st;
 }
 
+static void
+load_in_parallel(SordModel*   model,
+                 SerdEnv*     env,
+                 const int    n_inputs,
+                 char** const inputs,
+                 unsigned     n_jobs)
+{
+  const size_t n_files  = (size_t)n_inputs;
+  char** const paths    = (char**)calloc(n_files, sizeof(char*));
+  SerdStatus*  statuses = (SerdStatus*)calloc(n_files, sizeof(SerdStatus));
+  size_t       n_paths  = 0U;
+
+  for (size_t i = 0U; i < n_files; ++i) {
+    const uint8_t* input       = (const uint8_t*)inputs[i];
+    uint8_t*       rel_in_path = serd_file_uri_parse(input, NULL);
+    char*          in_path     = zix_canonical_path(NULL, (char*)rel_in_path);
+
+    free(rel_in_path);
+    if (!in_path) {
+      fprintf(stderr, "Skipping file %s\n", input);
+      continue;
+    }
+
+    paths[n_paths++] = in_path;
+  }
+
+  sord_load_files(model,
+                  env,
+                  SERD_TURTLE,
+                  n_paths,
+                  (const uint8_t* const*)paths,
+                  n_jobs,
+                  statuses);
+
+  for (size_t i = 0U; i < n_paths; ++i) {
+    if (statuses[i]) {
+      fprintf(
+        stderr, "error reading %s: %s\n", paths[i], serd_strerror(statuses[i]));
+    }
+
+    zix_free(NULL, paths[i]);
+  }
+
+  free(statuses);
+  free(paths);
+}
+
 int
 main(int argc, char** argv)
 {
@@ -698,10 +1284,18 @@ main(int argc, char** argv)
     return print_usage(argv[0], true);
   }
 
-  int a = 1;
+  unsigned n_jobs = 1U;
+  int      a      = 1;
   for (; a < argc && argv[a][0] == '-'; ++a) {
     if (argv[a][1] == 'h') {
       return print_usage(argv[0], false);
+    } else if (argv[a][1] == 'j') {
+      const int n = (++a < argc) ? atoi(argv[a]) : 0;
+      if (n < 1) {
+        fprintf(stderr, "%s: Option `-j' requires a positive count\n", argv[0]);
+        return print_usage(argv[0], true);
+      }
+      n_jobs = (unsigned)n;
     } else if (argv[a][1] == 'l') {
       one_line_errors = true;
     } else if (argv[a][1] == 'v') {
@@ -712,11 +1306,18 @@ main(int argc, char** argv)
     }
   }
 
-  SordWorld*  world  = sord_world_new();
-  SordModel*  model  = sord_new(world, SORD_SPO | SORD_OPS, false);
-  SerdEnv*    env    = serd_env_new(&SERD_NODE_NULL);
-  SerdReader* reader = sord_new_reader(model, env, SERD_TURTLE, NULL);
+  const int   n_files = argc - a;
+  SordWorld*  world   = sord_world_new_with_options(SORD_WORLD_ARENA);
+  SordModel*  model   = sord_new(world, SORD_SPO | SORD_OPS, false);
+  SerdEnv*    env     = serd_env_new(&SERD_NODE_NULL);
+  SerdReader* reader  = sord_new_reader(model, env, SERD_TURTLE, NULL);
+
+  if (n_jobs > 1U) {
+    load_in_parallel(model, env, n_files, argv + a, n_jobs);
+    a = argc;
+  }
 
+  sord_bulk_begin(model);
   for (; a < argc; ++a) {
     const uint8_t* input       = (const uint8_t*)argv[a];
     uint8_t*       rel_in_path = serd_file_uri_parse(input, NULL);
@@ -742,6 +1343,7 @@ main(int argc, char** argv)
     serd_node_free(&base_uri_node);
     zix_free(NULL, in_path);
   }
+  sord_bulk_commit(model);
   serd_reader_free(reader);
   serd_env_free(env);
 
@@ -791,15 +1393,27 @@ main(int argc, char** argv)
   fprintf(stderr, "warning: Built without PCRE2, datatypes not checked.\n");
 #endif
 
-  const int prop_st = check_properties(model, &uris);
-  const int inst_st = check_instances(model, &uris);
+  Checker checker;
+  memset(&checker, 0, sizeof(checker));
+  checker.model = model;
+  checker.uris  = &uris;
+
+  // Check on threads if requested, and on this one if that isn't possible
+  int st = (n_jobs > 1U) ? check_in_parallel(&checker, n_jobs) : -1;
+  if (st < 0) {
+    const int prop_st = check_properties(&checker);
+    const int inst_st = check_instances(&checker);
+    st                = prop_st || inst_st;
+  }
 
   printf("Found %d errors among %d files (checked %d restrictions)\n",
-         n_errors,
-         argc - 1,
-         n_restrictions);
+         checker.n_errors,
+         n_files,
+         checker.n_restrictions);
+
+  free_checker(&checker);
 
   sord_free(model);
   sord_world_free(world);
-  return prop_st || inst_st;
+  return st;
 }
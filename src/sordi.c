@@ -48,6 +48,7 @@ print_usage(const char* name, bool error)
   fprintf(os, "  -i SYNTAX  Input syntax (`turtle' or `ntriples')\n");
   fprintf(os, "  -o SYNTAX  Output syntax (`turtle' or `ntriples')\n");
   fprintf(os, "  -s INPUT   Parse INPUT as string (terminates options)\n");
+  fprintf(os, "  -S         Stream statements without loading a model\n");
   fprintf(os, "  -v         Display version information and exit\n");
   return error ? 1 : 0;
 }
@@ -77,6 +78,7 @@ main(int argc, char** argv)
   SerdSyntax     input_syntax  = SERD_TURTLE;
   SerdSyntax     output_syntax = SERD_NTRIPLES;
   bool           from_file     = true;
+  bool           stream        = false;
   const uint8_t* in_name       = NULL;
   int            a             = 1;
   for (; a < argc && argv[a][0] == '-'; ++a) {
@@ -93,6 +95,8 @@ main(int argc, char** argv)
       from_file = false;
       ++a;
       break;
+    } else if (argv[a][1] == 'S') {
+      stream = true;
     } else if (argv[a][1] == 'i') {
       if (++a == argc) {
         SORDI_ERROR("option requires an argument -- 'i'\n\n");
@@ -147,17 +151,6 @@ main(int argc, char** argv)
     zix_free(NULL, abs_path);
   }
 
-  SordWorld*  world  = sord_world_new();
-  SordModel*  sord   = sord_new(world, SORD_SPO | SORD_OPS, false);
-  SerdEnv*    env    = serd_env_new(&base);
-  SerdReader* reader = sord_new_reader(sord, env, input_syntax, NULL);
-
-  SerdStatus status = (from_file)
-                        ? serd_reader_read_file_handle(reader, in_fd, in_name)
-                        : serd_reader_read_string(reader, input);
-
-  serd_reader_free(reader);
-
   FILE*    out_fd    = stdout;
   SerdEnv* write_env = serd_env_new(&base);
 
@@ -175,23 +168,54 @@ main(int argc, char** argv)
                                        serd_file_sink,
                                        stdout);
 
-  // Write @prefix directives
-  serd_env_foreach(env, (SerdPrefixSink)serd_writer_set_prefix, writer);
+  SerdStatus status = SERD_SUCCESS;
+  if (stream) {
+    // Pass statements straight through, anonymous nodes are kept inline
+    SerdReader* reader =
+      serd_reader_new(input_syntax,
+                      writer,
+                      NULL,
+                      (SerdBaseSink)serd_writer_set_base_uri,
+                      (SerdPrefixSink)serd_writer_set_prefix,
+                      (SerdStatementSink)serd_writer_write_statement,
+                      (SerdEndSink)serd_writer_end_anon);
+
+    status = (from_file) ? serd_reader_read_file_handle(reader, in_fd, in_name)
+                         : serd_reader_read_string(reader, input);
+
+    serd_reader_free(reader);
+  } else {
+    SordWorld*  world  = sord_world_new_with_options(SORD_WORLD_ARENA);
+    SordModel*  sord   = sord_new(world, SORD_SPO | SORD_OPS, false);
+    SerdEnv*    env    = serd_env_new(&base);
+    SerdReader* reader = sord_new_reader(sord, env, input_syntax, NULL);
+
+    sord_bulk_begin(sord);
+
+    status = (from_file) ? serd_reader_read_file_handle(reader, in_fd, in_name)
+                         : serd_reader_read_string(reader, input);
 
-  // Write statements
-  sord_write(sord, writer, NULL);
+    sord_bulk_commit(sord);
+    serd_reader_free(reader);
+
+    // Write @prefix directives
+    serd_env_foreach(env, (SerdPrefixSink)serd_writer_set_prefix, writer);
+
+    // Write statements
+    sord_write(sord, writer, NULL);
+
+    serd_env_free(env);
+    sord_free(sord);
+    sord_world_free(world);
+  }
 
   serd_writer_finish(writer);
   serd_writer_free(writer);
 
-  serd_env_free(env);
   serd_env_free(write_env);
   serd_node_free(&base);
   free(input_path);
 
-  sord_free(sord);
-  sord_world_free(world);
-
   if (from_file) {
     fclose(in_fd);
   }
@@ -3,10 +3,34 @@
 
 #include <sord/sordmm.hpp>
 
+#include <utility>
+
 int
 main()
 {
   Sord::World world;
   Sord::Model model(world, "http://example.org/");
-  return 0;
+
+  Sord::URI  s(world, "http://example.org/s");
+  Sord::URI  p(world, "http://example.org/p");
+  Sord::Node o = Sord::Literal(world, "o");
+  Sord::Node moved(std::move(o));
+  o = std::move(moved);
+
+  const SordQuad quads[] = {{s.c_obj(), p.c_obj(), o.c_obj(), nullptr}};
+  model.add_statements(quads, 1U);
+
+  size_t n_statements = 0U;
+  for (const Sord::StatementView statement : model.match(s.view())) {
+    if (statement.object != o.view() || !statement.object.is_literal()) {
+      return 1;
+    }
+    ++n_statements;
+  }
+
+  for (const Sord::StatementView statement : model.all()) {
+    n_statements -= statement.subject == s ? 1U : 0U;
+  }
+
+  return n_statements ? 1 : 0;
 }
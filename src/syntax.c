@@ -1,23 +1,97 @@
 // Copyright 2011-2015 David Robillard <d@drobilla.net>
 // SPDX-License-Identifier: ISC
 
+#include "sord_internal.h"
+
 #include <serd/serd.h>
 #include <sord/sord.h>
+#include <zix/thread.h>
 
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+/// The last node written in some position, to avoid interning it repeatedly
+typedef struct {
+  SerdNode  key;  ///< Copy of the node as written to the inserter
+  SordNode* node; ///< Interned node for `key`, which holds a reference
+} SordInserterCache;
+
 struct SordInserterImpl {
-  SordModel* model;
-  SerdEnv*   env;
+  SordModel*        model;
+  SerdEnv*          env;
+  SordInserterCache graph;
+  SordInserterCache subject;
+  SordInserterCache predicate;
+  SordQuad*         buffer;
+  size_t            n_buffered;
+  size_t            buffer_size;
 };
 
+static void
+sord_inserter_clear_cache(SordWorld* world, SordInserterCache* cache)
+{
+  serd_node_free(&cache->key);
+  sord_node_free(world, cache->node);
+  cache->node = NULL;
+}
+
+static void
+sord_inserter_clear_caches(SordInserter* inserter)
+{
+  SordWorld* const world = sord_get_world(inserter->model);
+
+  sord_inserter_clear_cache(world, &inserter->graph);
+  sord_inserter_clear_cache(world, &inserter->subject);
+  sord_inserter_clear_cache(world, &inserter->predicate);
+}
+
+/**
+   Return the interned node for `node`, using the cached node if it's the same.
+
+   Relative URIs aren't cached, since they depend on the base URI of the
+   environment, which may be changed without going through the inserter.
+   The returned node is borrowed from the cache if `node` is cacheable,
+   otherwise it is a new reference which `*owned` is set to.
+*/
+static SordNode*
+sord_inserter_intern(SordInserter*      inserter,
+                     SordInserterCache* cache,
+                     const SerdNode*    node,
+                     SordNode**         owned)
+{
+  if (!node || !node->buf) {
+    return NULL;
+  }
+
+  if (cache->node && serd_node_equals(&cache->key, node)) {
+    return cache->node;
+  }
+
+  SordWorld* const world = sord_get_world(inserter->model);
+  SordNode* const  ret =
+    sord_node_from_serd_node(world, inserter->env, node, NULL, NULL);
+
+  const bool relative =
+    node->type == SERD_URI && !serd_uri_string_has_scheme(node->buf);
+
+  if (ret && !relative) {
+    sord_inserter_clear_cache(world, cache);
+    cache->key  = serd_node_copy(node);
+    cache->node = ret;
+  } else {
+    *owned = ret;
+  }
+
+  return ret;
+}
+
 SordInserter*
 sord_inserter_new(SordModel* model, SerdEnv* env)
 {
-  SordInserter* inserter = (SordInserter*)malloc(sizeof(SordInserter));
+  SordInserter* inserter = (SordInserter*)calloc(1, sizeof(SordInserter));
   inserter->model        = model;
   inserter->env          = env;
   return inserter;
@@ -26,7 +100,42 @@ sord_inserter_new(SordModel* model, SerdEnv* env)
 void
 sord_inserter_free(SordInserter* inserter)
 {
-  free(inserter);
+  if (inserter) {
+    sord_inserter_flush(inserter);
+    sord_inserter_clear_caches(inserter);
+    free(inserter->buffer);
+    free(inserter);
+  }
+}
+
+void
+sord_inserter_set_buffer_size(SordInserter* inserter, size_t size)
+{
+  sord_inserter_flush(inserter);
+
+  free(inserter->buffer);
+  inserter->buffer      = NULL;
+  inserter->buffer_size = 0U;
+  if (size) {
+    inserter->buffer      = (SordQuad*)calloc(size, sizeof(SordQuad));
+    inserter->buffer_size = inserter->buffer ? size : 0U;
+  }
+}
+
+void
+sord_inserter_flush(SordInserter* inserter)
+{
+  SordWorld* const world = sord_get_world(inserter->model);
+
+  sord_add_batch(inserter->model, inserter->buffer, inserter->n_buffered);
+
+  for (size_t i = 0U; i < inserter->n_buffered; ++i) {
+    for (unsigned t = 0U; t < 4U; ++t) {
+      sord_node_free(world, (SordNode*)inserter->buffer[i][t]);
+    }
+  }
+
+  inserter->n_buffered = 0U;
 }
 
 SerdStatus
@@ -40,6 +149,9 @@ sord_inserter_set_prefix(SordInserter*   inserter,
                          const SerdNode* name,
                          const SerdNode* uri)
 {
+  // Cached CURIEs may no longer expand to the same URI
+  sord_inserter_clear_caches(inserter);
+
   return serd_env_set_prefix(inserter->env, name, uri);
 }
 
@@ -58,25 +170,43 @@ sord_inserter_write_statement(SordInserter*      inserter,
   SordWorld* world = sord_get_world(inserter->model);
   SerdEnv*   env   = inserter->env;
 
-  SordNode* g = sord_node_from_serd_node(world, env, graph, NULL, NULL);
-  SordNode* s = sord_node_from_serd_node(world, env, subject, NULL, NULL);
-  SordNode* p = sord_node_from_serd_node(world, env, predicate, NULL, NULL);
+  SordNode* owned_g = NULL;
+  SordNode* owned_s = NULL;
+  SordNode* owned_p = NULL;
+
+  SordNode* g =
+    sord_inserter_intern(inserter, &inserter->graph, graph, &owned_g);
+  SordNode* s =
+    sord_inserter_intern(inserter, &inserter->subject, subject, &owned_s);
+  SordNode* p =
+    sord_inserter_intern(inserter, &inserter->predicate, predicate, &owned_p);
   SordNode* o =
     sord_node_from_serd_node(world, env, object, object_datatype, object_lang);
 
-  if (!s || !p || !o) {
-    return SERD_ERR_BAD_ARG;
-  }
+  SerdStatus st = SERD_ERR_BAD_ARG;
+  if (s && p && o && inserter->buffer_size) {
+    SordQuad* const tup = &inserter->buffer[inserter->n_buffered];
 
-  const SordQuad tup = {s, p, o, g};
-  sord_add(inserter->model, tup);
+    (*tup)[SORD_SUBJECT]   = sord_node_copy(s);
+    (*tup)[SORD_PREDICATE] = sord_node_copy(p);
+    (*tup)[SORD_OBJECT]    = sord_node_copy(o);
+    (*tup)[SORD_GRAPH]     = sord_node_copy(g);
+    if (++inserter->n_buffered == inserter->buffer_size) {
+      sord_inserter_flush(inserter);
+    }
+    st = SERD_SUCCESS;
+  } else if (s && p && o) {
+    const SordQuad tup = {s, p, o, g};
+    sord_add(inserter->model, tup);
+    st = SERD_SUCCESS;
+  }
 
   sord_node_free(world, o);
-  sord_node_free(world, p);
-  sord_node_free(world, s);
-  sord_node_free(world, g);
+  sord_node_free(world, owned_p);
+  sord_node_free(world, owned_s);
+  sord_node_free(world, owned_g);
 
-  return SERD_SUCCESS;
+  return st;
 }
 
 SORD_API SerdReader*
@@ -103,6 +233,291 @@ sord_new_reader(SordModel* model,
   return reader;
 }
 
+/// A statement parsed by a loader worker, with its nodes fully expanded
+typedef struct {
+  SerdNode graph;
+  SerdNode subject;
+  SerdNode predicate;
+  SerdNode object;
+  SerdNode object_datatype;
+  SerdNode object_lang;
+} SordLoadStatement;
+
+/// The parsed contents of one input file
+typedef struct {
+  SerdEnv*           env;
+  SordLoadStatement* statements;
+  size_t             n_statements;
+  size_t             buf_size;
+  SerdStatus         status;
+} SordLoadFile;
+
+/// A worker which parses every `stride`th file starting at `first`
+typedef struct {
+  const uint8_t* const* paths;
+  SordLoadFile*         files;
+  size_t                n_files;
+  size_t                first;
+  size_t                stride;
+  SerdSyntax            syntax;
+} SordLoadWorker;
+
+static SerdStatus
+load_set_base_uri(SordLoadFile* file, const SerdNode* uri)
+{
+  return serd_env_set_base_uri(file->env, uri);
+}
+
+static SerdStatus
+load_set_prefix(SordLoadFile* file, const SerdNode* name, const SerdNode* uri)
+{
+  return serd_env_set_prefix(file->env, name, uri);
+}
+
+static SerdNode
+load_copy_node(const SerdEnv* env, const SerdNode* node)
+{
+  if (!node) {
+    return SERD_NODE_NULL;
+  }
+
+  if (node->type == SERD_URI || node->type == SERD_CURIE) {
+    return serd_env_expand_node(env, node);
+  }
+
+  return serd_node_copy(node);
+}
+
+static void
+load_free_statement(SordLoadStatement* statement)
+{
+  serd_node_free(&statement->graph);
+  serd_node_free(&statement->subject);
+  serd_node_free(&statement->predicate);
+  serd_node_free(&statement->object);
+  serd_node_free(&statement->object_datatype);
+  serd_node_free(&statement->object_lang);
+}
+
+static SerdStatus
+load_write_statement(SordLoadFile*      file,
+                     SerdStatementFlags flags,
+                     const SerdNode*    graph,
+                     const SerdNode*    subject,
+                     const SerdNode*    predicate,
+                     const SerdNode*    object,
+                     const SerdNode*    object_datatype,
+                     const SerdNode*    object_lang)
+{
+  (void)flags;
+
+  if (file->n_statements == file->buf_size) {
+    const size_t new_size = file->buf_size ? file->buf_size * 2U : 256U;
+
+    SordLoadStatement* const new_statements = (SordLoadStatement*)realloc(
+      file->statements, new_size * sizeof(SordLoadStatement));
+    if (!new_statements) {
+      return SERD_ERR_INTERNAL;
+    }
+
+    file->statements = new_statements;
+    file->buf_size   = new_size;
+  }
+
+  const SerdEnv* const env = file->env;
+  SordLoadStatement    st  = {load_copy_node(env, graph),
+                              load_copy_node(env, subject),
+                              load_copy_node(env, predicate),
+                              load_copy_node(env, object),
+                              load_copy_node(env, object_datatype),
+                              load_copy_node(env, object_lang)};
+
+  if (!st.subject.buf || !st.predicate.buf || !st.object.buf ||
+      (graph && !st.graph.buf) ||
+      (object_datatype && !st.object_datatype.buf)) {
+    load_free_statement(&st);
+    return SERD_ERR_BAD_CURIE;
+  }
+
+  file->statements[file->n_statements++] = st;
+  return SERD_SUCCESS;
+}
+
+static void
+load_file(const uint8_t* path,
+          SordLoadFile*  file,
+          size_t         index,
+          SerdSyntax     syntax)
+{
+  SerdURI  base_uri = SERD_URI_NULL;
+  SerdNode base     = serd_node_new_file_uri(path, NULL, &base_uri, true);
+
+  file->env = serd_env_new(&base);
+
+  SerdReader* const reader =
+    serd_reader_new(syntax,
+                    file,
+                    NULL,
+                    (SerdBaseSink)load_set_base_uri,
+                    (SerdPrefixSink)load_set_prefix,
+                    (SerdStatementSink)load_write_statement,
+                    NULL);
+
+  // Scope blank node labels to this file, as separate readers would clash
+  char blank_prefix[32];
+  snprintf(blank_prefix, sizeof(blank_prefix), "f%zu_", index);
+  serd_reader_add_blank_prefix(reader, (const uint8_t*)blank_prefix);
+
+  file->status = serd_reader_read_file(reader, path);
+
+  serd_reader_free(reader);
+  serd_node_free(&base);
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+load_files_thread(void* const arg)
+{
+  SordLoadWorker* const worker = (SordLoadWorker*)arg;
+
+  for (size_t i = worker->first; i < worker->n_files; i += worker->stride) {
+    load_file(worker->paths[i], &worker->files[i], i, worker->syntax);
+  }
+
+  return ZIX_THREAD_RESULT;
+}
+
+static SerdStatus
+load_merge_file(SordModel* model, SerdEnv* env, SordLoadFile* file)
+{
+  SordWorld* const world = sord_get_world(model);
+  SerdStatus       st    = SERD_SUCCESS;
+
+  for (size_t i = 0U; i < file->n_statements; ++i) {
+    SordLoadStatement* const statement = &file->statements[i];
+
+    SordNode* g =
+      sord_node_from_serd_node(world, env, &statement->graph, NULL, NULL);
+    SordNode* s =
+      sord_node_from_serd_node(world, env, &statement->subject, NULL, NULL);
+    SordNode* p =
+      sord_node_from_serd_node(world, env, &statement->predicate, NULL, NULL);
+    SordNode* o = sord_node_from_serd_node(
+      world,
+      env,
+      &statement->object,
+      statement->object_datatype.buf ? &statement->object_datatype : NULL,
+      statement->object_lang.buf ? &statement->object_lang : NULL);
+
+    if (s && p && o) {
+      const SordQuad tup = {s, p, o, g};
+      sord_add(model, tup);
+    } else if (!st) {
+      st = SERD_ERR_BAD_ARG;
+    }
+
+    sord_node_free(world, o);
+    sord_node_free(world, p);
+    sord_node_free(world, s);
+    sord_node_free(world, g);
+    load_free_statement(statement);
+  }
+
+  // Merge prefixes so the caller can use them for writing
+  serd_env_foreach(file->env, (SerdPrefixSink)serd_env_set_prefix, env);
+
+  free(file->statements);
+  serd_env_free(file->env);
+  return st;
+}
+
+SerdStatus
+sord_load_files(SordModel*            model,
+                SerdEnv*              env,
+                SerdSyntax            syntax,
+                size_t                n_files,
+                const uint8_t* const* paths,
+                unsigned              n_threads,
+                SerdStatus*           statuses)
+{
+  SordLoadFile* const files =
+    (SordLoadFile*)calloc(n_files ? n_files : 1U, sizeof(SordLoadFile));
+  if (!files) {
+    return SERD_ERR_INTERNAL;
+  }
+
+  if (n_threads > n_files) {
+    n_threads = (unsigned)n_files;
+  }
+
+  // Parse files, either on worker threads or in this thread if only one
+  if (n_threads > 1U) {
+    SordLoadWorker* const workers =
+      (SordLoadWorker*)calloc(n_threads, sizeof(SordLoadWorker));
+    ZixThread* const threads = (ZixThread*)calloc(n_threads, sizeof(ZixThread));
+    bool* const      started = (bool*)calloc(n_threads, sizeof(bool));
+
+    for (unsigned t = 0U; t < n_threads; ++t) {
+      const SordLoadWorker worker = {
+        paths, files, n_files, t, n_threads, syntax};
+
+      workers[t] = worker;
+      started[t] =
+        !zix_thread_create(&threads[t], 0U, load_files_thread, &workers[t]);
+    }
+
+    for (unsigned t = 0U; t < n_threads; ++t) {
+      if (started[t]) {
+        zix_thread_join(threads[t]);
+      } else {
+        load_files_thread(&workers[t]);
+      }
+    }
+
+    free(started);
+    free(threads);
+    free(workers);
+  } else {
+    for (size_t i = 0U; i < n_files; ++i) {
+      load_file(paths[i], &files[i], i, syntax);
+    }
+  }
+
+  // Merge in path order here, since interning nodes isn't thread-safe
+  SerdStatus result = SERD_SUCCESS;
+  sord_bulk_begin(model);
+  for (size_t i = 0U; i < n_files; ++i) {
+    const SerdStatus merge_st = load_merge_file(model, env, &files[i]);
+    const SerdStatus st       = files[i].status ? files[i].status : merge_st;
+    if (statuses) {
+      statuses[i] = st;
+    }
+    if (st > SERD_FAILURE && !result) {
+      result = st;
+    }
+  }
+
+  sord_bulk_commit(model);
+  free(files);
+  return result;
+}
+
+/// Return the language of a literal object as a serd node
+static SerdNode
+object_language(const SordNode* o)
+{
+  const char* lang_str = sord_node_get_language(o);
+  size_t      lang_len = lang_str ? strlen(lang_str) : 0;
+  SerdNode    language = SERD_NODE_NULL;
+  if (lang_str) {
+    language.type    = SERD_LITERAL;
+    language.n_bytes = lang_len;
+    language.n_chars = lang_len;
+    language.buf     = (const uint8_t*)lang_str;
+  }
+
+  return language;
+}
+
 static SerdStatus
 write_statement(SordModel*         sord,
                 SerdWriter*        writer,
@@ -118,15 +533,7 @@ write_statement(SordModel*         sord,
   const SerdNode* so = sord_node_to_serd_node(o);
   const SerdNode* sd = sord_node_to_serd_node(d);
 
-  const char* lang_str = sord_node_get_language(o);
-  size_t      lang_len = lang_str ? strlen(lang_str) : 0;
-  SerdNode    language = SERD_NODE_NULL;
-  if (lang_str) {
-    language.type    = SERD_LITERAL;
-    language.n_bytes = lang_len;
-    language.n_chars = lang_len;
-    language.buf     = (const uint8_t*)lang_str;
-  }
+  const SerdNode language = object_language(o);
 
   // TODO: Subject abbreviation
 
@@ -189,3 +596,187 @@ sord_write_iter(SordIter* iter, SerdWriter* writer)
 
   return !st;
 }
+
+/*
+  Parallel writing.
+
+  Quads are read from the model in rounds of up to one chunk for each thread.
+  Each chunk is written to a separate buffer on a worker thread, then the
+  buffers are written to the sink in order before reading the next round.
+*/
+
+/// Number of quads in the chunk written by each thread in a round
+#define SORD_WRITE_CHUNK_SIZE 8192U
+
+/// A growing buffer of written text
+typedef struct {
+  char*  buf;
+  size_t len;
+  size_t size;
+} SordWriteBuffer;
+
+/// A chunk of quads written by a worker thread
+typedef struct {
+  SordQuad*       quads;   ///< Quads to write
+  size_t          n_quads; ///< Number of quads to write
+  SerdSyntax      syntax;  ///< SERD_NTRIPLES or SERD_NQUADS
+  SerdStyle       style;   ///< Writer style
+  SordWriteBuffer output;  ///< Written text
+  SerdStatus      status;  ///< Status of writing
+} SordWriteChunk;
+
+static size_t
+write_buffer_sink(const void* buf, size_t len, void* stream)
+{
+  SordWriteBuffer* const buffer = (SordWriteBuffer*)stream;
+  if (buffer->len + len > buffer->size) {
+    size_t size = buffer->size ? buffer->size : 4096U;
+    while (buffer->len + len > size) {
+      size *= 2U;
+    }
+
+    char* const new_buf = (char*)realloc(buffer->buf, size);
+    if (!new_buf) {
+      return 0U;
+    }
+
+    buffer->buf  = new_buf;
+    buffer->size = size;
+  }
+
+  memcpy(buffer->buf + buffer->len, buf, len);
+  buffer->len += len;
+  return len;
+}
+
+static ZixThreadResult ZIX_THREAD_FUNC
+write_chunk_thread(void* const arg)
+{
+  SordWriteChunk* const chunk = (SordWriteChunk*)arg;
+  SerdEnv* const        env   = serd_env_new(NULL);
+  SerdWriter* const     writer =
+    serd_writer_new(chunk->syntax,
+                    (SerdStyle)(chunk->style | SERD_STYLE_BULK),
+                    env,
+                    NULL,
+                    write_buffer_sink,
+                    &chunk->output);
+
+  // Write every statement flat, since there's no abbreviation anyway
+  const bool with_graph = chunk->syntax == SERD_NQUADS;
+  SerdStatus st         = SERD_SUCCESS;
+  for (size_t i = 0U; !st && i < chunk->n_quads; ++i) {
+    const SordNode** const tup      = chunk->quads[i];
+    const SordNode* const  o        = tup[SORD_OBJECT];
+    const SerdNode         language = object_language(o);
+
+    st = serd_writer_write_statement(
+      writer,
+      0U,
+      with_graph ? sord_node_to_serd_node(tup[SORD_GRAPH]) : NULL,
+      sord_node_to_serd_node(tup[SORD_SUBJECT]),
+      sord_node_to_serd_node(tup[SORD_PREDICATE]),
+      sord_node_to_serd_node(o),
+      sord_node_to_serd_node(sord_node_get_datatype(o)),
+      &language);
+  }
+
+  const SerdStatus finish_st = serd_writer_finish(writer);
+  chunk->status              = st ? st : finish_st;
+
+  serd_writer_free(writer);
+  serd_env_free(env);
+  return ZIX_THREAD_RESULT;
+}
+
+SerdStatus
+sord_write_parallel(SordModel* model,
+                    SerdSyntax syntax,
+                    SerdStyle  style,
+                    SordNode*  graph,
+                    SerdSink   sink,
+                    void*      stream,
+                    unsigned   n_threads)
+{
+  if (syntax != SERD_NTRIPLES && syntax != SERD_NQUADS) {
+    return SERD_ERR_BAD_ARG;
+  }
+
+  n_threads = n_threads ? n_threads : 1U;
+
+  const size_t          n_round = n_threads * (size_t)SORD_WRITE_CHUNK_SIZE;
+  SordQuad* const       quads   = (SordQuad*)calloc(n_round, sizeof(SordQuad));
+  SordWriteChunk* const chunks =
+    (SordWriteChunk*)calloc(n_threads, sizeof(SordWriteChunk));
+  ZixThread* const threads = (ZixThread*)calloc(n_threads, sizeof(ZixThread));
+  bool* const      started = (bool*)calloc(n_threads, sizeof(bool));
+  if (!quads || !chunks || !threads || !started) {
+    free(started);
+    free(threads);
+    free(chunks);
+    free(quads);
+    return SERD_ERR_INTERNAL;
+  }
+
+  // Write every quad of a quad store, but each triple of a triple dump once
+  const SordQuad pat  = {NULL, NULL, NULL, graph};
+  SordIter*      iter = (graph || syntax == SERD_NTRIPLES)
+                          ? sord_find(model, pat)
+                          : sord_begin_all(model);
+
+  SerdStatus st = SERD_SUCCESS;
+  while (!st && !sord_iter_end(iter)) {
+    const size_t n_quads = sord_iter_get_batch(iter, quads, n_round);
+
+    // Split the quads between threads, with this thread writing the first
+    unsigned n_chunks = 0U;
+    for (size_t i = 0U; i < n_quads; i += SORD_WRITE_CHUNK_SIZE) {
+      SordWriteChunk* const chunk = &chunks[n_chunks];
+      const size_t          n     = n_quads - i;
+
+      chunk->quads      = quads + i;
+      chunk->n_quads    = n < SORD_WRITE_CHUNK_SIZE ? n : SORD_WRITE_CHUNK_SIZE;
+      chunk->syntax     = syntax;
+      chunk->style      = style;
+      chunk->output.len = 0U;
+      chunk->status     = SERD_SUCCESS;
+      if (n_chunks) {
+        started[n_chunks] = !zix_thread_create(
+          &threads[n_chunks], 0U, write_chunk_thread, chunk);
+      }
+
+      ++n_chunks;
+    }
+
+    write_chunk_thread(&chunks[0]);
+    for (unsigned c = 1U; c < n_chunks; ++c) {
+      if (started[c]) {
+        zix_thread_join(threads[c]);
+        started[c] = false;
+      } else {
+        write_chunk_thread(&chunks[c]);
+      }
+    }
+
+    // Write the output of each chunk in order
+    for (unsigned c = 0U; !st && c < n_chunks; ++c) {
+      const SordWriteBuffer* const output = &chunks[c].output;
+      if (chunks[c].status) {
+        st = chunks[c].status;
+      } else if (sink(output->buf, output->len, stream) != output->len) {
+        st = SERD_ERR_BAD_WRITE;
+      }
+    }
+  }
+
+  sord_iter_free(iter);
+  for (unsigned c = 0U; c < n_threads; ++c) {
+    free(chunks[c].output.buf);
+  }
+
+  free(started);
+  free(threads);
+  free(chunks);
+  free(quads);
+  return st;
+}
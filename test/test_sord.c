@@ -3,8 +3,10 @@
 
 #include <serd/serd.h>
 #include <sord/sord.h>
+#include <zix/thread.h>
 
 #include <inttypes.h>
+#include <math.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
@@ -52,6 +54,32 @@ test_fail(const char* fmt, ...)
   return 1;
 }
 
+/**
+   Check that a test passed without leaking nodes.
+
+   @param name Name of what was tested, to report leaks.
+   @param status Status returned by the test.
+   @param n_nodes_before Number of nodes in the world before the test.
+*/
+static int
+check_leaks(SordWorld* const  world,
+            const char* const name,
+            const int         status,
+            const size_t      n_nodes_before)
+{
+  if (status) {
+    return status; // The test may have freed the world
+  }
+
+  const size_t n_nodes = sord_num_nodes(world);
+  if (n_nodes != n_nodes_before) {
+    return test_fail(
+      "%s leaked nodes (%zu != %zu)\n", name, n_nodes, n_nodes_before);
+  }
+
+  return 0;
+}
+
 static int
 generate(SordWorld* world, SordModel* sord, unsigned n_quads, SordNode* graph)
 {
@@ -275,6 +303,15 @@ test_read(SordWorld* world, SordModel* sord, SordNode* g, const size_t n_quads)
                        test.expected_num_results,
                        num_results);
     }
+
+    const uint64_t count = sord_count(sord, pat[0], pat[1], pat[2], pat[3]);
+    const uint64_t estimate =
+      sord_estimate_count(sord, pat[0], pat[1], pat[2], pat[3]);
+    if (count != (uint64_t)num_results) {
+      return test_fail("Fail: Counted %" PRIu64 " results\n", count);
+    } else if (estimate < count) {
+      return test_fail("Fail: Estimated %" PRIu64 " results\n", estimate);
+    }
     fprintf(stderr, "OK (%i matches)\n", test.expected_num_results);
   }
 
@@ -369,6 +406,39 @@ unexpected_error(void* handle, const SerdError* error)
   return SERD_SUCCESS;
 }
 
+static int
+test_bulk(SordWorld* world, const unsigned n_quads)
+{
+  SordModel* sord  = sord_new(world, 0x3FU, true);
+  SordNode*  graph = uri(world, 42);
+
+  // Add one quad normally so the bulk load has to skip it
+  generate(world, sord, 1, graph);
+  const size_t n_before = sord_num_quads(sord);
+
+  sord_bulk_begin(sord);
+  generate(world, sord, n_quads, graph);
+  generate(world, sord, n_quads, graph);
+
+  if (sord_num_quads(sord) != n_before) {
+    sord_free(sord);
+    return test_fail("Pending bulk quads are visible\n");
+  }
+
+  const size_t n_added = sord_bulk_commit(sord);
+  if (sord_num_quads(sord) != n_before + n_added) {
+    sord_free(sord);
+    return test_fail("Bulk commit added %zu of %zu quads\n",
+                     sord_num_quads(sord) - n_before,
+                     n_added);
+  }
+
+  const int st = test_read(world, sord, graph, n_quads);
+  sord_node_free(world, graph);
+  sord_free(sord);
+  return st;
+}
+
 static SerdStatus
 expected_error(void* handle, const SerdError* error)
 {
@@ -388,236 +458,2039 @@ finished(SordWorld* world, SordModel* sord, int status)
   return status;
 }
 
-int
-main(void)
+static int
+test_batch(SordWorld* world, const unsigned n_quads)
 {
-  static const unsigned n_quads = 300U;
+  SordModel* ref   = sord_new(world, 0x3FU, true);
+  SordNode*  graph = uri(world, 42);
+  generate(world, ref, n_quads, graph);
+
+  // Make a batch of every quad in reverse order, with each twice
+  const size_t n_ref = sord_num_quads(ref);
+  SordQuad*    batch = (SordQuad*)calloc(n_ref * 2U, sizeof(SordQuad));
+  size_t       n     = 0U;
+  SordIter*    iter  = sord_begin(ref);
+  for (; !sord_iter_end(iter); sord_iter_next(iter), ++n) {
+    sord_iter_get(iter, batch[n_ref - n - 1U]);
+    sord_iter_get(iter, batch[n_ref + n]);
+  }
+  sord_iter_free(iter);
 
-  sord_free(NULL); // Shouldn't crash
+  SordModel* sord = sord_new(world, 0x3FU, true);
+  if (sord_add_batch(sord, batch, n_ref * 2U) != n_ref ||
+      sord_num_quads(sord) != n_ref) {
+    return test_fail("Batch added %zu of %zu quads\n",
+                     sord_num_quads(sord),
+                     n_ref);
+  } else if (sord_add_batch(sord, batch, n_ref) != 0U) {
+    return test_fail("Batch added quads that were already stored\n");
+  } else if (test_read(world, sord, graph, n_quads)) {
+    return finished(world, sord, EXIT_FAILURE);
+  }
 
-  SordWorld* world = sord_world_new();
+  // Remove every other quad, then (partly) the same quads again
+  for (size_t i = 0U; i < n_ref / 2U; ++i) {
+    memcpy(batch[i], batch[i * 2U], sizeof(SordQuad));
+  }
+  if (sord_remove_batch(sord, batch, n_ref / 2U) != n_ref / 2U ||
+      sord_num_quads(sord) != n_ref - n_ref / 2U) {
+    return test_fail("Batch removed %zu of %zu quads\n",
+                     n_ref - sord_num_quads(sord),
+                     n_ref / 2U);
+  } else if (sord_remove_batch(sord, batch, n_ref / 4U) != 0U) {
+    return test_fail("Batch removed quads that were already removed\n");
+  }
 
-  // Attempt to create invalid URI
-  fprintf(stderr, "expected ");
-  SordNode* bad_uri = sord_new_uri(world, USTR("noscheme"));
-  if (bad_uri) {
-    return test_fail("Successfully created invalid URI \"noscheme\"\n");
+  for (size_t i = 0U; i < n_ref / 2U; ++i) {
+    if (sord_contains(sord, batch[i]) ||
+        !sord_contains(sord, batch[n_ref * 2U - i * 2U - 2U])) {
+      return test_fail("Batch removed the wrong quads\n");
+    }
   }
-  sord_node_free(world, bad_uri);
 
+  // Attempt to add a batch with a quad that's missing a field
+  batch[0][SORD_OBJECT] = NULL;
+  n_expected_errors     = 0;
   sord_world_set_error_sink(world, expected_error, NULL);
-
-  // Attempt to create invalid CURIE
-  SerdNode  base = serd_node_from_string(SERD_URI, USTR("http://example.org/"));
-  SerdEnv*  env  = serd_env_new(&base);
-  SerdNode  sbad = serd_node_from_string(SERD_CURIE, USTR("bad:"));
-  SordNode* bad  = sord_node_from_serd_node(world, env, &sbad, NULL, NULL);
-  if (bad) {
-    return test_fail("Successfully created CURIE with bad namespace\n");
+  if (sord_add_batch(sord, batch, 2U) || n_expected_errors != 1) {
+    return test_fail("Added batch with a NULL field\n");
   }
-  sord_node_free(world, bad);
-  serd_env_free(env);
+  sord_world_set_error_sink(world, unexpected_error, NULL);
 
-  // Attempt to create node from garbage
-  SerdNode junk = SERD_NODE_NULL;
-  junk.type     = (SerdType)1234;
-  if (sord_node_from_serd_node(world, env, &junk, NULL, NULL)) {
-    return test_fail("Successfully created node from garbage serd node\n");
-  }
+  free(batch);
+  sord_free(sord);
+  sord_node_free(world, graph);
+  sord_free(ref);
+  return 0;
+}
 
-  // Attempt to create NULL node
-  SordNode* nil_node =
-    sord_node_from_serd_node(world, NULL, &SERD_NODE_NULL, NULL, NULL);
-  if (nil_node) {
-    return test_fail("Successfully created NULL node\n");
+static int
+test_arena(const unsigned n_quads)
+{
+  SordWorld* world = sord_world_new_with_options(SORD_WORLD_ARENA);
+  SordModel* sord  = sord_new(world, SORD_SPO | SORD_OPS, true);
+  SordNode*  graph = uri(world, 42);
+
+  generate(world, sord, n_quads, graph);
+  if (test_read(world, sord, graph, n_quads)) {
+    sord_node_free(world, graph);
+    return finished(world, sord, EXIT_FAILURE);
   }
-  sord_node_free(world, nil_node);
 
-  // Check node flags are set properly
-  SordNode* with_newline = sord_new_literal(world, NULL, USTR("a\nb"), NULL);
-  if (!(sord_node_get_flags(with_newline) & SERD_HAS_NEWLINE)) {
-    return test_fail("Newline flag not set\n");
+  // Remove everything and add it again to reuse the freed quads
+  const size_t n_before = sord_num_quads(sord);
+  SordIter*    iter     = sord_begin(sord);
+  while (!sord_iter_end(iter)) {
+    sord_erase(sord, iter);
   }
-  SordNode* with_quote = sord_new_literal(world, NULL, USTR("a\"b"), NULL);
-  if (!(sord_node_get_flags(with_quote) & SERD_HAS_QUOTE)) {
-    return test_fail("Quote flag not set\n");
+  sord_iter_free(iter);
+
+  generate(world, sord, n_quads, graph);
+  sord_node_free(world, graph);
+  if (sord_num_quads(sord) != n_before) {
+    fprintf(stderr, "Arena model has %zu quads\n", sord_num_quads(sord));
+    return finished(world, sord, EXIT_FAILURE);
   }
 
-  // Create with minimal indexing
-  SordModel* sord = sord_new(world, SORD_SPO, false);
-  generate(world, sord, n_quads, NULL);
+  return finished(world, sord, EXIT_SUCCESS);
+}
 
-  if (test_read(world, sord, NULL, n_quads)) {
-    sord_free(sord);
-    sord_world_free(world);
-    return EXIT_FAILURE;
+static int
+test_compact(const unsigned world_options, const unsigned n_quads)
+{
+  SordWorld* world = sord_world_new_with_options(world_options);
+  SordModel* sord  = sord_new(world, SORD_SPO | SORD_POS, true);
+  SordNode*  graph = uri(world, 42);
+
+  generate(world, sord, n_quads, graph);
+  sord_compact(sord);
+  if (test_read(world, sord, graph, n_quads)) {
+    sord_node_free(world, graph);
+    return finished(world, sord, EXIT_FAILURE);
   }
 
-  // Check adding tuples with NULL fields fails
-  sord_world_set_error_sink(world, expected_error, NULL);
-  const size_t initial_num_quads = sord_num_quads(sord);
-  SordQuad     tup               = {0, 0, 0, 0};
-  if (sord_add(sord, tup)) {
-    return test_fail("Added NULL tuple\n");
+  // Add a quad that isn't compacted
+  SordNode* const extra_s = uri(world, 997);
+  SordNode* const extra_p = uri(world, 998);
+  SordNode* const extra_o = uri(world, 999);
+  const SordQuad  extra   = {extra_s, extra_p, extra_o, graph};
+  if (!sord_add(sord, extra)) {
+    return finished(world, sord, test_fail("Failed to add to compacted\n"));
   }
-  tup[0] = uri(world, 1);
-  if (sord_add(sord, tup)) {
-    return test_fail("Added tuple with NULL P and O\n");
+
+  // Erase some compacted quads
+  SordNode* const s = uri(world, 1);
+  SordNode* const p = uri(world, 2);
+  SordIter* const i = sord_search(sord, s, p, NULL, NULL);
+  while (!sord_iter_end(i)) {
+    sord_erase(sord, i);
   }
-  tup[1] = uri(world, 2);
-  if (sord_add(sord, tup)) {
-    return test_fail("Added tuple with NULL O\n");
+  sord_iter_free(i);
+
+  const SordQuad pat = {s, p, NULL, NULL};
+  if (sord_contains(sord, pat)) {
+    return finished(world, sord, test_fail("Found erased compacted quad\n"));
   }
 
-  if (sord_num_quads(sord) != initial_num_quads) {
-    return test_fail(
-      "Num quads %zu != %zu\n", sord_num_quads(sord), initial_num_quads);
+  // Remove the uncompacted quad, then add it again and compact with holes
+  sord_remove(sord, extra);
+  if (sord_contains(sord, extra)) {
+    return finished(world, sord, test_fail("Found removed quad\n"));
   }
 
-  // Check adding tuples with an active iterator fails
-  SordIter* iter = sord_begin(sord);
-  tup[2]         = uri(world, 3);
-  if (sord_add(sord, tup)) {
-    return test_fail("Added tuple with active iterator\n");
+  sord_add(sord, extra);
+  sord_compact(sord);
+  if (!sord_contains(sord, extra) || sord_contains(sord, pat)) {
+    return finished(world, sord, test_fail("Recompaction failed\n"));
   }
 
-  // Check removing tuples with several active iterator fails
-  SordIter* iter2 = sord_begin(sord);
-  if (!sord_erase(sord, iter)) {
-    return test_fail("Erased tuple with several active iterators\n");
+  // Check that a triple in two graphs is counted once without a graph
+  SordNode* const graph2 = uri(world, 43);
+  const SordQuad  extra2 = {extra_s, extra_p, extra_o, graph2};
+  sord_add(sord, extra2);
+  sord_compact(sord);
+  sord_node_free(world, graph2);
+  if (sord_count(sord, extra_s, NULL, NULL, NULL) != 1U ||
+      sord_count(sord, extra_s, NULL, NULL, graph) != 1U) {
+    return finished(world, sord, test_fail("Compacted count incorrect\n"));
   }
+
+  sord_node_free(world, extra_o);
+  sord_node_free(world, extra_p);
+  sord_node_free(world, extra_s);
+  sord_node_free(world, p);
+  sord_node_free(world, s);
+  sord_node_free(world, graph);
+  return finished(world, sord, EXIT_SUCCESS);
+}
+
+static int
+test_snapshot(SordWorld* world, const unsigned n_quads)
+{
+  SordModel* sord  = sord_new(world, SORD_SPO | SORD_OPS, true);
+  SordNode*  graph = uri(world, 42);
+  generate(world, sord, n_quads, graph);
+
+  const size_t    n_before = sord_num_quads(sord);
+  SordModel*      snapshot = sord_snapshot(sord);
+  SordNode* const s        = uri(world, 1);
+  SordNode* const p        = uri(world, 2);
+  SordNode* const o        = uri(world, 999);
+  const SordQuad  added    = {s, p, o, graph};
+
+  // Modify the model while iterating over the snapshot
   n_expected_errors = 0;
-  sord_remove(sord, tup);
-  if (n_expected_errors != 1) {
-    return test_fail("Removed tuple with several active iterators\n");
-  }
+  sord_world_set_error_sink(world, expected_error, NULL);
+  SordIter* iter = sord_begin(snapshot);
+  sord_add(sord, added);
+
+  // Erase with an iterator made before the model is copied for a snapshot
+  SordModel* const snapshot2 = sord_snapshot(sord);
+  SordIter* const  erased    = sord_search(sord, s, p, NULL, NULL);
+  sord_erase(sord, erased);
+  sord_iter_free(erased);
   sord_iter_free(iter);
-  sord_iter_free(iter2);
+  if (sord_num_quads(snapshot2) != n_before + 1U) {
+    return test_fail("Erasing from model changed snapshot\n");
+  }
+  sord_free(snapshot2);
+  if (n_expected_errors) {
+    return test_fail("Writing to model blocked by snapshot iterator\n");
+  }
 
+  // Attempt to modify the snapshot
+  if (sord_add(snapshot, added) || n_expected_errors != 1) {
+    return test_fail("Successfully added to snapshot\n");
+  }
   sord_world_set_error_sink(world, unexpected_error, NULL);
 
-  // Check interning merges equivalent values
-  SordNode* uri_id   = sord_new_uri(world, USTR("http://example.org"));
-  SordNode* blank_id = sord_new_blank(world, USTR("testblank"));
-  SordNode* lit_id   = sord_new_literal(world, uri_id, USTR("hello"), NULL);
-  if (sord_node_get_type(uri_id) != SORD_URI) {
-    return test_fail("URI node has incorrect type\n");
-  } else if (sord_node_get_type(blank_id) != SORD_BLANK) {
-    return test_fail("Blank node has incorrect type\n");
-  } else if (sord_node_get_type(lit_id) != SORD_LITERAL) {
-    return test_fail("Literal node has incorrect type\n");
+  if (sord_num_quads(snapshot) != n_before ||
+      sord_num_quads(sord) != n_before) {
+    return test_fail("Snapshot or model has wrong number of quads\n");
+  } else if (sord_contains(snapshot, added) || !sord_contains(sord, added)) {
+    return test_fail("Quad added to model is in snapshot\n");
+  } else if (sord_count(snapshot, s, p, NULL, graph) != N_OBJECTS_PER) {
+    return test_fail("Quad erased from model is gone from snapshot\n");
   }
 
-  const size_t initial_num_nodes = sord_num_nodes(world);
-
-  SordNode* uri_id2   = sord_new_uri(world, USTR("http://example.org"));
-  SordNode* blank_id2 = sord_new_blank(world, USTR("testblank"));
-  SordNode* lit_id2   = sord_new_literal(world, uri_id, USTR("hello"), NULL);
-  if (uri_id2 != uri_id || !sord_node_equals(uri_id2, uri_id)) {
-    fprintf(stderr, "Fail: URI interning failed (duplicates)\n");
-    return finished(world, sord, EXIT_FAILURE);
-  } else if (blank_id2 != blank_id || !sord_node_equals(blank_id2, blank_id)) {
-    fprintf(stderr, "Fail: Blank node interning failed (duplicates)\n");
-    return finished(world, sord, EXIT_FAILURE);
-  } else if (lit_id2 != lit_id || !sord_node_equals(lit_id2, lit_id)) {
-    fprintf(stderr, "Fail: Literal interning failed (duplicates)\n");
+  if (test_read(world, snapshot, graph, n_quads)) {
     return finished(world, sord, EXIT_FAILURE);
   }
 
-  if (sord_num_nodes(world) != initial_num_nodes) {
-    return test_fail(
-      "Num nodes %zu != %zu\n", sord_num_nodes(world), initial_num_nodes);
+  // Free the model first, the snapshot keeps its quads alive
+  sord_free(sord);
+  if (sord_num_quads(snapshot) != n_before) {
+    return test_fail("Freeing model changed snapshot\n");
   }
 
-  const uint8_t ni_hao[] = {0xE4, 0xBD, 0xA0, 0xE5, 0xA5, 0xBD, 0};
-  SordNode*     chello   = sord_new_literal(world, NULL, ni_hao, "cmn");
+  sord_node_free(world, o);
+  sord_node_free(world, p);
+  sord_node_free(world, s);
+  sord_node_free(world, graph);
+  sord_free(snapshot);
+  return 0;
+}
 
-  // Test literal length
-  size_t         n_bytes = 0U;
-  size_t         n_chars = 0U;
-  const uint8_t* str     = sord_node_get_string_counted(lit_id2, &n_bytes);
-  if (!!strcmp((const char*)str, "hello")) {
-    return test_fail("Literal node corrupt\n");
-  } else if (n_bytes != strlen("hello")) {
-    return test_fail("ASCII literal byte count incorrect\n");
-  }
+typedef struct {
+  SordModel* sord;
+  SordNode*  s;
+  SordNode*  p;
+  unsigned   n_errors;
+} ReaderState;
+
+static ZixThreadResult ZIX_THREAD_FUNC
+read_concurrently(void* const arg)
+{
+  ReaderState* const state = (ReaderState*)arg;
 
-  str = sord_node_get_string_measured(lit_id2, &n_bytes, &n_chars);
-  if (n_bytes != strlen("hello") || n_chars != strlen("hello")) {
-    return test_fail("ASCII literal measured length incorrect\n");
-  } else if (!!strcmp((const char*)str, "hello")) {
-    return test_fail("ASCII literal string incorrect\n");
+  for (unsigned i = 0U; i < 1000U; ++i) {
+    SordNode* const o = sord_get(state->sord, state->s, state->p, NULL, NULL);
+    if (!o || sord_count(state->sord, state->s, NULL, NULL, NULL) != 2U ||
+        !sord_ask(state->sord, state->s, state->p, o, NULL)) {
+      ++state->n_errors;
+    }
+    sord_node_free(sord_get_world(state->sord), o);
   }
 
-  str = sord_node_get_string_measured(chello, &n_bytes, &n_chars);
-  if (n_bytes != 6) {
-    return test_fail("Multi-byte literal byte count incorrect\n");
-  } else if (n_chars != 2) {
-    return test_fail("Multi-byte literal character count incorrect\n");
-  } else if (!!strcmp((const char*)str, (const char*)ni_hao)) {
-    return test_fail("Multi-byte literal string incorrect\n");
-  }
+  return ZIX_THREAD_RESULT;
+}
 
-  // Check interning doesn't clash non-equivalent values
-  SordNode* uri_id3   = sord_new_uri(world, USTR("http://example.orgX"));
-  SordNode* blank_id3 = sord_new_blank(world, USTR("testblankX"));
-  SordNode* lit_id3   = sord_new_literal(world, uri_id, USTR("helloX"), NULL);
-  if (uri_id3 == uri_id || sord_node_equals(uri_id3, uri_id)) {
-    fprintf(stderr, "Fail: URI interning failed (clash)\n");
-    return finished(world, sord, EXIT_FAILURE);
-  } else if (blank_id3 == blank_id || sord_node_equals(blank_id3, blank_id)) {
-    fprintf(stderr, "Fail: Blank node interning failed (clash)\n");
-    return finished(world, sord, EXIT_FAILURE);
-  } else if (lit_id3 == lit_id || sord_node_equals(lit_id3, lit_id)) {
-    fprintf(stderr, "Fail: Literal interning failed (clash)\n");
-    return finished(world, sord, EXIT_FAILURE);
-  }
+static int
+test_concurrent_readers(SordWorld* world, const unsigned n_quads)
+{
+  SordModel* sord = sord_new(world, SORD_SPO | SORD_OPS, false);
+  generate(world, sord, n_quads, NULL);
 
-  // Check literal interning
-  SordNode* lit4 = sord_new_literal(world, NULL, USTR("hello"), NULL);
-  SordNode* lit5 = sord_new_literal(world, uri_id2, USTR("hello"), NULL);
-  SordNode* lit6 = sord_new_literal(world, NULL, USTR("hello"), "en-ca");
-  if (lit4 == lit5 || sord_node_equals(lit4, lit5) || lit4 == lit6 ||
-      sord_node_equals(lit4, lit6) || lit5 == lit6 ||
-      sord_node_equals(lit5, lit6)) {
-    fprintf(stderr, "Fail: Literal interning failed (type/lang clash)\n");
-    return finished(world, sord, EXIT_FAILURE);
+  ReaderState states[4];
+  ZixThread   threads[4];
+  for (unsigned i = 0U; i < 4U; ++i) {
+    states[i].sord     = sord;
+    states[i].s        = uri(world, 1U);
+    states[i].p        = uri(world, 2U);
+    states[i].n_errors = 0U;
+    zix_thread_create(&threads[i], 0U, read_concurrently, &states[i]);
   }
 
-  // Check relative URI construction
-  SordNode* reluri =
-    sord_new_relative_uri(world, USTR("a/b"), USTR("http://example.org/"));
-  if (!!strcmp((const char*)sord_node_get_string(reluri),
-               "http://example.org/a/b")) {
-    fprintf(stderr,
-            "Fail: Bad relative URI constructed: <%s>\n",
-            sord_node_get_string(reluri));
-    return finished(world, sord, EXIT_FAILURE);
+  unsigned n_errors = 0U;
+  for (unsigned i = 0U; i < 4U; ++i) {
+    zix_thread_join(threads[i]);
+    n_errors += states[i].n_errors;
+    sord_node_free(world, states[i].p);
+    sord_node_free(world, states[i].s);
   }
-  SordNode* reluri2 = sord_new_relative_uri(
-    world, USTR("http://drobilla.net/"), USTR("http://example.org/"));
-  if (!!strcmp((const char*)sord_node_get_string(reluri2),
-               "http://drobilla.net/")) {
-    fprintf(stderr,
-            "Fail: Bad relative URI constructed: <%s>\n",
-            sord_node_get_string(reluri));
-    return finished(world, sord, EXIT_FAILURE);
+
+  // Check that every iterator was counted, so removing is allowed again
+  SordQuad tup = {0, 0, 0, 0};
+  tup[0]       = uri(world, 1U);
+  tup[1]       = uri(world, 2U);
+  tup[2]       = uri(world, 3U);
+  tup[3]       = NULL;
+  sord_world_set_error_sink(world, expected_error, NULL);
+  n_expected_errors = 0;
+  sord_remove(sord, tup);
+  sord_world_set_error_sink(world, unexpected_error, NULL);
+  for (unsigned i = 0U; i < 3U; ++i) {
+    sord_node_free(world, (SordNode*)tup[i]);
   }
 
-  // Check comparison with NULL
-  sord_node_free(world, uri_id);
-  sord_node_free(world, blank_id);
-  sord_node_free(world, lit_id);
-  sord_node_free(world, uri_id2);
-  sord_node_free(world, blank_id2);
-  sord_node_free(world, lit_id2);
-  sord_node_free(world, uri_id3);
-  sord_node_free(world, blank_id3);
-  sord_node_free(world, lit_id3);
   sord_free(sord);
+  if (n_expected_errors) {
+    return test_fail("Iterators left after concurrent reads\n");
+  }
 
-  static const char* const index_names[6] = {
-    "spo", "sop", "ops", "osp", "pso", "pos"};
+  return n_errors ? test_fail("%u concurrent read errors\n", n_errors) : 0;
+}
+
+static int
+test_inserter(SordWorld* world)
+{
+  SordModel*    sord     = sord_new(world, SORD_SPO, false);
+  SerdEnv*      env      = serd_env_new(NULL);
+  SordInserter* inserter = sord_inserter_new(sord, env);
+
+  SerdNode name   = serd_node_from_string(SERD_LITERAL, USTR("eg"));
+  SerdNode ns1    = serd_node_from_string(SERD_URI, USTR("http://a.org/"));
+  SerdNode ns2    = serd_node_from_string(SERD_URI, USTR("http://b.org/"));
+  SerdNode s      = serd_node_from_string(SERD_CURIE, USTR("eg:s"));
+  SerdNode p      = serd_node_from_string(SERD_CURIE, USTR("eg:p"));
+  SerdNode o1     = serd_node_from_string(SERD_LITERAL, USTR("one"));
+  SerdNode o2     = serd_node_from_string(SERD_LITERAL, USTR("two"));
+  SerdNode bad    = serd_node_from_string(SERD_CURIE, USTR("nope:s"));
+  SerdNode bad_st = SERD_NODE_NULL;
+
+  // Write repeated subjects and predicates, then redefine their prefix
+  sord_inserter_set_prefix(inserter, &name, &ns1);
+  sord_inserter_write_statement(inserter, 0, NULL, &s, &p, &o1, NULL, NULL);
+  sord_inserter_write_statement(inserter, 0, NULL, &s, &p, &o2, NULL, NULL);
+  sord_inserter_set_prefix(inserter, &name, &ns2);
+  sord_inserter_write_statement(inserter, 0, NULL, &s, &p, &o1, NULL, NULL);
+
+  n_expected_errors = 0;
+  sord_world_set_error_sink(world, expected_error, NULL);
+  if (!sord_inserter_write_statement(
+        inserter, 0, NULL, &bad, &p, &o1, NULL, NULL) ||
+      !sord_inserter_write_statement(
+        inserter, 0, NULL, &s, &p, &bad_st, NULL, NULL)) {
+    return test_fail("Wrote statement with invalid node\n");
+  }
+  sord_world_set_error_sink(world, unexpected_error, NULL);
+
+  SordNode* const s1 = sord_new_uri(world, USTR("http://a.org/s"));
+  SordNode* const p1 = sord_new_uri(world, USTR("http://a.org/p"));
+  SordNode* const s2 = sord_new_uri(world, USTR("http://b.org/s"));
+  SordNode* const p2 = sord_new_uri(world, USTR("http://b.org/p"));
+
+  if (sord_num_quads(sord) != 3U) {
+    return test_fail("Inserter wrote %zu quads, not 3\n", sord_num_quads(sord));
+  } else if (sord_count(sord, s1, p1, NULL, NULL) != 2U) {
+    return test_fail("Inserter wrote wrong nodes for repeated CURIEs\n");
+  } else if (sord_count(sord, s2, p2, NULL, NULL) != 1U) {
+    return test_fail("Inserter used stale CURIE after prefix change\n");
+  }
+
+  // Write statements through a buffer
+  SerdNode o3 = serd_node_from_string(SERD_LITERAL, USTR("three"));
+  SerdNode o4 = serd_node_from_string(SERD_LITERAL, USTR("four"));
+  SerdNode o5 = serd_node_from_string(SERD_LITERAL, USTR("five"));
+  sord_inserter_set_buffer_size(inserter, 2U);
+  sord_inserter_write_statement(inserter, 0, NULL, &s, &p, &o3, NULL, NULL);
+  if (sord_num_quads(sord) != 3U) {
+    return test_fail("Buffered statement was written immediately\n");
+  }
+
+  sord_inserter_write_statement(inserter, 0, NULL, &s, &p, &o4, NULL, NULL);
+  sord_inserter_write_statement(inserter, 0, NULL, &s, &p, &o5, NULL, NULL);
+  if (sord_num_quads(sord) != 5U) {
+    return test_fail("Full buffer wasn't written\n");
+  }
+
+  sord_inserter_flush(inserter);
+  if (sord_num_quads(sord) != 6U) {
+    return test_fail("Flushing inserter wrote %zu quads\n",
+                     sord_num_quads(sord) - 5U);
+  }
+
+  sord_node_free(world, p2);
+  sord_node_free(world, s2);
+  sord_node_free(world, p1);
+  sord_node_free(world, s1);
+  sord_inserter_free(inserter);
+  serd_env_free(env);
+  sord_free(sord);
+  return 0;
+}
+
+static int
+test_load_files(SordWorld* world)
+{
+  static const char* const contents[] = {
+    "@prefix eg: <http://example.org/> .\n"
+    "eg:s eg:p _:b1 .\n"
+    "_:b1 eg:p \"zero\" .\n"
+    "eg:s eg:q eg:o .\n",
+    "<http://example.org/s> <http://example.org/p> _:b1 .\n"
+    "_:b1 <http://example.org/p> \"one\" .\n",
+  };
+
+  const uint8_t* const paths[] = {(const uint8_t*)"sord_test_load_0.ttl",
+                                  (const uint8_t*)"sord_test_load_1.ttl",
+                                  (const uint8_t*)"sord_test_load_none.ttl"};
+
+  for (unsigned i = 0U; i < 2U; ++i) {
+    FILE* const fd = fopen((const char*)paths[i], "w");
+    if (!fd) {
+      return test_fail("Failed to open %s\n", (const char*)paths[i]);
+    }
+    fprintf(fd, "%s", contents[i]);
+    fclose(fd);
+  }
+
+  SordModel* sord   = sord_new(world, SORD_SPO | SORD_OPS, false);
+  SerdEnv*   env    = serd_env_new(NULL);
+  SerdStatus sts[3] = {SERD_SUCCESS, SERD_SUCCESS, SERD_SUCCESS};
+
+  const SerdStatus st =
+    sord_load_files(sord, env, SERD_TURTLE, 3U, paths, 2U, sts);
+
+  remove((const char*)paths[0]);
+  remove((const char*)paths[1]);
+
+  SordNode* const s = sord_new_uri(world, USTR("http://example.org/s"));
+  SordNode* const p = sord_new_uri(world, USTR("http://example.org/p"));
+
+  if (!st || sts[0] || sts[1] || !sts[2]) {
+    return test_fail("Missing file load status incorrect\n");
+  } else if (sord_num_quads(sord) != 5U) {
+    return test_fail("Loaded %zu quads, not 5\n", sord_num_quads(sord));
+  } else if (sord_count(sord, s, p, NULL, NULL) != 2U) {
+    return test_fail("Blank nodes from different files are not distinct\n");
+  }
+
+  SerdNode  curie = serd_node_from_string(SERD_CURIE, USTR("eg:o"));
+  SerdChunk prefix;
+  SerdChunk suffix;
+  if (serd_env_expand(env, &curie, &prefix, &suffix)) {
+    return test_fail("Prefix from loaded file not merged\n");
+  }
+
+  sord_node_free(world, p);
+  sord_node_free(world, s);
+  serd_env_free(env);
+  sord_free(sord);
+  return 0;
+}
+
+static int
+test_binary(SordWorld* world, const unsigned n_quads)
+{
+  const uint8_t* const path  = USTR("sord_test_binary.bin");
+  SordModel*           sord  = sord_new(world, SORD_SPO | SORD_OPS, true);
+  SordNode*            graph = uri(world, 42);
+  generate(world, sord, n_quads, graph);
+
+  if (sord_save_binary(sord, path, true)) {
+    return test_fail("Failed to save binary snapshot\n");
+  }
+
+  // Load with stored index orders, and into a model that must sort
+  static const unsigned indices[] = {SORD_SPO | SORD_OPS,
+                                     SORD_SPO | SORD_POS | SORD_ID_ORDER};
+  for (unsigned i = 0U; i < 2U; ++i) {
+    SordModel* const loaded = sord_new(world, indices[i], true);
+    if (sord_load_binary(loaded, path)) {
+      return test_fail("Failed to load binary snapshot\n");
+    } else if (sord_num_quads(loaded) != sord_num_quads(sord)) {
+      return test_fail("Loaded %zu quads from binary snapshot, not %zu\n",
+                       sord_num_quads(loaded),
+                       sord_num_quads(sord));
+    } else if (test_read(world, loaded, graph, n_quads)) {
+      return finished(world, sord, EXIT_FAILURE);
+    }
+    sord_free(loaded);
+  }
+
+  // Load into the model it was saved from, which should change nothing
+  const size_t n_before = sord_num_quads(sord);
+  if (sord_load_binary(sord, path) || sord_num_quads(sord) != n_before) {
+    return test_fail("Loading binary snapshot again added quads\n");
+  }
+
+  // Truncate the snapshot and check that loading it fails cleanly
+  FILE* const fd   = fopen((const char*)path, "rb+");
+  char        head = 0;
+  if (!fd || fread(&head, 1U, 1U, fd) != 1U || fseek(fd, 0, SEEK_SET) ||
+      fwrite("X", 1U, 1U, fd) != 1U) {
+    return test_fail("Failed to corrupt binary snapshot\n");
+  }
+  fclose(fd);
+
+  SordModel* const empty = sord_new(world, SORD_SPO, false);
+  n_expected_errors      = 0;
+  sord_world_set_error_sink(world, expected_error, NULL);
+  const SerdStatus st = sord_load_binary(empty, path);
+  sord_world_set_error_sink(world, unexpected_error, NULL);
+  remove((const char*)path);
+  if (st != SERD_ERR_BAD_SYNTAX || n_expected_errors != 1) {
+    return test_fail("Loaded invalid binary snapshot\n");
+  } else if (sord_num_quads(empty)) {
+    return test_fail("Invalid binary snapshot added quads\n");
+  }
+
+  sord_free(empty);
+  sord_node_free(world, graph);
+  sord_free(sord);
+  return 0;
+}
+
+static int
+test_mapped(SordWorld* world, const unsigned n_quads)
+{
+  const uint8_t* const path  = USTR("sord_test_mapped.bin");
+  SordModel*           sord  = sord_new(world, SORD_SPO | SORD_OPS, true);
+  SordNode*            graph = uri(world, 42);
+  SordNode* const      s     = uri(world, 1);
+  SordNode* const      p     = uri(world, 2);
+  SordNode* const      o     = uri(world, 999);
+  const SordQuad       added = {s, p, o, graph};
+  generate(world, sord, n_quads, graph);
+
+  const size_t   n_saved = sord_num_quads(sord);
+  const uint64_t n_sp    = sord_count(sord, s, p, NULL, NULL);
+  const uint64_t n_spg   = sord_count(sord, s, p, NULL, graph);
+  const uint64_t n_o     = sord_count(sord, NULL, NULL, o, NULL);
+  if (sord_save_binary(sord, path, true)) {
+    return test_fail("Failed to save binary snapshot\n");
+  }
+
+  // Open while the nodes are in the world, then again when most are new
+  for (unsigned i = 0U; i < 2U; ++i) {
+    SordModel* const mapped = sord_open_binary(world, path);
+    if (!mapped) {
+      return test_fail("Failed to open binary snapshot\n");
+    } else if (sord_num_quads(mapped) != n_saved) {
+      return test_fail("Opened %zu quads from binary snapshot, not %zu\n",
+                       sord_num_quads(mapped),
+                       n_saved);
+    }
+
+    // Free the source model before the mapped one the first time around
+    sord_free(sord);
+    sord = NULL;
+
+    n_expected_errors = 0;
+    sord_world_set_error_sink(world, expected_error, NULL);
+    const bool modified = sord_add(mapped, added);
+    sord_world_set_error_sink(world, unexpected_error, NULL);
+    if (modified || n_expected_errors != 1) {
+      return test_fail("Successfully added to mapped model\n");
+    } else if (sord_count(mapped, s, p, NULL, NULL) != n_sp ||
+               sord_count(mapped, s, p, NULL, graph) != n_spg ||
+               sord_count(mapped, NULL, NULL, o, NULL) != n_o ||
+               sord_estimate_count(mapped, s, p, NULL, NULL) < n_sp) {
+      return test_fail("Mapped model has wrong counts\n");
+    } else if (sord_contains(mapped, added)) {
+      return test_fail("Mapped model contains unknown quad\n");
+    } else if (test_read(world, mapped, graph, n_quads)) {
+      return finished(world, mapped, EXIT_FAILURE);
+    }
+
+    // Saving a mapped model writes the same snapshot
+    if (i == 1U) {
+      const uint8_t* const copy_path = USTR("sord_test_mapped_copy.bin");
+      SordModel*           copy      = NULL;
+      if (sord_save_binary(mapped, copy_path, false) ||
+          !(copy = sord_open_binary(world, copy_path)) ||
+          sord_num_quads(copy) != n_saved) {
+        return test_fail("Failed to save mapped model\n");
+      }
+
+      sord_free(copy);
+      remove((const char*)copy_path);
+    }
+
+    sord_free(mapped);
+  }
+
+  // Save a snapshot with a node that will only be in the mapped model
+  const uint8_t* const only_mapped = USTR("http://example.org/only_mapped");
+  SordNode* const      unique      = sord_new_uri(world, only_mapped);
+  const SordQuad       unique_quad = {unique, p, o, NULL};
+  sord                             = sord_new(world, SORD_SPO, false);
+  sord_add(sord, unique_quad);
+  sord_node_free(world, unique);
+  if (sord_save_binary(sord, path, false)) {
+    return test_fail("Failed to save binary snapshot\n");
+  }
+  sord_free(sord);
+
+  // Nodes from a mapped model stay valid after it is freed if they're used
+  SordModel* const mapped = sord_open_binary(world, path);
+  SordNode* const  kept   = sord_new_uri(world, only_mapped);
+  SordModel* const other  = sord_new(world, SORD_SPO, false);
+  const SordQuad   quad   = {kept, p, o, NULL};
+  sord_add(other, quad);
+  sord_free(mapped);
+
+  SordNode* const again = sord_new_uri(world, only_mapped);
+  const bool      valid =
+    again == kept && sord_contains(other, quad) &&
+    !strcmp((const char*)sord_node_get_string(kept), (const char*)only_mapped);
+
+  sord_node_free(world, again);
+  sord_node_free(world, kept);
+  sord_free(other);
+  if (!valid) {
+    return test_fail("Node from freed mapped model is invalid\n");
+  }
+
+  remove((const char*)path);
+  sord_node_free(world, o);
+  sord_node_free(world, p);
+  sord_node_free(world, s);
+  sord_node_free(world, graph);
+  return 0;
+}
+
+static int
+test_query(SordWorld* world)
+{
+  static const unsigned n_people = 100U;
+
+  SordModel* sord =
+    sord_new(world, SORD_SPO | SORD_OPS | SORD_POS | SORD_PSO, true);
+  SordNode* type   = uri(world, 1);
+  SordNode* person = uri(world, 2);
+  SordNode* name   = uri(world, 3);
+  SordNode* knows  = uri(world, 4);
+  SordNode* graph  = uri(world, 5);
+  for (unsigned i = 0U; i < n_people; ++i) {
+    char label[16];
+    snprintf(label, sizeof(label), "name%u", i);
+
+    SordNode* const s     = uri(world, 100U + i);
+    SordNode* const known = uri(world, 101U + i);
+    SordNode* const lit   = sord_new_literal(world, NULL, USTR(label), NULL);
+
+    const SordQuad is_person = {s, type, person, NULL};
+    const SordQuad has_name  = {s, name, lit, graph};
+    const SordQuad is_known  = {s, knows, known, NULL};
+    sord_add(sord, is_person);
+    sord_add(sord, has_name);
+    if (i % 2U == 0U) {
+      sord_add(sord, is_known);
+    }
+
+    sord_node_free(world, lit);
+    sord_node_free(world, known);
+    sord_node_free(world, s);
+  }
+
+  // Find the names of everyone who knows someone, and whoever that is
+  enum { S, N, F, M };
+
+  static const int s_is_person[] = {S, -1, -1, -1};
+  static const int s_has_name[]  = {S, -1, N, -1};
+  static const int s_knows_f[]   = {S, -1, F, -1};
+  static const int f_has_name[]  = {F, -1, M, -1};
+
+  const SordQuad   is_person = {NULL, type, person, NULL};
+  const SordQuad   has_name  = {NULL, name, NULL, NULL};
+  const SordQuad   knows_pat = {NULL, knows, NULL, NULL};
+  SordQuery* const query     = sord_query_new(sord);
+  sord_query_add(query, is_person, s_is_person);
+  sord_query_add(query, has_name, s_has_name);
+  sord_query_add(query, knows_pat, s_knows_f);
+  sord_query_add(query, has_name, f_has_name);
+
+  const size_t n_rows = sord_query_execute(query);
+  if (n_rows != n_people / 2U || sord_query_num_vars(query) != 4U) {
+    return test_fail("Query has %zu solutions, not %u\n", n_rows, n_people / 2);
+  }
+
+  for (size_t r = 0U; r < n_rows; ++r) {
+    const SordNode* const s = sord_query_get(query, r, S);
+    const SordNode* const f = sord_query_get(query, r, F);
+    const SordNode* const n = sord_query_get(query, r, N);
+    const SordNode* const m = sord_query_get(query, r, M);
+    if (!s || !f || !n || !m || n == m ||
+        !sord_ask(sord, s, knows, f, NULL) ||
+        !sord_ask(sord, s, name, n, NULL) ||
+        !sord_ask(sord, f, name, m, NULL)) {
+      return test_fail("Query has incorrect solution %zu\n", r);
+    }
+  }
+
+  if (sord_query_get(query, n_rows, S) || sord_query_get(query, 0U, 4U)) {
+    return test_fail("Query has solution out of range\n");
+  }
+  sord_query_free(query);
+
+  // Bind graphs, which are null for the default graph
+  static const int in_graph[]      = {S, -1, N, F};
+  static const int in_same_graph[] = {S, -1, -1, F};
+  static const int is_self[]       = {S, -1, S, -1};
+
+  SordQuery* const graphs = sord_query_new(sord);
+  sord_query_add(graphs, has_name, in_graph);
+  if (sord_query_execute(graphs) != n_people ||
+      sord_query_get(graphs, 0U, F) != graph) {
+    return test_fail("Query has incorrect graph solutions\n");
+  }
+
+  sord_query_add(graphs, knows_pat, in_same_graph);
+  if (sord_query_execute(graphs)) {
+    return test_fail("Query matched different graphs\n");
+  }
+  sord_query_free(graphs);
+
+  // Join with a pattern that has every node fixed, including the graph
+  SordNode* const first_name = sord_new_literal(world, NULL, USTR("name0"), 0);
+  SordNode* const first      = uri(world, 100U);
+  SordNode* const other_name = sord_new_literal(world, NULL, USTR("name1"), 0);
+  const SordQuad  named      = {first, name, first_name, graph};
+  const SordQuad  misnamed   = {first, name, other_name, graph};
+
+  SordQuery* const fixed = sord_query_new(sord);
+  sord_query_add(fixed, is_person, s_is_person);
+  sord_query_add(fixed, named, NULL);
+  if (sord_query_execute(fixed) != n_people) {
+    return test_fail("Query with a fixed pattern has wrong solutions\n");
+  }
+
+  sord_query_add(fixed, misnamed, NULL);
+  if (sord_query_execute(fixed)) {
+    return test_fail("Query matched a missing fixed pattern\n");
+  }
+
+  sord_query_free(fixed);
+  sord_node_free(world, other_name);
+  sord_node_free(world, first);
+  sord_node_free(world, first_name);
+
+  // Use a variable twice in one pattern
+  SordQuery* const self = sord_query_new(sord);
+  sord_query_add(self, knows_pat, is_self);
+  if (sord_query_execute(self)) {
+    return test_fail("Query matched different nodes to one variable\n");
+  }
+
+  // Attempt to add a pattern with a node and a variable at one position
+  n_expected_errors = 0;
+  sord_world_set_error_sink(world, expected_error, NULL);
+  if (sord_query_add(self, is_person, is_self) || n_expected_errors != 1) {
+    return test_fail("Added query pattern with a node and a variable\n");
+  }
+  sord_world_set_error_sink(world, unexpected_error, NULL);
+  sord_query_free(self);
+
+  sord_free(sord);
+  sord_node_free(world, graph);
+  sord_node_free(world, knows);
+  sord_node_free(world, name);
+  sord_node_free(world, person);
+  sord_node_free(world, type);
+  return 0;
+}
+
+static int
+test_indices(SordWorld* world, const unsigned n_quads)
+{
+  SordModel* sord  = sord_new(world, SORD_SPO, true);
+  SordNode*  graph = uri(world, 42);
+  generate(world, sord, n_quads, graph);
+  if (sord_get_indices(sord) != SORD_SPO) {
+    return test_fail("Model has indices 0x%X\n", sord_get_indices(sord));
+  }
+
+  // Add indices, before and after compacting
+  if (!sord_add_index(sord, SORD_OPS | SORD_POS) ||
+      sord_get_indices(sord) != (SORD_SPO | SORD_OPS | SORD_POS)) {
+    return test_fail("Failed to add indices\n");
+  } else if (test_read(world, sord, graph, n_quads)) {
+    return finished(world, sord, EXIT_FAILURE);
+  }
+
+  sord_compact(sord);
+  if (!sord_add_index(sord, SORD_PSO) ||
+      test_read(world, sord, graph, n_quads)) {
+    return finished(world, sord, EXIT_FAILURE);
+  }
+
+  // Drop indices, and attempt to drop the default index
+  n_expected_errors = 0;
+  sord_world_set_error_sink(world, expected_error, NULL);
+  if (sord_drop_index(sord, SORD_SPO) || n_expected_errors != 1) {
+    return test_fail("Dropped default index\n");
+  }
+  sord_world_set_error_sink(world, unexpected_error, NULL);
+
+  if (!sord_drop_index(sord, SORD_POS | SORD_PSO) ||
+      sord_get_indices(sord) != (SORD_SPO | SORD_OPS)) {
+    return test_fail("Failed to drop indices\n");
+  } else if (test_read(world, sord, graph, n_quads)) {
+    return finished(world, sord, EXIT_FAILURE);
+  }
+
+  // Remove a quad, which is in several blocks and a new index
+  SordNode* const s       = uri(world, 1);
+  SordNode* const p       = uri(world, 2);
+  SordNode* const o       = uri(world, 3);
+  const SordQuad  removed = {s, p, o, graph};
+  sord_add_index(sord, SORD_SOP);
+  sord_remove(sord, removed);
+  if (sord_contains(sord, removed) ||
+      sord_count(sord, s, p, NULL, NULL) != N_OBJECTS_PER - 1U) {
+    return test_fail("Failed to remove quad from new index\n");
+  }
+  sord_add(sord, removed);
+
+  // Search by predicate until its index is built at the next write
+  sord_set_index_threshold(sord, 2U);
+  for (unsigned i = 0U; i < 2U; ++i) {
+    SordIter* const iter = sord_search(sord, NULL, p, NULL, NULL);
+    sord_iter_free(iter);
+    if (sord_get_indices(sord) & SORD_POS) {
+      return test_fail("Built index before next write\n");
+    }
+  }
+
+  sord_remove(sord, removed);
+  sord_add(sord, removed);
+  if (!(sord_get_indices(sord) & SORD_POS)) {
+    return test_fail("Failed to build index for searches\n");
+  } else if (test_read(world, sord, graph, n_quads)) {
+    return finished(world, sord, EXIT_FAILURE);
+  }
+
+  sord_node_free(world, o);
+  sord_node_free(world, p);
+  sord_node_free(world, s);
+  sord_node_free(world, graph);
+  sord_free(sord);
+  return 0;
+}
+
+static int
+test_skip_scan(SordWorld* world)
+{
+  // A dense grid of quads, where filtered patterns skip long runs
+  static const unsigned n_subjects   = 24U;
+  static const unsigned n_predicates = 16U;
+  static const unsigned n_objects    = 8U;
+
+  SordNode* nodes[24] = {NULL};
+  for (unsigned i = 0U; i < n_subjects; ++i) {
+    nodes[i] = uri(world, i + 1U);
+  }
+
+  static const unsigned flags[] = {SORD_SPO,
+                                   SORD_SPO | SORD_ID_ORDER,
+                                   SORD_OPS | SORD_POS,
+                                   SORD_PSO | SORD_ID_ORDER};
+
+  for (unsigned f = 0U; f < sizeof(flags) / sizeof(flags[0]); ++f) {
+    SordModel* sord = sord_new(world, flags[f], true);
+    for (unsigned s = 0U; s < n_subjects; ++s) {
+      for (unsigned p = 0U; p < n_predicates; ++p) {
+        for (unsigned o = 0U; o < n_objects; ++o) {
+          const SordQuad quad = {
+            nodes[s], nodes[p], nodes[(s + p + o) % n_subjects], nodes[o % 2]};
+          sord_add(sord, quad);
+        }
+      }
+    }
+
+    // Check every combination of a few values against a full scan
+    static const unsigned values[] = {0U, 1U, 2U, 7U, 13U, 23U};
+    static const unsigned n_values = sizeof(values) / sizeof(values[0]);
+    for (unsigned i = 0U; i < n_values * n_values * n_values * 3U; ++i) {
+      const unsigned s = values[i % n_values];
+      const unsigned p = values[(i / n_values) % n_values];
+      const unsigned o = values[(i / n_values / n_values) % n_values];
+      const unsigned g = i / n_values / n_values / n_values;
+
+      const SordQuad pat = {s ? nodes[s] : NULL,
+                            p ? nodes[p] : NULL,
+                            o ? nodes[o] : NULL,
+                            g ? nodes[g - 1U] : NULL};
+
+      size_t    n_expected = 0U;
+      SordIter* iter       = sord_begin(sord);
+      for (; !sord_iter_end(iter); sord_iter_next(iter)) {
+        SordQuad quad;
+        sord_iter_get(iter, quad);
+        n_expected += sord_quad_match(quad, pat);
+      }
+      sord_iter_free(iter);
+
+      const size_t n_found = sord_count(sord, pat[0], pat[1], pat[2], pat[3]);
+      if (n_found != n_expected) {
+        sord_free(sord);
+        return test_fail("Found %zu matches for (%u %u %u %u), expected %zu\n",
+                         n_found,
+                         s,
+                         p,
+                         o,
+                         g,
+                         n_expected);
+      }
+    }
+
+    sord_free(sord);
+  }
+
+  for (unsigned i = 0U; i < n_subjects; ++i) {
+    sord_node_free(world, nodes[i]);
+  }
+
+  return 0;
+}
+
+static size_t
+count_triples(SordModel* sord, const SordNode* s, const SordNode* p)
+{
+  size_t    n_triples = 0U;
+  SordQuad  last      = {NULL, NULL, NULL, NULL};
+  SordIter* iter      = sord_search(sord, s, p, NULL, NULL);
+  for (; !sord_iter_end(iter); sord_iter_next(iter)) {
+    SordQuad quad;
+    sord_iter_get(iter, quad);
+    if (quad[0] == last[0] && quad[1] == last[1] && quad[2] == last[2]) {
+      n_triples = 0U; // A triple was visited twice, so fail
+      break;
+    }
+
+    last[0] = quad[0];
+    last[1] = quad[1];
+    last[2] = quad[2];
+    ++n_triples;
+  }
+
+  sord_iter_free(iter);
+  return n_triples;
+}
+
+static int
+test_graph_duplicates(SordWorld* world)
+{
+  static const unsigned n_graphs   = 50U;
+  static const unsigned n_subjects = 8U;
+  static const unsigned n_objects  = 6U;
+
+  const uint8_t* const path = USTR("sord_test_graphs.bin");
+  SordModel* const     sord = sord_new(world, SORD_SPO | SORD_OPS, true);
+  SordNode* const      p    = uri(world, 100);
+
+  // Triples in many graphs, between some in only a few
+  for (unsigned s = 0U; s < n_subjects; ++s) {
+    SordNode* const subject = uri(world, s + 1U);
+    for (unsigned o = 0U; o < n_objects; ++o) {
+      SordNode* const object = uri(world, 200U + o);
+      const unsigned  n      = (o % 2U) ? n_graphs : (o % 3U) + 1U;
+      for (unsigned g = 0U; g < n; ++g) {
+        SordNode* const graph = uri(world, 300U + g);
+        const SordQuad  quad  = {subject, p, object, graph};
+        sord_add(sord, quad);
+        sord_node_free(world, graph);
+      }
+      sord_node_free(world, object);
+    }
+    sord_node_free(world, subject);
+  }
+
+  // Check that each triple is visited once, before and after mapping
+  SordNode* const s         = uri(world, 3U);
+  const size_t    n_triples = (size_t)n_subjects * n_objects;
+  if (count_triples(sord, NULL, NULL) != n_triples ||
+      count_triples(sord, NULL, p) != n_triples ||
+      count_triples(sord, s, NULL) != n_objects) {
+    return test_fail("Model visited graphs of triples\n");
+  } else if (sord_save_binary(sord, path, true)) {
+    return test_fail("Failed to save binary snapshot\n");
+  }
+
+  SordModel* const mapped = sord_open_binary(world, path);
+  if (!mapped || count_triples(mapped, NULL, NULL) != n_triples ||
+      count_triples(mapped, NULL, p) != n_triples ||
+      count_triples(mapped, s, NULL) != n_objects) {
+    return test_fail("Mapped model visited graphs of triples\n");
+  }
+
+  sord_free(mapped);
+  remove((const char*)path);
+  sord_node_free(world, s);
+  sord_node_free(world, p);
+  sord_free(sord);
+  return 0;
+}
+
+static size_t
+count_matches(SordIter* iter)
+{
+  size_t n = 0U;
+  for (; !sord_iter_end(iter); sord_iter_next(iter)) {
+    ++n;
+  }
+
+  sord_iter_free(iter);
+  return n;
+}
+
+static int
+test_stats(SordWorld* world, const unsigned n_quads)
+{
+  SordModel* const sord = sord_new(world, SORD_SPO | SORD_OPS, false);
+  SordNode* const  s    = uri(world, 1);
+  SordNode* const  p    = uri(world, 2);
+  generate(world, sord, n_quads, NULL);
+
+  // Search a range, then by predicate, which has to filter everything
+  sord_reset_stats(sord);
+  const size_t n_range  = count_matches(sord_search(sord, s, p, 0, 0));
+  const size_t n_filter = count_matches(sord_search(sord, 0, p, 0, 0));
+
+  SordStats stats;
+  sord_get_stats(sord, &stats);
+  if (stats.n_range != 1U || stats.n_filter_all != 1U || stats.n_all ||
+      stats.n_single || stats.n_filter_range || stats.n_searches[0] != 2U) {
+    return test_fail("Bad search counts\n");
+  } else if (stats.n_returned != n_range + n_filter ||
+             stats.n_scanned <= stats.n_returned) {
+    return test_fail("Returned %zu of %zu scanned, expected %zu\n",
+                     stats.n_returned,
+                     stats.n_scanned,
+                     n_range + n_filter);
+  } else if (stats.n_nodes != sord_num_nodes(world) ||
+             stats.node_slots < stats.n_nodes ||
+             stats.n_quads != sord_num_quads(sord)) {
+    return test_fail("Bad node or quad counts\n");
+  } else if (!stats.index_bytes[0] || !stats.index_bytes[2] ||
+             stats.index_bytes[1] || stats.index_bytes[6]) {
+    return test_fail("Bad index sizes\n");
+  }
+
+  // A node and its string are allocated together, and freed with the node
+  const size_t    node_bytes = stats.node_bytes;
+  SordNode* const node       = uri(world, 9999);
+  sord_get_stats(sord, &stats);
+  const size_t new_bytes = stats.node_bytes - node_bytes;
+  sord_node_free(world, node);
+  sord_get_stats(sord, &stats);
+  if (!node_bytes || new_bytes < sizeof("eg:9999") ||
+      new_bytes > sizeof("eg:9999") + 64U ||
+      stats.node_bytes != node_bytes) {
+    return test_fail("Bad node memory size\n");
+  }
+
+  // Resetting clears only the counts
+  sord_reset_stats(sord);
+  sord_get_stats(sord, &stats);
+  if (stats.n_range || stats.n_filter_all || stats.n_scanned ||
+      stats.n_returned || !stats.n_nodes || !stats.index_bytes[0]) {
+    return test_fail("Failed to reset statistics\n");
+  }
+
+  sord_node_free(world, p);
+  sord_node_free(world, s);
+  sord_free(sord);
+  return 0;
+}
+
+/// Check that reading `iter` in small batches matches stepping `step`
+static int
+check_iter_batches(SordIter* iter, SordIter* step)
+{
+  SordQuad        quads[3];
+  const SordNode* objects[3];
+  for (size_t i = 0U;; ++i) {
+    // Alternate between quads and objects, with batches of 1, 2, then 3
+    const size_t max = (i % 3U) + 1U;
+    const size_t n   = (i % 2U) ? sord_iter_get_batch(iter, quads, max)
+                                : sord_iter_get_nodes(
+                                  iter, SORD_OBJECT, objects, max);
+
+    for (size_t j = 0U; j < n; ++j, sord_iter_next(step)) {
+      SordQuad expected;
+      sord_iter_get(step, expected);
+      if (sord_iter_end(step) ||
+          ((i % 2U) ? !!memcmp(quads[j], expected, sizeof(SordQuad))
+                    : objects[j] != expected[SORD_OBJECT])) {
+        return test_fail("Batch has incorrect quad\n");
+      }
+    }
+
+    if (n < max) {
+      break;
+    }
+  }
+
+  if (!sord_iter_end(iter) || !sord_iter_end(step)) {
+    return test_fail("Batch ended early\n");
+  }
+
+  sord_iter_free(step);
+  sord_iter_free(iter);
+  return 0;
+}
+
+static int
+test_iter_batch(SordWorld* world, const unsigned n_quads)
+{
+  SordModel* const sord  = sord_new(world, SORD_SPO | SORD_OPS, false);
+  SordNode* const  s     = uri(world, 1);
+  SordNode* const  p     = uri(world, 2);
+  SordNode* const  graph = uri(world, 42);
+  generate(world, sord, n_quads, NULL);
+
+  // Read everything, a range, and a filtered search, each in batches
+  const SordQuad patterns[] = {{NULL, NULL, NULL, NULL},
+                               {s, p, NULL, NULL},
+                               {NULL, p, NULL, NULL}};
+
+  for (size_t i = 0U; i < sizeof(patterns) / sizeof(patterns[0]); ++i) {
+    if (check_iter_batches(sord_find(sord, patterns[i]),
+                           sord_find(sord, patterns[i]))) {
+      return finished(world, sord, EXIT_FAILURE);
+    }
+  }
+
+  // Read a model with graphs, which has to skip them
+  SordModel* const quads = sord_new(world, SORD_SPO, true);
+  generate(world, quads, n_quads, graph);
+  if (check_iter_batches(sord_begin(quads), sord_begin(quads))) {
+    return finished(world, quads, EXIT_FAILURE);
+  }
+
+  // Read triples that are in several graphs, some in more than a short scan
+  SordModel* const dups = sord_new(world, SORD_SPO, true);
+  for (unsigned o = 0U; o < 8U; ++o) {
+    SordNode* const object = uri(world, 200U + o);
+    for (unsigned g = 0U; g <= o; ++g) {
+      SordNode* const other = uri(world, 300U + g);
+      const SordQuad  quad  = {s, p, object, other};
+      sord_add(dups, quad);
+      sord_node_free(world, other);
+    }
+    sord_node_free(world, object);
+  }
+
+  const SordNode* objects[16];
+  SordIter* const all = sord_begin(dups);
+  if (sord_iter_get_nodes(all, SORD_OBJECT, objects, 16U) != 8U ||
+      !sord_iter_end(all)) {
+    return test_fail("Batch read other graphs of triples\n");
+  }
+  sord_iter_free(all);
+
+  if (check_iter_batches(sord_begin(dups), sord_begin(dups)) ||
+      check_iter_batches(sord_search(dups, s, p, NULL, NULL),
+                         sord_search(dups, s, p, NULL, NULL))) {
+    return finished(world, dups, EXIT_FAILURE);
+  }
+
+  // Reading nothing is fine
+  SordQuad        quad;
+  SordIter* const iter = sord_begin(sord);
+  if (sord_iter_get_batch(NULL, &quad, 1U) ||
+      sord_iter_get_batch(iter, &quad, 0U) || sord_iter_end(iter)) {
+    return test_fail("Read from no iterator\n");
+  }
+  sord_iter_free(iter);
+
+  sord_node_free(world, graph);
+  sord_node_free(world, p);
+  sord_node_free(world, s);
+  sord_free(dups);
+  sord_free(quads);
+  sord_free(sord);
+  return 0;
+}
+
+typedef struct {
+  char*  buf;
+  size_t len;
+  size_t size;
+} TestOutput;
+
+static size_t
+test_output_sink(const void* buf, size_t len, void* stream)
+{
+  TestOutput* const output = (TestOutput*)stream;
+  if (output->len + len + 1U > output->size) {
+    const size_t size    = (output->len + len + 1U) * 2U;
+    char* const  new_buf = (char*)realloc(output->buf, size);
+    if (!new_buf) {
+      return 0U;
+    }
+
+    output->buf  = new_buf;
+    output->size = size;
+  }
+
+  memcpy(output->buf + output->len, buf, len);
+  output->len += len;
+  output->buf[output->len] = '\0';
+  return len;
+}
+
+static int
+test_write_parallel(SordWorld* world)
+{
+  // Enough statements in two graphs for several chunks per thread
+  SordModel* const sord = sord_new(world, SORD_SPO | SORD_OPS, true);
+  SordNode* const  g1   = uri(world, 1001);
+  SordNode* const  g2   = uri(world, 1002);
+  generate(world, sord, 12000U, g1);
+  generate(world, sord, 100U, g2);
+
+  const size_t n_quads   = sord_num_quads(sord);
+  const size_t n_triples = sord_count(sord, NULL, NULL, NULL, g1);
+
+  // Writing on one thread and on several gives the same output
+  TestOutput      nq[2]        = {{NULL, 0U, 0U}, {NULL, 0U, 0U}};
+  TestOutput      nt[2]        = {{NULL, 0U, 0U}, {NULL, 0U, 0U}};
+  const unsigned  n_threads[2] = {1U, 4U};
+  const SerdStyle style        = SERD_STYLE_ASCII;
+  for (unsigned i = 0U; i < 2U; ++i) {
+    if (sord_write_parallel(sord,
+                            SERD_NQUADS,
+                            style,
+                            NULL,
+                            test_output_sink,
+                            &nq[i],
+                            n_threads[i]) ||
+        sord_write_parallel(sord,
+                            SERD_NTRIPLES,
+                            style,
+                            g1,
+                            test_output_sink,
+                            &nt[i],
+                            n_threads[i])) {
+      return test_fail("Failed to write in parallel\n");
+    }
+  }
+
+  if (!nq[0].buf || nq[0].len != nq[1].len ||
+      memcmp(nq[0].buf, nq[1].buf, nq[0].len)) {
+    return test_fail("Parallel N-Quads output differs\n");
+  } else if (!nt[0].buf || nt[0].len != nt[1].len ||
+             memcmp(nt[0].buf, nt[1].buf, nt[0].len)) {
+    return test_fail("Parallel N-Triples output differs\n");
+  } else if (sord_write_parallel(
+               sord, SERD_TURTLE, style, NULL, test_output_sink, &nt[0], 2U) !=
+             SERD_ERR_BAD_ARG) {
+    return test_fail("Wrote Turtle in parallel\n");
+  }
+
+  // Reading the output back gives the same statements
+  SordModel* const nq_copy = sord_new(world, SORD_SPO, true);
+  SordModel* const nt_copy = sord_new(world, SORD_SPO, false);
+  SerdEnv* const   env     = serd_env_new(NULL);
+  SerdReader*      reader  = sord_new_reader(nq_copy, env, SERD_NQUADS, NULL);
+  serd_reader_read_string(reader, (const uint8_t*)nq[1].buf);
+  serd_reader_free(reader);
+  reader = sord_new_reader(nt_copy, env, SERD_NTRIPLES, NULL);
+  serd_reader_read_string(reader, (const uint8_t*)nt[1].buf);
+  serd_reader_free(reader);
+
+  if (sord_num_quads(nq_copy) != n_quads) {
+    return test_fail("Read %zu quads, not %zu\n",
+                     sord_num_quads(nq_copy),
+                     n_quads);
+  } else if (sord_num_quads(nt_copy) != n_triples) {
+    return test_fail("Read %zu triples, not %zu\n",
+                     sord_num_quads(nt_copy),
+                     n_triples);
+  }
+
+  for (unsigned i = 0U; i < 2U; ++i) {
+    free(nt[i].buf);
+    free(nq[i].buf);
+  }
+
+  serd_env_free(env);
+  sord_free(nt_copy);
+  sord_free(nq_copy);
+  sord_node_free(world, g2);
+  sord_node_free(world, g1);
+  sord_free(sord);
+  return 0;
+}
+
+static SordNode*
+typed_literal(SordWorld* world, const char* type, const char* str)
+{
+  char type_uri[64];
+  snprintf(
+    type_uri, sizeof(type_uri), "http://www.w3.org/2001/XMLSchema#%s", type);
+
+  SordNode* const datatype = sord_new_uri(world, (const uint8_t*)type_uri);
+  SordNode* const literal =
+    sord_new_literal(world, datatype, (const uint8_t*)str, NULL);
+
+  sord_node_free(world, datatype);
+  return literal;
+}
+
+static int
+check_value(SordWorld*  world,
+            const char* type,
+            const char* str,
+            const bool  valid,
+            double      expected)
+{
+  SordNode* const node  = typed_literal(world, type, str);
+  const double    value = sord_node_get_value(node);
+
+  sord_node_free(world, node);
+  if (valid ? !(value >= expected && value <= expected) : !isnan(value)) {
+    return test_fail("Bad value %f of \"%s\"^^xsd:%s\n", value, str, type);
+  }
+
+  return 0;
+}
+
+/// Count value search results, checking that they are in order and range
+static size_t
+count_values(SordModel*      sord,
+             const SordNode* p,
+             const double    min,
+             const double    max)
+{
+  size_t    n    = 0U;
+  double    last = min;
+  SordIter* iter = sord_find_values(sord, p, min, max);
+  for (; !sord_iter_end(iter); sord_iter_next(iter), ++n) {
+    const SordNode* const o     = sord_iter_get_node(iter, SORD_OBJECT);
+    const double          value = sord_node_get_value(o);
+    if (sord_iter_get_node(iter, SORD_PREDICATE) != p || value < last ||
+        value > max) {
+      test_fail("Value %f out of order or range\n", value);
+      n = (size_t)-1;
+      break;
+    }
+
+    last = value;
+  }
+
+  sord_iter_free(iter);
+  return n;
+}
+
+static int
+test_values(SordWorld* world)
+{
+  // Values are parsed from literals with the supported datatypes
+  if (check_value(world, "integer", "42", true, 42.0) ||
+      check_value(world, "integer", "-7", true, -7.0) ||
+      check_value(world, "integer", "4.2", false, 0.0) ||
+      check_value(world, "integer", "12abc", false, 0.0) ||
+      check_value(world, "decimal", "-1.5", true, -1.5) ||
+      check_value(world, "decimal", ".5", true, 0.5) ||
+      check_value(world, "decimal", "1e3", false, 0.0) ||
+      check_value(world, "double", "1e3", true, 1000.0) ||
+      check_value(world, "double", "-INF", true, -HUGE_VAL) ||
+      check_value(world, "double", "NaN", false, 0.0) ||
+      check_value(world, "double", "1e", false, 0.0) ||
+      check_value(world, "dateTime", "1970-01-02T00:00:00Z", true, 86400.0) ||
+      check_value(
+        world, "dateTime", "2000-01-01T01:00:00.5+01:00", true, 946684800.5) ||
+      check_value(world, "dateTime", "1969-12-31T23:59:59", true, -1.0) ||
+      check_value(world, "dateTime", "2000-13-01T00:00:00", false, 0.0) ||
+      check_value(world, "string", "42", false, 0.0)) {
+    return 1;
+  }
+
+  SordNode* const plain = sord_new_literal(world, NULL, USTR("42"), NULL);
+  SordNode* const price = uri(world, 1);
+  SordNode* const size  = uri(world, 2);
+  SordNode* const g     = uri(world, 3);
+  SordNode* const g2    = uri(world, 4);
+  if (!isnan(sord_node_get_value(plain)) ||
+      !isnan(sord_node_get_value(price))) {
+    return test_fail("Plain literal or URI has a value\n");
+  }
+
+  // Add values which sort differently as strings, in two graphs
+  SordModel* const sord = sord_new(world, SORD_SPO | SORD_VALUES, true);
+  for (unsigned i = 1U; i <= 100U; ++i) {
+    char str[16];
+    snprintf(str, sizeof(str), "%u", i);
+
+    SordNode* const s = uri(world, 100U + i);
+    SordNode* const o = typed_literal(world, "integer", str);
+    SordQuad        t = {s, price, o, g};
+    sord_add(sord, t);
+    t[3] = g2;
+    sord_add(sord, t);
+    t[1] = size;
+    sord_add(sord, t);
+
+    sord_node_free(world, o);
+    sord_node_free(world, s);
+  }
+
+  // Add a literal without a value, after the others in the default order
+  SordNode* const last       = uri(world, 999);
+  SordQuad        plain_quad = {last, price, plain, NULL};
+  sord_add(sord, plain_quad);
+  sord_node_free(world, last);
+
+  // Each triple is found once, in order, however it was stored
+  if (!(sord_get_indices(sord) & SORD_VALUES)) {
+    return test_fail("Model has no value index\n");
+  } else if (count_values(sord, price, 5.0, 50.0) != 46U ||
+             count_values(sord, size, 50.5, 1000.0) != 50U ||
+             count_values(sord, price, -HUGE_VAL, HUGE_VAL) != 100U) {
+    return test_fail("Incorrect value search results\n");
+  } else if (sord_find_values(sord, price, 101.0, 200.0) ||
+             sord_find_values(sord, price, 50.0, 5.0) ||
+             sord_find_values(sord, g, 0.0, 100.0)) {
+    return test_fail("Found values outside of range\n");
+  }
+
+  // Removed statements are removed from the index, but not from snapshots
+  SordModel* const snapshot = sord_snapshot(sord);
+  SordQuad         pat      = {NULL, price, NULL, NULL};
+  SordIter* const  iter     = sord_find(sord, pat);
+  SordQuad         quads[20];
+  const size_t     n_read = sord_iter_get_batch(iter, quads, 10U);
+  sord_iter_free(iter);
+  for (size_t i = 0U; i < n_read; ++i) {
+    memcpy(quads[n_read + i], quads[i], sizeof(SordQuad));
+    quads[i][3]          = g;
+    quads[n_read + i][3] = g2;
+  }
+
+  if (sord_remove_batch(sord, quads, n_read * 2U) != 20U) {
+    return test_fail("Failed to remove quads\n");
+  }
+
+  SordNode* const fifty = typed_literal(world, "integer", "50");
+  SordQuad        quad  = {NULL, price, fifty, NULL};
+  SordIter* const found = sord_find(sord, quad);
+  sord_iter_get(found, quad);
+  sord_iter_free(found);
+  quad[3] = g;
+  sord_remove(sord, quad);
+  quad[3] = g2;
+  sord_remove(sord, quad);
+  sord_node_free(world, fifty);
+
+  if (count_values(sord, price, -HUGE_VAL, HUGE_VAL) != 89U) {
+    return test_fail("Removed statements are still in value index\n");
+  } else if (count_values(snapshot, price, -HUGE_VAL, HUGE_VAL) != 100U) {
+    return test_fail("Snapshot value index changed\n");
+  }
+
+  // Values can be indexed later, and the index dropped
+  SordModel* const other = sord_new(world, SORD_SPO, false);
+  pat[1]                 = NULL;
+  SordIter* const all    = sord_find(sord, pat);
+  for (; !sord_iter_end(all); sord_iter_next(all)) {
+    sord_iter_get(all, quad);
+    quad[3] = NULL;
+    sord_add(other, quad);
+  }
+  sord_iter_free(all);
+
+  if (sord_find_values(other, size, 0.0, 100.0)) {
+    return test_fail("Found values without a value index\n");
+  } else if (!sord_add_index(other, SORD_VALUES) ||
+             count_values(other, size, 0.0, 100.0) != 100U) {
+    return test_fail("Failed to build value index\n");
+  } else if (!sord_drop_index(other, SORD_VALUES) ||
+             (sord_get_indices(other) & SORD_VALUES) ||
+             sord_find_values(other, size, 0.0, 100.0)) {
+    return test_fail("Failed to drop value index\n");
+  }
+
+  sord_free(other);
+  sord_free(snapshot);
+  sord_free(sord);
+  sord_node_free(world, g2);
+  sord_node_free(world, g);
+  sord_node_free(world, size);
+  sord_node_free(world, price);
+  sord_node_free(world, plain);
+  return 0;
+}
+
+typedef struct {
+  size_t   n_added;
+  size_t   n_removed;
+  uint64_t last_seq;
+  bool     ordered;
+} ChangeCounts;
+
+static void
+count_change(void* handle, const SordChange* change)
+{
+  ChangeCounts* const counts = (ChangeCounts*)handle;
+
+  counts->n_added += (change->type == SORD_ADDED) ? 1U : 0U;
+  counts->n_removed += (change->type == SORD_REMOVED) ? 1U : 0U;
+  counts->ordered  = counts->ordered && change->seq == counts->last_seq + 1U;
+  counts->last_seq = change->seq;
+}
+
+static int
+test_changes(SordWorld* world)
+{
+  SordModel* const sord   = sord_new(world, SORD_SPO | SORD_OPS, false);
+  ChangeCounts     counts = {0U, 0U, 0U, true};
+  sord_set_change_sink(sord, count_change, &counts);
+  sord_set_change_log_size(sord, 4U);
+
+  // Add quads one at a time and in a batch, with a duplicate
+  SordNode* const p = uri(world, 1);
+  SordQuad        quads[6];
+  for (unsigned i = 0U; i < 6U; ++i) {
+    quads[i][0] = uri(world, 10U + i);
+    quads[i][1] = p;
+    quads[i][2] = sord_new_literal(world, NULL, USTR("changed"), NULL);
+    quads[i][3] = NULL;
+  }
+
+  sord_add(sord, quads[0]);
+  sord_add(sord, quads[1]);
+  sord_add(sord, quads[1]);
+  sord_add_batch(sord, quads + 2U, 3U);
+
+  // Remove quads directly, in a batch, and by erasing
+  sord_remove(sord, quads[0]);
+  sord_remove_batch(sord, quads + 1U, 2U);
+  SordIter* const iter = sord_find(sord, quads[3]);
+  sord_erase(sord, iter);
+  sord_iter_free(iter);
+
+  if (counts.n_added != 5U || counts.n_removed != 4U || !counts.ordered ||
+      sord_get_change_seq(sord) != 9U) {
+    return test_fail("Bad change notifications\n");
+  }
+
+  // The log keeps the last 4 changes, with their nodes
+  for (unsigned i = 0U; i < 5U; ++i) {
+    sord_node_free(world, (SordNode*)quads[i][0]);
+    sord_node_free(world, (SordNode*)quads[i][2]);
+  }
+
+  SordChange changes[8];
+  size_t     n = sord_get_changes(sord, 0U, changes, 8U);
+  if (n != 4U || changes[0].seq != 6U || changes[3].seq != 9U ||
+      changes[0].type != SORD_REMOVED ||
+      strcmp((const char*)sord_node_get_string(changes[0].quad[0]),
+             "eg:010")) {
+    return test_fail("Bad change log\n");
+  } else if (sord_get_changes(sord, 7U, changes, 8U) != 2U ||
+             changes[0].seq != 8U ||
+             sord_get_changes(sord, 9U, changes, 8U) ||
+             sord_get_changes(sord, 6U, changes, 1U) != 1U ||
+             changes[0].seq != 7U) {
+    return test_fail("Bad changes since a sequence number\n");
+  }
+
+  // Shrinking the log keeps the most recent changes
+  sord_set_change_log_size(sord, 2U);
+  n = sord_get_changes(sord, 0U, changes, 8U);
+  if (n != 2U || changes[0].seq != 8U || changes[1].seq != 9U) {
+    return test_fail("Failed to shrink change log\n");
+  }
+
+  // Snapshots don't report changes, and disabling the log works
+  SordModel* const snapshot = sord_snapshot(sord);
+  sord_set_change_log_size(sord, 0U);
+  sord_set_change_sink(sord, NULL, NULL);
+  sord_add(sord, quads[5]);
+  if (sord_get_change_seq(snapshot) != 9U ||
+      sord_get_changes(sord, 0U, changes, 8U) || counts.n_added != 5U ||
+      sord_get_change_seq(sord) != 10U) {
+    return test_fail("Changes reported after disabling\n");
+  }
+
+  sord_free(snapshot);
+  sord_free(sord);
+  sord_node_free(world, (SordNode*)quads[5][2]);
+  sord_node_free(world, (SordNode*)quads[5][0]);
+  sord_node_free(world, p);
+  return 0;
+}
+
+static int
+test_intern_many(SordWorld* world)
+{
+  SerdEnv* const env  = serd_env_new(NULL);
+  SerdNode       name = serd_node_from_string(SERD_LITERAL, USTR("eg"));
+  SerdNode       ns   = serd_node_from_string(SERD_URI, USTR("http://e.org/"));
+  serd_env_set_prefix(env, &name, &ns);
+
+  const SerdNode nodes[] = {
+    serd_node_from_string(SERD_URI, USTR("http://e.org/a")),
+    serd_node_from_string(SERD_BLANK, USTR("b1")),
+    serd_node_from_string(SERD_LITERAL, USTR("42")),
+    serd_node_from_string(SERD_LITERAL, USTR("hello")),
+    serd_node_from_string(SERD_CURIE, USTR("eg:a")),
+    SERD_NODE_NULL,
+  };
+
+  const SerdNode datatypes[] = {
+    SERD_NODE_NULL,
+    SERD_NODE_NULL,
+    serd_node_from_string(SERD_CURIE, USTR("eg:int")),
+    SERD_NODE_NULL,
+    SERD_NODE_NULL,
+    SERD_NODE_NULL,
+  };
+
+  const SerdNode langs[] = {
+    SERD_NODE_NULL,
+    SERD_NODE_NULL,
+    SERD_NODE_NULL,
+    serd_node_from_string(SERD_LITERAL, USTR("en")),
+    SERD_NODE_NULL,
+    SERD_NODE_NULL,
+  };
+
+  // Intern every node, which should be the same as one at a time
+  size_t    hashes[6] = {0U, 0U, 0U, 0U, 0U, 0U};
+  SordNode* out[6];
+  SordNode* again[6];
+  if (sord_intern_many(world, env, 6U, nodes, datatypes, langs, hashes, out) !=
+      5U) {
+    return test_fail("Failed to intern many nodes\n");
+  }
+
+  for (unsigned i = 0U; i < 6U; ++i) {
+    SordNode* const node =
+      sord_node_from_serd_node(world, env, &nodes[i], &datatypes[i], &langs[i]);
+
+    if (out[i] != node || (node && hashes[i] != sord_node_get_hash(node))) {
+      return test_fail("Interned node %u differs\n", i);
+    }
+
+    sord_node_free(world, node);
+  }
+
+  if (out[0] != out[4] || out[5]) {
+    return test_fail("Bad interned CURIE or null node\n");
+  }
+
+  // Intern them again with the hashes from the first time
+  const size_t n_again =
+    sord_intern_many(world, env, 6U, nodes, datatypes, langs, hashes, again);
+  if (n_again != 5U || memcmp(out, again, sizeof(out))) {
+    return test_fail("Failed to intern nodes with known hashes\n");
+  }
+
+  // Hashes only depend on the contents of nodes
+  SordWorld* const other = sord_world_new();
+  SordNode* const  copy  = sord_node_from_serd_node(
+    other, env, &nodes[2], &datatypes[2], &langs[2]);
+  if (sord_node_get_hash(copy) != hashes[2]) {
+    return test_fail("Hash of equal node differs between worlds\n");
+  }
+
+  sord_node_free(other, copy);
+  sord_world_free(other);
+  for (unsigned i = 0U; i < 5U; ++i) {
+    sord_node_free(world, out[i]);
+    sord_node_free(world, again[i]);
+  }
+
+  serd_env_free(env);
+  return 0;
+}
+
+/** Add quads with typed literal objects, and release every node. */
+static void
+add_typed_quads(SordWorld* world, SordModel* sord, unsigned n, SordNode* graph)
+{
+  SordNode* const p        = uri(world, 1U);
+  SordNode* const datatype = uri(world, 2U);
+  for (unsigned i = 0U; i < n; ++i) {
+    char str[16];
+    snprintf(str, sizeof(str), "%u", i);
+
+    SordNode* const s    = uri(world, 100U + i);
+    SordNode* const o    = sord_new_literal(world, datatype, USTR(str), NULL);
+    const SordQuad  quad = {s, p, o, graph};
+    sord_add(sord, quad);
+    sord_node_free(world, o);
+    sord_node_free(world, s);
+  }
+
+  sord_node_free(world, datatype);
+  sord_node_free(world, p);
+}
+
+static int
+test_clear(const unsigned n_quads)
+{
+  SordWorld* const world  = sord_world_new();
+  SordModel* const sord   = sord_new(world, SORD_SPO | SORD_VALUES, true);
+  SordNode* const  graph  = uri(world, 42);
+  ChangeCounts     counts = {0U, 0U, 0U, true};
+
+  // Clearing a model that shares its quads leaves the snapshot as it was
+  const size_t n_nodes_before = sord_num_nodes(world);
+  add_typed_quads(world, sord, n_quads, graph);
+  SordModel* const snapshot = sord_snapshot(sord);
+  sord_set_change_sink(sord, count_change, &counts);
+  sord_clear(sord);
+  if (sord_num_quads(sord) || counts.n_removed != n_quads ||
+      sord_get_change_seq(sord) != 2U * n_quads ||
+      sord_num_quads(snapshot) != n_quads ||
+      sord_num_nodes(world) != n_nodes_before + n_quads * 2U + 2U) {
+    return test_fail("Failed to clear model with snapshot\n");
+  }
+
+  // Freeing the snapshot releases every node at once
+  sord_free(snapshot);
+  if (sord_num_nodes(world) != n_nodes_before) {
+    return test_fail("Clearing leaked nodes (%zu != %zu)\n",
+                     sord_num_nodes(world),
+                     n_nodes_before);
+  }
+
+  // Clear an unshared model, then fill it again
+  sord_set_change_sink(sord, NULL, NULL);
+  add_typed_quads(world, sord, n_quads, graph);
+  sord_clear(sord);
+  if (sord_num_quads(sord) || sord_num_nodes(world) != n_nodes_before) {
+    return test_fail("Failed to clear model\n");
+  }
+
+  add_typed_quads(world, sord, n_quads, graph);
+  if (sord_num_quads(sord) != n_quads) {
+    return test_fail("Failed to reuse cleared model\n");
+  }
+
+  // Free the model and world together without dropping references
+  sord_node_free(world, graph);
+  sord_free_with_world(sord);
+  return 0;
+}
+
+typedef struct {
+  SordModel* snapshot;
+  size_t     n_quads;
+  unsigned   n_errors;
+} SnapshotReaderState;
+
+static ZixThreadResult ZIX_THREAD_FUNC
+read_and_free_snapshot(void* const arg)
+{
+  SnapshotReaderState* const state = (SnapshotReaderState*)arg;
+
+  size_t    n_read = 0U;
+  SordQuad  quad;
+  SordIter* iter = sord_begin(state->snapshot);
+  for (; !sord_iter_end(iter); sord_iter_next(iter)) {
+    sord_iter_get(iter, quad);
+    n_read += sord_ask(state->snapshot, quad[0], quad[1], quad[2], NULL);
+  }
+  sord_iter_free(iter);
+
+  state->n_errors += n_read != state->n_quads;
+  sord_free(state->snapshot);
+  return ZIX_THREAD_RESULT;
+}
+
+static int
+test_snapshot_reader(const unsigned n_quads)
+{
+  SordWorld* const world = sord_world_new();
+  SordModel* const sord  = sord_new(world, SORD_SPO | SORD_OPS, false);
+  add_typed_quads(world, sord, n_quads, NULL);
+
+  // Clear the model so that only the snapshot holds the generated nodes
+  SnapshotReaderState state = {sord_snapshot(sord), sord_num_quads(sord), 0U};
+  sord_clear(sord);
+
+  // Read and free the snapshot on another thread while writing to the world
+  ZixThread thread;
+  zix_thread_create(&thread, 0U, read_and_free_snapshot, &state);
+
+  SordNode* const p = uri(world, 2U);
+  SordNode* const o = uri(world, 3U);
+  for (unsigned i = 0U; i < 1000U; ++i) {
+    SordNode* const s    = uri(world, 100000U + i);
+    const SordQuad  quad = {s, p, o, NULL};
+    sord_add(sord, quad);
+    sord_node_free(world, s);
+  }
+
+  zix_thread_join(thread);
+  if (state.n_errors) {
+    return test_fail("Snapshot changed while read on another thread\n");
+  } else if (sord_num_quads(sord) != 1000U) {
+    return test_fail("Writing while a snapshot was freed lost quads\n");
+  }
+
+  sord_clear(sord);
+  sord_node_free(world, o);
+  sord_node_free(world, p);
+  if (sord_num_nodes(world)) {
+    return test_fail("Snapshot freed on another thread leaked %zu nodes\n",
+                     sord_num_nodes(world));
+  }
+
+  sord_free(sord);
+  sord_world_free(world);
+  return 0;
+}
+
+int
+main(void)
+{
+  static const unsigned n_quads = 300U;
+
+  sord_free(NULL); // Shouldn't crash
+
+  SordWorld* world   = sord_world_new();
+  size_t     n_nodes = 0U;
+
+  // Attempt to create invalid URI
+  fprintf(stderr, "expected ");
+  SordNode* bad_uri = sord_new_uri(world, USTR("noscheme"));
+  if (bad_uri) {
+    return test_fail("Successfully created invalid URI \"noscheme\"\n");
+  }
+  sord_node_free(world, bad_uri);
+
+  sord_world_set_error_sink(world, expected_error, NULL);
+
+  // Attempt to create invalid CURIE
+  SerdNode  base = serd_node_from_string(SERD_URI, USTR("http://example.org/"));
+  SerdEnv*  env  = serd_env_new(&base);
+  SerdNode  sbad = serd_node_from_string(SERD_CURIE, USTR("bad:"));
+  SordNode* bad  = sord_node_from_serd_node(world, env, &sbad, NULL, NULL);
+  if (bad) {
+    return test_fail("Successfully created CURIE with bad namespace\n");
+  }
+  sord_node_free(world, bad);
+  serd_env_free(env);
+
+  // Attempt to create node from garbage
+  SerdNode junk = SERD_NODE_NULL;
+  junk.type     = (SerdType)1234;
+  if (sord_node_from_serd_node(world, env, &junk, NULL, NULL)) {
+    return test_fail("Successfully created node from garbage serd node\n");
+  }
+
+  // Attempt to create NULL node
+  SordNode* nil_node =
+    sord_node_from_serd_node(world, NULL, &SERD_NODE_NULL, NULL, NULL);
+  if (nil_node) {
+    return test_fail("Successfully created NULL node\n");
+  }
+  sord_node_free(world, nil_node);
+
+  // Check node flags are set properly
+  SordNode* with_newline = sord_new_literal(world, NULL, USTR("a\nb"), NULL);
+  if (!(sord_node_get_flags(with_newline) & SERD_HAS_NEWLINE)) {
+    return test_fail("Newline flag not set\n");
+  }
+  SordNode* with_quote = sord_new_literal(world, NULL, USTR("a\"b"), NULL);
+  if (!(sord_node_get_flags(with_quote) & SERD_HAS_QUOTE)) {
+    return test_fail("Quote flag not set\n");
+  }
+
+  // Create with minimal indexing
+  SordModel* sord = sord_new(world, SORD_SPO, false);
+  generate(world, sord, n_quads, NULL);
+
+  if (test_read(world, sord, NULL, n_quads)) {
+    sord_free(sord);
+    sord_world_free(world);
+    return EXIT_FAILURE;
+  }
+
+  // Check adding tuples with NULL fields fails
+  sord_world_set_error_sink(world, expected_error, NULL);
+  const size_t initial_num_quads = sord_num_quads(sord);
+  SordQuad     tup               = {0, 0, 0, 0};
+  if (sord_add(sord, tup)) {
+    return test_fail("Added NULL tuple\n");
+  }
+  tup[0] = uri(world, 1);
+  if (sord_add(sord, tup)) {
+    return test_fail("Added tuple with NULL P and O\n");
+  }
+  tup[1] = uri(world, 2);
+  if (sord_add(sord, tup)) {
+    return test_fail("Added tuple with NULL O\n");
+  }
+
+  if (sord_num_quads(sord) != initial_num_quads) {
+    return test_fail(
+      "Num quads %zu != %zu\n", sord_num_quads(sord), initial_num_quads);
+  }
+
+  // Check adding tuples with an active iterator fails
+  SordIter* iter = sord_begin(sord);
+  tup[2]         = uri(world, 3);
+  if (sord_add(sord, tup)) {
+    return test_fail("Added tuple with active iterator\n");
+  }
+
+  // Check removing tuples with several active iterator fails
+  SordIter* iter2 = sord_begin(sord);
+  if (!sord_erase(sord, iter)) {
+    return test_fail("Erased tuple with several active iterators\n");
+  }
+  n_expected_errors = 0;
+  sord_remove(sord, tup);
+  if (n_expected_errors != 1) {
+    return test_fail("Removed tuple with several active iterators\n");
+  }
+  sord_iter_free(iter);
+  sord_iter_free(iter2);
+
+  sord_world_set_error_sink(world, unexpected_error, NULL);
+
+  // Check interning merges equivalent values
+  SordNode* uri_id   = sord_new_uri(world, USTR("http://example.org"));
+  SordNode* blank_id = sord_new_blank(world, USTR("testblank"));
+  SordNode* lit_id   = sord_new_literal(world, uri_id, USTR("hello"), NULL);
+  if (sord_node_get_type(uri_id) != SORD_URI) {
+    return test_fail("URI node has incorrect type\n");
+  } else if (sord_node_get_type(blank_id) != SORD_BLANK) {
+    return test_fail("Blank node has incorrect type\n");
+  } else if (sord_node_get_type(lit_id) != SORD_LITERAL) {
+    return test_fail("Literal node has incorrect type\n");
+  }
+
+  const size_t initial_num_nodes = sord_num_nodes(world);
+
+  SordNode* uri_id2   = sord_new_uri(world, USTR("http://example.org"));
+  SordNode* blank_id2 = sord_new_blank(world, USTR("testblank"));
+  SordNode* lit_id2   = sord_new_literal(world, uri_id, USTR("hello"), NULL);
+  if (uri_id2 != uri_id || !sord_node_equals(uri_id2, uri_id)) {
+    fprintf(stderr, "Fail: URI interning failed (duplicates)\n");
+    return finished(world, sord, EXIT_FAILURE);
+  } else if (blank_id2 != blank_id || !sord_node_equals(blank_id2, blank_id)) {
+    fprintf(stderr, "Fail: Blank node interning failed (duplicates)\n");
+    return finished(world, sord, EXIT_FAILURE);
+  } else if (lit_id2 != lit_id || !sord_node_equals(lit_id2, lit_id)) {
+    fprintf(stderr, "Fail: Literal interning failed (duplicates)\n");
+    return finished(world, sord, EXIT_FAILURE);
+  }
+
+  if (sord_num_nodes(world) != initial_num_nodes) {
+    return test_fail(
+      "Num nodes %zu != %zu\n", sord_num_nodes(world), initial_num_nodes);
+  }
+
+  const uint8_t ni_hao[] = {0xE4, 0xBD, 0xA0, 0xE5, 0xA5, 0xBD, 0};
+  SordNode*     chello   = sord_new_literal(world, NULL, ni_hao, "cmn");
+
+  // Test literal length
+  size_t         n_bytes = 0U;
+  size_t         n_chars = 0U;
+  const uint8_t* str     = sord_node_get_string_counted(lit_id2, &n_bytes);
+  if (!!strcmp((const char*)str, "hello")) {
+    return test_fail("Literal node corrupt\n");
+  } else if (n_bytes != strlen("hello")) {
+    return test_fail("ASCII literal byte count incorrect\n");
+  }
+
+  str = sord_node_get_string_measured(lit_id2, &n_bytes, &n_chars);
+  if (n_bytes != strlen("hello") || n_chars != strlen("hello")) {
+    return test_fail("ASCII literal measured length incorrect\n");
+  } else if (!!strcmp((const char*)str, "hello")) {
+    return test_fail("ASCII literal string incorrect\n");
+  }
+
+  str = sord_node_get_string_measured(chello, &n_bytes, &n_chars);
+  if (n_bytes != 6) {
+    return test_fail("Multi-byte literal byte count incorrect\n");
+  } else if (n_chars != 2) {
+    return test_fail("Multi-byte literal character count incorrect\n");
+  } else if (!!strcmp((const char*)str, (const char*)ni_hao)) {
+    return test_fail("Multi-byte literal string incorrect\n");
+  }
+
+  // Check interning doesn't clash non-equivalent values
+  SordNode* uri_id3   = sord_new_uri(world, USTR("http://example.orgX"));
+  SordNode* blank_id3 = sord_new_blank(world, USTR("testblankX"));
+  SordNode* lit_id3   = sord_new_literal(world, uri_id, USTR("helloX"), NULL);
+  if (uri_id3 == uri_id || sord_node_equals(uri_id3, uri_id)) {
+    fprintf(stderr, "Fail: URI interning failed (clash)\n");
+    return finished(world, sord, EXIT_FAILURE);
+  } else if (blank_id3 == blank_id || sord_node_equals(blank_id3, blank_id)) {
+    fprintf(stderr, "Fail: Blank node interning failed (clash)\n");
+    return finished(world, sord, EXIT_FAILURE);
+  } else if (lit_id3 == lit_id || sord_node_equals(lit_id3, lit_id)) {
+    fprintf(stderr, "Fail: Literal interning failed (clash)\n");
+    return finished(world, sord, EXIT_FAILURE);
+  }
+
+  // Check literal interning
+  SordNode* lit4 = sord_new_literal(world, NULL, USTR("hello"), NULL);
+  SordNode* lit5 = sord_new_literal(world, uri_id2, USTR("hello"), NULL);
+  SordNode* lit6 = sord_new_literal(world, NULL, USTR("hello"), "en-ca");
+  if (lit4 == lit5 || sord_node_equals(lit4, lit5) || lit4 == lit6 ||
+      sord_node_equals(lit4, lit6) || lit5 == lit6 ||
+      sord_node_equals(lit5, lit6)) {
+    fprintf(stderr, "Fail: Literal interning failed (type/lang clash)\n");
+    return finished(world, sord, EXIT_FAILURE);
+  }
+
+  // Check relative URI construction
+  SordNode* reluri =
+    sord_new_relative_uri(world, USTR("a/b"), USTR("http://example.org/"));
+  if (!!strcmp((const char*)sord_node_get_string(reluri),
+               "http://example.org/a/b")) {
+    fprintf(stderr,
+            "Fail: Bad relative URI constructed: <%s>\n",
+            sord_node_get_string(reluri));
+    return finished(world, sord, EXIT_FAILURE);
+  }
+  SordNode* reluri2 = sord_new_relative_uri(
+    world, USTR("http://drobilla.net/"), USTR("http://example.org/"));
+  if (!!strcmp((const char*)sord_node_get_string(reluri2),
+               "http://drobilla.net/")) {
+    fprintf(stderr,
+            "Fail: Bad relative URI constructed: <%s>\n",
+            sord_node_get_string(reluri));
+    return finished(world, sord, EXIT_FAILURE);
+  }
+
+  // Check comparison with NULL
+  sord_node_free(world, uri_id);
+  sord_node_free(world, blank_id);
+  sord_node_free(world, lit_id);
+  sord_node_free(world, uri_id2);
+  sord_node_free(world, blank_id2);
+  sord_node_free(world, lit_id2);
+  sord_node_free(world, uri_id3);
+  sord_node_free(world, blank_id3);
+  sord_node_free(world, lit_id3);
+  sord_free(sord);
+
+  static const char* const index_names[6] = {
+    "spo", "sop", "ops", "osp", "pso", "pos"};
 
   for (unsigned i = 0U; i < 6U; ++i) {
     sord = sord_new(world, (1U << i), false);
@@ -643,6 +2516,151 @@ main(void)
     sord_free(sord);
   }
 
+  for (unsigned i = 0U; i < 6U; ++i) {
+    sord = sord_new(world, (1U << i) | SORD_ID_ORDER, true);
+    printf("Testing Index `%s' by ID\n", graph_index_names[i]);
+    SordNode* graph = uri(world, 42);
+    generate(world, sord, n_quads, graph);
+    if (test_read(world, sord, graph, n_quads)) {
+      return finished(world, sord, EXIT_FAILURE);
+    }
+    sord_node_free(world, graph);
+    sord_free(sord);
+  }
+
+  // Test bulk loading with every index
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Bulk load", test_bulk(world, n_quads), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test adding and removing batches of quads
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Batches", test_batch(world, n_quads), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test compacting with both kinds of allocation
+  if (test_compact(0U, n_quads) || test_compact(SORD_WORLD_ARENA, n_quads)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test snapshots
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Snapshot", test_snapshot(world, n_quads), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test reading from several threads at once
+  if (test_concurrent_readers(world, n_quads)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test writing statements through an inserter
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Inserter", test_inserter(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test loading several files in parallel
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Loading files", test_load_files(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test saving and loading binary snapshots
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(
+        world, "Binary snapshots", test_binary(world, n_quads), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test using binary snapshots in place
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(
+        world, "Mapped models", test_mapped(world, n_quads), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test adding and dropping indices
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Indices", test_indices(world, n_quads), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test basic graph pattern queries
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Queries", test_query(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test filtered searches that seek past mismatches
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Skip scan", test_skip_scan(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test iterating over triples that are in many graphs
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(
+        world, "Graph duplicates", test_graph_duplicates(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test search and memory statistics
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Statistics", test_stats(world, n_quads), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test reading iterators in batches
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(
+        world, "Batched iteration", test_iter_batch(world, n_quads), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test writing on several threads
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(
+        world, "Parallel writing", test_write_parallel(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test indexing literal values
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Value index", test_values(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test change notifications and the change log
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(world, "Change log", test_changes(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test interning many nodes at once
+  n_nodes = sord_num_nodes(world);
+  if (check_leaks(
+        world, "Interning many nodes", test_intern_many(world), n_nodes)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test clearing models and freeing them with their world
+  if (test_clear(n_quads)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test freeing a snapshot on another thread while the world changes
+  if (test_snapshot_reader(n_quads)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
+  // Test allocating from arenas
+  if (test_arena(n_quads)) {
+    return finished(world, NULL, EXIT_FAILURE);
+  }
+
   // Test removing
   sord   = sord_new(world, SORD_SPO, true);
   tup[0] = uri(world, 1);